@@ -20,6 +20,9 @@ public class EnhancedOnlineSubsystem : ModuleRules
 		{ 
 			"CoreUObject",
 			"Engine",
+			"AssetRegistry",
+			"Sockets",
+			"Networking",
 		});
 	}
 }
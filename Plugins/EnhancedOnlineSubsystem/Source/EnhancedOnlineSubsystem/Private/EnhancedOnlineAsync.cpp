@@ -0,0 +1,106 @@
+// Copyright © 2024 MajorT. All rights reserved.
+
+#include "EnhancedOnlineAsync.h"
+
+namespace
+{
+	struct FWhenAllState
+	{
+		TPromise<TArray<FEnhancedOnlineResult>> Promise;
+		TArray<FEnhancedOnlineResult> Results;
+		int32 NumPending = 0;
+	};
+
+	struct FWhenAnyState
+	{
+		TPromise<TPair<int32, FEnhancedOnlineResult>> Promise;
+		int32 NumPending = 0;
+		bool bIsSet = false;
+	};
+}
+
+TFuture<TArray<FEnhancedOnlineResult>> FEnhancedOnlineAsync::WhenAll(TArray<TFuture<FEnhancedOnlineResult>>&& Futures)
+{
+	if (Futures.Num() == 0)
+	{
+		return MakeFulfilledPromise<TArray<FEnhancedOnlineResult>>().GetFuture();
+	}
+
+	TSharedRef<FWhenAllState> State = MakeShared<FWhenAllState>();
+	State->Results.SetNum(Futures.Num());
+	State->NumPending = Futures.Num();
+
+	TFuture<TArray<FEnhancedOnlineResult>> Future = State->Promise.GetFuture();
+
+	for (int32 Index = 0; Index < Futures.Num(); ++Index)
+	{
+		Futures[Index].Next([State, Index](FEnhancedOnlineResult Result)
+		{
+			State->Results[Index] = MoveTemp(Result);
+			if (--State->NumPending == 0)
+			{
+				State->Promise.SetValue(MoveTemp(State->Results));
+			}
+		});
+	}
+
+	return Future;
+}
+
+TFuture<TPair<int32, FEnhancedOnlineResult>> FEnhancedOnlineAsync::WhenAny(TArray<TFuture<FEnhancedOnlineResult>>&& Futures)
+{
+	if (Futures.Num() == 0)
+	{
+		return MakeFulfilledPromise<TPair<int32, FEnhancedOnlineResult>>(INDEX_NONE, FEnhancedOnlineResult::Failure(TEXT("There was nothing to wait for."))).GetFuture();
+	}
+
+	TSharedRef<FWhenAnyState> State = MakeShared<FWhenAnyState>();
+	TFuture<TPair<int32, FEnhancedOnlineResult>> Future = State->Promise.GetFuture();
+
+	for (int32 Index = 0; Index < Futures.Num(); ++Index)
+	{
+		Futures[Index].Next([State, Index](FEnhancedOnlineResult Result)
+		{
+			if (!State->bIsSet)
+			{
+				State->bIsSet = true;
+				State->Promise.SetValue(TPair<int32, FEnhancedOnlineResult>(Index, MoveTemp(Result)));
+			}
+		});
+	}
+
+	return Future;
+}
+
+TFuture<TPair<int32, FEnhancedOnlineResult>> FEnhancedOnlineAsync::WhenAnySucceeded(TArray<TFuture<FEnhancedOnlineResult>>&& Futures)
+{
+	if (Futures.Num() == 0)
+	{
+		return MakeFulfilledPromise<TPair<int32, FEnhancedOnlineResult>>(INDEX_NONE, FEnhancedOnlineResult::Failure(TEXT("There was nothing to wait for."))).GetFuture();
+	}
+
+	TSharedRef<FWhenAnyState> State = MakeShared<FWhenAnyState>();
+	State->NumPending = Futures.Num();
+
+	TFuture<TPair<int32, FEnhancedOnlineResult>> Future = State->Promise.GetFuture();
+
+	for (int32 Index = 0; Index < Futures.Num(); ++Index)
+	{
+		Futures[Index].Next([State, Index](FEnhancedOnlineResult Result)
+		{
+			const bool bIsLast = --State->NumPending == 0;
+			if (!State->bIsSet && (Result.bWasSuccessful || bIsLast))
+			{
+				State->bIsSet = true;
+				State->Promise.SetValue(TPair<int32, FEnhancedOnlineResult>(Index, MoveTemp(Result)));
+			}
+		});
+	}
+
+	return Future;
+}
+
+TFuture<FEnhancedOnlineResult> FEnhancedOnlineAsync::MakeReady(FEnhancedOnlineResult&& Result)
+{
+	return MakeFulfilledPromise<FEnhancedOnlineResult>(MoveTemp(Result)).GetFuture();
+}
@@ -0,0 +1,184 @@
+// Copyright © 2024 MajorT. All rights reserved.
+
+#include "EnhancedOnlineMapRegistry.h"
+
+#include "EnhancedOnlineSessionsSubsystem.h"
+#include "EnhancedOnlineSubsystem.h"
+#include "AssetRegistry/AssetData.h"
+#include "AssetRegistry/IAssetRegistry.h"
+#include "Engine/AssetManager.h"
+#include "Engine/GameInstance.h"
+#include "Engine/World.h"
+
+FEnhancedMapRegistry::~FEnhancedMapRegistry()
+{
+	if (IAssetRegistry* AssetRegistry = IAssetRegistry::Get())
+	{
+		AssetRegistry->OnAssetAdded().Remove(AssetAddedDelegateHandle);
+		AssetRegistry->OnAssetRemoved().Remove(AssetRemovedDelegateHandle);
+		AssetRegistry->OnAssetRenamed().Remove(AssetRenamedDelegateHandle);
+	}
+}
+
+void FEnhancedMapRegistry::Initialize()
+{
+	if (IAssetRegistry* AssetRegistry = IAssetRegistry::Get())
+	{
+		AssetAddedDelegateHandle = AssetRegistry->OnAssetAdded().AddSP(this, &FEnhancedMapRegistry::HandleAssetAdded);
+		AssetRemovedDelegateHandle = AssetRegistry->OnAssetRemoved().AddSP(this, &FEnhancedMapRegistry::HandleAssetRemoved);
+		AssetRenamedDelegateHandle = AssetRegistry->OnAssetRenamed().AddSP(this, &FEnhancedMapRegistry::HandleAssetRenamed);
+	}
+
+	/* Primary asset data is only complete once the asset manager scanned the project */
+	UAssetManager::CallOrRegister_OnCompletedInitialScan(FSimpleMulticastDelegate::FDelegate::CreateSP(this, &FEnhancedMapRegistry::Rebuild));
+}
+
+bool FEnhancedMapRegistry::FindMap(const FPrimaryAssetId& MapId, FEnhancedMapRegistryEntry& OutEntry)
+{
+	if (!MapId.IsValid())
+	{
+		return false;
+	}
+
+	if (bIsDirty)
+	{
+		Rebuild();
+	}
+
+	if (const FEnhancedMapRegistryEntry* Entry = MapsById.Find(MapId))
+	{
+		OutEntry = *Entry;
+		return true;
+	}
+
+	if (UnknownMapIds.Contains(MapId) || !UAssetManager::IsInitialized())
+	{
+		return false;
+	}
+
+	/* Maps of other primary asset types are resolved once and then served from the table */
+	FAssetData MapAssetData;
+	if (!UAssetManager::Get().GetPrimaryAssetData(MapId, MapAssetData))
+	{
+		UnknownMapIds.Add(MapId);
+		return false;
+	}
+
+	AddEntry(MapId, MapAssetData);
+	OutEntry = MapsById.FindChecked(MapId);
+	return true;
+}
+
+bool FEnhancedMapRegistry::FindMapByName(const FName AssetName, FEnhancedMapRegistryEntry& OutEntry)
+{
+	if (bIsDirty)
+	{
+		Rebuild();
+	}
+
+	if (const FPrimaryAssetId* MapId = MapIdsByName.Find(AssetName))
+	{
+		OutEntry = MapsById.FindChecked(*MapId);
+		return true;
+	}
+	return false;
+}
+
+void FEnhancedMapRegistry::Invalidate()
+{
+	bIsDirty = true;
+}
+
+bool FEnhancedMapRegistry::ResolveMap(const UObject* WorldContextObject, const FPrimaryAssetId& MapId, FEnhancedMapRegistryEntry& OutEntry)
+{
+	const UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+	const UGameInstance* GameInstance = World ? World->GetGameInstance() : nullptr;
+
+	if (UEnhancedOnlineSessionsSubsystem* Subsystem = GameInstance ? GameInstance->GetSubsystem<UEnhancedOnlineSessionsSubsystem>() : nullptr)
+	{
+		if (TSharedPtr<FEnhancedMapRegistry> MapRegistry = Subsystem->GetMapRegistry())
+		{
+			return MapRegistry->FindMap(MapId, OutEntry);
+		}
+	}
+
+	FAssetData MapAssetData;
+	if (UAssetManager::IsInitialized() && UAssetManager::Get().GetPrimaryAssetData(MapId, MapAssetData))
+	{
+		OutEntry.MapId = MapId;
+		OutEntry.AssetName = MapAssetData.AssetName;
+		OutEntry.PackageName = MapAssetData.PackageName;
+		return true;
+	}
+	return false;
+}
+
+void FEnhancedMapRegistry::Rebuild()
+{
+	if (!UAssetManager::IsInitialized())
+	{
+		return;
+	}
+
+	MapsById.Reset();
+	MapIdsByName.Reset();
+	UnknownMapIds.Reset();
+
+	UAssetManager& AssetManager = UAssetManager::Get();
+
+	TArray<FAssetData> MapAssets;
+	AssetManager.GetPrimaryAssetDataList(UAssetManager::MapType, MapAssets);
+
+	for (const FAssetData& AssetData : MapAssets)
+	{
+		AddEntry(AssetManager.GetPrimaryAssetIdForData(AssetData), AssetData);
+	}
+
+	bIsDirty = false;
+
+	UE_LOG(LogEnhancedSubsystem, Log, TEXT("Map registry resolved %d maps."), MapsById.Num());
+}
+
+void FEnhancedMapRegistry::AddEntry(const FPrimaryAssetId& MapId, const FAssetData& AssetData)
+{
+	if (!MapId.IsValid())
+	{
+		return;
+	}
+
+	FEnhancedMapRegistryEntry& Entry = MapsById.Add(MapId);
+	Entry.MapId = MapId;
+	Entry.AssetName = AssetData.AssetName;
+	Entry.PackageName = AssetData.PackageName;
+
+	MapIdsByName.Add(Entry.AssetName, MapId);
+}
+
+bool FEnhancedMapRegistry::IsMapAsset(const FAssetData& AssetData)
+{
+	return AssetData.AssetClassPath == UWorld::StaticClass()->GetClassPathName();
+}
+
+void FEnhancedMapRegistry::HandleAssetAdded(const FAssetData& AssetData)
+{
+	if (IsMapAsset(AssetData))
+	{
+		Invalidate();
+	}
+}
+
+void FEnhancedMapRegistry::HandleAssetRemoved(const FAssetData& AssetData)
+{
+	if (IsMapAsset(AssetData))
+	{
+		Invalidate();
+	}
+}
+
+void FEnhancedMapRegistry::HandleAssetRenamed(const FAssetData& AssetData, const FString& OldObjectPath)
+{
+	if (IsMapAsset(AssetData))
+	{
+		Invalidate();
+	}
+}
@@ -0,0 +1,307 @@
+// Copyright © 2024 MajorT. All rights reserved.
+
+#include "EnhancedOnlineQos.h"
+
+#include "EnhancedOnlineRequests.h"
+#include "EnhancedOnlineSubsystem.h"
+#include "Sockets.h"
+#include "SocketSubsystem.h"
+#include "Common/UdpSocketBuilder.h"
+
+namespace
+{
+	void WriteQosPacket(uint8* Buffer, uint32 Nonce)
+	{
+		const uint32 Magic = FEnhancedSessionQosProber::PacketMagic;
+		FMemory::Memcpy(Buffer, &Magic, sizeof(uint32));
+		FMemory::Memcpy(Buffer + sizeof(uint32), &Nonce, sizeof(uint32));
+	}
+
+	bool ReadQosPacket(const uint8* Buffer, int32 BytesRead, uint32& OutNonce)
+	{
+		if (BytesRead != FEnhancedSessionQosProber::PacketSize)
+		{
+			return false;
+		}
+
+		uint32 Magic = 0;
+		FMemory::Memcpy(&Magic, Buffer, sizeof(uint32));
+		FMemory::Memcpy(&OutNonce, Buffer + sizeof(uint32), sizeof(uint32));
+
+		return Magic == FEnhancedSessionQosProber::PacketMagic;
+	}
+
+	/* The low 24 bits identify the probe, the high 8 bits the attempt so late replies of older attempts are ignored */
+	uint32 MakeNonce(int32 ProbeIndex, int32 Attempt)
+	{
+		return (static_cast<uint32>(ProbeIndex) & 0x00FFFFFFu) | (static_cast<uint32>(Attempt & 0xFF) << 24);
+	}
+
+	void DestroySocket(FSocket*& Socket)
+	{
+		if (Socket)
+		{
+			Socket->Close();
+			ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM)->DestroySocket(Socket);
+			Socket = nullptr;
+		}
+	}
+}
+
+FEnhancedSessionQosProber::FEnhancedSessionQosProber(int32 InMaxConcurrentProbes, float InTimeoutSeconds, int32 InMaxAttempts)
+	: MaxConcurrentProbes(FMath::Max(InMaxConcurrentProbes, 1))
+	, TimeoutSeconds(FMath::Max(InTimeoutSeconds, 0.01f))
+	, MaxAttempts(FMath::Clamp(InMaxAttempts, 1, 255))
+{
+}
+
+FEnhancedSessionQosProber::~FEnhancedSessionQosProber()
+{
+	Cancel();
+}
+
+void FEnhancedSessionQosProber::AddProbe(UEnhancedSessionSearchResult* Result, const TSharedRef<FInternetAddr>& Address)
+{
+	FProbe& Probe = Probes.AddDefaulted_GetRef();
+	Probe.Result = Result;
+	Probe.Address = Address;
+}
+
+bool FEnhancedSessionQosProber::Start(FOnEnhancedQosProbesCompleted InOnCompleted)
+{
+	if (Probes.IsEmpty())
+	{
+		return false;
+	}
+
+	Socket = FUdpSocketBuilder(TEXT("EnhancedSessionQosProber"))
+		.AsNonBlocking()
+		.AsReusable()
+		.Build();
+
+	if (Socket == nullptr)
+	{
+		UE_LOG(LogEnhancedSubsystem, Error, TEXT("Failed to create the QoS probe socket."));
+		return false;
+	}
+
+	OnCompleted = InOnCompleted;
+	TickerHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateSP(this, &FEnhancedSessionQosProber::Tick));
+
+	const double Now = FPlatformTime::Seconds();
+	while (NextProbeIndex < Probes.Num() && NumInFlight < MaxConcurrentProbes)
+	{
+		SendProbe(NextProbeIndex++, Now);
+	}
+
+	return true;
+}
+
+void FEnhancedSessionQosProber::Cancel()
+{
+	FTSTicker::GetCoreTicker().RemoveTicker(TickerHandle);
+	TickerHandle.Reset();
+
+	DestroySocket(Socket);
+	OnCompleted.Unbind();
+}
+
+void FEnhancedSessionQosProber::SendProbe(int32 ProbeIndex, double Now)
+{
+	FProbe& Probe = Probes[ProbeIndex];
+
+	uint8 Buffer[PacketSize];
+	WriteQosPacket(Buffer, MakeNonce(ProbeIndex, Probe.Attempts));
+
+	int32 BytesSent = 0;
+	if (!Socket->SendTo(Buffer, PacketSize, BytesSent, *Probe.Address))
+	{
+		UE_LOG(LogEnhancedSubsystem, Verbose, TEXT("Failed to send QoS probe to %s."), *Probe.Address->ToString(true));
+	}
+
+	if (!Probe.bInFlight)
+	{
+		Probe.bInFlight = true;
+		NumInFlight++;
+	}
+
+	Probe.SendTime = Now;
+	Probe.Attempts++;
+}
+
+void FEnhancedSessionQosProber::CompleteProbe(int32 ProbeIndex, int32 PingInMs)
+{
+	FProbe& Probe = Probes[ProbeIndex];
+	if (Probe.bCompleted)
+	{
+		return;
+	}
+
+	Probe.bCompleted = true;
+	Probe.bInFlight = false;
+	NumInFlight--;
+	NumCompleted++;
+
+	/* Unreachable hosts keep the ping reported by the online service */
+	if (PingInMs >= 0)
+	{
+		if (UEnhancedSessionSearchResult* Result = Probe.Result.Get())
+		{
+			Result->SetMeasuredPing(PingInMs);
+		}
+	}
+}
+
+void FEnhancedSessionQosProber::ReceiveReplies(double Now)
+{
+	TSharedRef<FInternetAddr> Sender = ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM)->CreateInternetAddr();
+
+	uint8 Buffer[PacketSize * 2];
+	uint32 PendingDataSize = 0;
+
+	while (Socket->HasPendingData(PendingDataSize))
+	{
+		int32 BytesRead = 0;
+		if (!Socket->RecvFrom(Buffer, sizeof(Buffer), BytesRead, *Sender))
+		{
+			break;
+		}
+
+		uint32 Nonce = 0;
+		if (!ReadQosPacket(Buffer, BytesRead, Nonce))
+		{
+			continue;
+		}
+
+		const int32 ProbeIndex = static_cast<int32>(Nonce & 0x00FFFFFFu);
+		const int32 Attempt = static_cast<int32>(Nonce >> 24);
+
+		if (!Probes.IsValidIndex(ProbeIndex) || Probes[ProbeIndex].Attempts - 1 != Attempt)
+		{
+			continue;
+		}
+
+		const int32 PingInMs = FMath::RoundToInt32((Now - Probes[ProbeIndex].SendTime) * 1000.0);
+		CompleteProbe(ProbeIndex, PingInMs);
+	}
+}
+
+bool FEnhancedSessionQosProber::Tick(float DeltaTime)
+{
+	/* Keep ourselves alive in case the owner drops us from the completion delegate */
+	TSharedRef<FEnhancedSessionQosProber> KeepAlive = AsShared();
+
+	const double Now = FPlatformTime::Seconds();
+	ReceiveReplies(Now);
+
+	for (int32 ProbeIndex = 0; ProbeIndex < NextProbeIndex; ++ProbeIndex)
+	{
+		const FProbe& Probe = Probes[ProbeIndex];
+		if (!Probe.bInFlight || Now - Probe.SendTime < TimeoutSeconds)
+		{
+			continue;
+		}
+
+		if (Probe.Attempts < MaxAttempts)
+		{
+			SendProbe(ProbeIndex, Now);
+		}
+		else
+		{
+			CompleteProbe(ProbeIndex, INDEX_NONE);
+		}
+	}
+
+	while (NextProbeIndex < Probes.Num() && NumInFlight < MaxConcurrentProbes)
+	{
+		SendProbe(NextProbeIndex++, Now);
+	}
+
+	if (NumCompleted >= Probes.Num())
+	{
+		Finish();
+		return false;
+	}
+
+	return true;
+}
+
+void FEnhancedSessionQosProber::Finish()
+{
+	TickerHandle.Reset();
+	DestroySocket(Socket);
+
+	FOnEnhancedQosProbesCompleted CompletedDelegate = OnCompleted;
+	OnCompleted.Unbind();
+	CompletedDelegate.ExecuteIfBound();
+}
+
+FEnhancedSessionQosResponder::~FEnhancedSessionQosResponder()
+{
+	Stop();
+}
+
+bool FEnhancedSessionQosResponder::Start(int32 InPort)
+{
+	Stop();
+
+	Socket = FUdpSocketBuilder(TEXT("EnhancedSessionQosResponder"))
+		.AsNonBlocking()
+		.AsReusable()
+		.BoundToPort(InPort)
+		.Build();
+
+	if (Socket == nullptr)
+	{
+		UE_LOG(LogEnhancedSubsystem, Error, TEXT("Failed to bind the QoS responder to port %d."), InPort);
+		return false;
+	}
+
+	Port = InPort;
+	TickerHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateSP(this, &FEnhancedSessionQosResponder::Tick));
+
+	UE_LOG(LogEnhancedSubsystem, Log, TEXT("QoS responder listening on port %d."), Port);
+	return true;
+}
+
+void FEnhancedSessionQosResponder::Stop()
+{
+	FTSTicker::GetCoreTicker().RemoveTicker(TickerHandle);
+	TickerHandle.Reset();
+
+	DestroySocket(Socket);
+	Port = 0;
+}
+
+bool FEnhancedSessionQosResponder::Tick(float DeltaTime)
+{
+	if (Socket == nullptr)
+	{
+		return false;
+	}
+
+	TSharedRef<FInternetAddr> Sender = ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM)->CreateInternetAddr();
+
+	uint8 Buffer[FEnhancedSessionQosProber::PacketSize * 2];
+	uint32 PendingDataSize = 0;
+
+	while (Socket->HasPendingData(PendingDataSize))
+	{
+		int32 BytesRead = 0;
+		if (!Socket->RecvFrom(Buffer, sizeof(Buffer), BytesRead, *Sender))
+		{
+			break;
+		}
+
+		uint32 Nonce = 0;
+		if (!ReadQosPacket(Buffer, BytesRead, Nonce))
+		{
+			continue;
+		}
+
+		int32 BytesSent = 0;
+		Socket->SendTo(Buffer, BytesRead, BytesSent, *Sender);
+	}
+
+	return true;
+}
@@ -0,0 +1,142 @@
+// Copyright © 2024 MajorT. All rights reserved.
+
+#include "EnhancedOnlineRequestScheduler.h"
+
+void FEnhancedRequestScheduler::SetCategoryLimits(const EEnhancedRequestCategory Category, const int32 MaxRunning, const int32 MaxQueued)
+{
+	FRequestCategory& RequestCategory = GetCategory(Category);
+	RequestCategory.MaxRunning = FMath::Max(MaxRunning, 1);
+	RequestCategory.MaxQueued = FMath::Max(MaxQueued, 0);
+}
+
+uint64 FEnhancedRequestScheduler::Schedule(const EEnhancedRequestCategory Category, const FName Lane, const EEnhancedRequestPriority Priority, const FOnEnhancedScheduledRequestStart& OnStart)
+{
+	FRequestCategory& RequestCategory = GetCategory(Category);
+	if (RequestCategory.Queue.Num() >= RequestCategory.MaxQueued)
+	{
+		return 0;
+	}
+
+	const uint64 CorrelationId = NextCorrelationId++;
+
+	FScheduledRequest Request;
+	Request.CorrelationId = CorrelationId;
+	Request.Lane = Lane;
+	Request.Priority = Priority;
+	Request.OnStart = OnStart;
+
+	/* Behind every request of the same or a higher priority, so equal priorities stay first in first out */
+	int32 InsertIndex = RequestCategory.Queue.Num();
+	while (InsertIndex > 0 && RequestCategory.Queue[InsertIndex - 1].Priority < Priority)
+	{
+		InsertIndex--;
+	}
+	RequestCategory.Queue.Insert(MoveTemp(Request), InsertIndex);
+
+	return CorrelationId;
+}
+
+void FEnhancedRequestScheduler::Dispatch()
+{
+	/* Requests that complete right away dispatch again from within their start, the outer loop picks that up */
+	if (bIsDispatching)
+	{
+		bNeedsDispatch = true;
+		return;
+	}
+
+	TGuardValue<bool> DispatchGuard(bIsDispatching, true);
+
+	do
+	{
+		bNeedsDispatch = false;
+
+		for (FRequestCategory& RequestCategory : Categories)
+		{
+			FScheduledRequest Started;
+			while (StartNext(RequestCategory, Started))
+			{
+				Started.OnStart.ExecuteIfBound(Started.CorrelationId);
+			}
+		}
+	}
+	while (bNeedsDispatch);
+}
+
+bool FEnhancedRequestScheduler::StartNext(FRequestCategory& Category, FScheduledRequest& OutStarted)
+{
+	if (Category.Running.Num() >= Category.MaxRunning)
+	{
+		return false;
+	}
+
+	for (int32 Index = 0; Index < Category.Queue.Num(); ++Index)
+	{
+		const FName Lane = Category.Queue[Index].Lane;
+		if (Category.Running.ContainsByPredicate([Lane](const FScheduledRequest& Running) { return Running.Lane == Lane; }))
+		{
+			continue;
+		}
+
+		OutStarted = Category.Queue[Index];
+		Category.Queue.RemoveAt(Index);
+
+		/* The start delegate isn't needed anymore, the running entry only holds the lane */
+		Category.Running.Add({ OutStarted.CorrelationId, OutStarted.Lane, OutStarted.Priority, FOnEnhancedScheduledRequestStart() });
+		return true;
+	}
+
+	return false;
+}
+
+void FEnhancedRequestScheduler::Complete(const uint64 CorrelationId)
+{
+	if (CorrelationId == 0)
+	{
+		return;
+	}
+
+	const auto HasId = [CorrelationId](const FScheduledRequest& Request) { return Request.CorrelationId == CorrelationId; };
+
+	for (FRequestCategory& RequestCategory : Categories)
+	{
+		if (RequestCategory.Running.RemoveAll(HasId) > 0)
+		{
+			Dispatch();
+			return;
+		}
+
+		if (RequestCategory.Queue.RemoveAll(HasId) > 0)
+		{
+			return;
+		}
+	}
+}
+
+uint64 FEnhancedRequestScheduler::FindRunning(const EEnhancedRequestCategory Category, const FName Lane) const
+{
+	const FScheduledRequest* Running = GetCategory(Category).Running.FindByPredicate([Lane](const FScheduledRequest& Request) { return Request.Lane == Lane; });
+	return Running ? Running->CorrelationId : 0;
+}
+
+bool FEnhancedRequestScheduler::IsRunning(const uint64 CorrelationId) const
+{
+	for (const FRequestCategory& RequestCategory : Categories)
+	{
+		if (RequestCategory.Running.ContainsByPredicate([CorrelationId](const FScheduledRequest& Request) { return Request.CorrelationId == CorrelationId; }))
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void FEnhancedRequestScheduler::Reset()
+{
+	for (FRequestCategory& RequestCategory : Categories)
+	{
+		RequestCategory.Queue.Empty();
+		RequestCategory.Running.Empty();
+	}
+}
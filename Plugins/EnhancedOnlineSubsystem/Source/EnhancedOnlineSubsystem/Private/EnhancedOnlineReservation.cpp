@@ -0,0 +1,321 @@
+// Copyright © 2024 MajorT. All rights reserved.
+
+#include "EnhancedOnlineReservation.h"
+
+#include "EnhancedOnlineSubsystem.h"
+#include "IPAddress.h"
+#include "Sockets.h"
+#include "SocketSubsystem.h"
+#include "Common/UdpSocketBuilder.h"
+
+namespace
+{
+	void WriteReservationRequest(uint8* Buffer, const uint32 Nonce, const uint32 SessionKey, const uint64 ClientToken)
+	{
+		const uint32 Magic = FEnhancedSessionReservationHost::RequestMagic;
+		FMemory::Memcpy(Buffer, &Magic, sizeof(uint32));
+		FMemory::Memcpy(Buffer + 4, &Nonce, sizeof(uint32));
+		FMemory::Memcpy(Buffer + 8, &SessionKey, sizeof(uint32));
+		FMemory::Memcpy(Buffer + 12, &ClientToken, sizeof(uint64));
+	}
+
+	bool ReadReservationRequest(const uint8* Buffer, const int32 BytesRead, uint32& OutNonce, uint32& OutSessionKey, uint64& OutClientToken)
+	{
+		if (BytesRead != FEnhancedSessionReservationHost::RequestSize)
+		{
+			return false;
+		}
+
+		uint32 Magic = 0;
+		FMemory::Memcpy(&Magic, Buffer, sizeof(uint32));
+		FMemory::Memcpy(&OutNonce, Buffer + 4, sizeof(uint32));
+		FMemory::Memcpy(&OutSessionKey, Buffer + 8, sizeof(uint32));
+		FMemory::Memcpy(&OutClientToken, Buffer + 12, sizeof(uint64));
+
+		return Magic == FEnhancedSessionReservationHost::RequestMagic;
+	}
+
+	void WriteReservationReply(uint8* Buffer, const uint32 Nonce, const EEnhancedReservationResult Result)
+	{
+		const uint32 Magic = FEnhancedSessionReservationHost::ReplyMagic;
+		FMemory::Memcpy(Buffer, &Magic, sizeof(uint32));
+		FMemory::Memcpy(Buffer + 4, &Nonce, sizeof(uint32));
+		Buffer[8] = static_cast<uint8>(Result);
+	}
+
+	bool ReadReservationReply(const uint8* Buffer, const int32 BytesRead, uint32& OutNonce, EEnhancedReservationResult& OutResult)
+	{
+		if (BytesRead != FEnhancedSessionReservationHost::ReplySize)
+		{
+			return false;
+		}
+
+		uint32 Magic = 0;
+		FMemory::Memcpy(&Magic, Buffer, sizeof(uint32));
+		FMemory::Memcpy(&OutNonce, Buffer + 4, sizeof(uint32));
+		OutResult = static_cast<EEnhancedReservationResult>(Buffer[8]);
+
+		return Magic == FEnhancedSessionReservationHost::ReplyMagic && Buffer[8] < static_cast<uint8>(EEnhancedReservationResult::NoResponse);
+	}
+
+	void DestroySocket(FSocket*& Socket)
+	{
+		if (Socket)
+		{
+			Socket->Close();
+			ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM)->DestroySocket(Socket);
+			Socket = nullptr;
+		}
+	}
+}
+
+FEnhancedSessionReservationHost::~FEnhancedSessionReservationHost()
+{
+	Stop();
+}
+
+bool FEnhancedSessionReservationHost::Start(int32 InPort, float InReservationTimeToLive)
+{
+	Stop();
+
+	Socket = FUdpSocketBuilder(TEXT("EnhancedSessionReservationHost"))
+		.AsNonBlocking()
+		.AsReusable()
+		.BoundToPort(InPort)
+		.Build();
+
+	if (Socket == nullptr)
+	{
+		UE_LOG(LogEnhancedSubsystem, Error, TEXT("Failed to bind the reservation host to port %d."), InPort);
+		return false;
+	}
+
+	Port = InPort;
+	ReservationTimeToLive = FMath::Max(InReservationTimeToLive, 1.f);
+	TickerHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateSP(this, &FEnhancedSessionReservationHost::Tick));
+
+	UE_LOG(LogEnhancedSubsystem, Log, TEXT("Reservation host listening on port %d."), Port);
+	return true;
+}
+
+void FEnhancedSessionReservationHost::Stop()
+{
+	FTSTicker::GetCoreTicker().RemoveTicker(TickerHandle);
+	TickerHandle.Reset();
+
+	DestroySocket(Socket);
+	Port = 0;
+	Reservations.Reset();
+}
+
+bool FEnhancedSessionReservationHost::ConsumeReservation(const uint64 ClientToken)
+{
+	return Reservations.RemoveAllSwap([ClientToken](const FReservation& Reservation) { return Reservation.ClientToken == ClientToken; }) > 0;
+}
+
+int32 FEnhancedSessionReservationHost::GetNumReservations(const uint32 SessionKey) const
+{
+	int32 NumReservations = 0;
+	for (const FReservation& Reservation : Reservations)
+	{
+		NumReservations += Reservation.SessionKey == SessionKey ? 1 : 0;
+	}
+	return NumReservations;
+}
+
+EEnhancedReservationResult FEnhancedSessionReservationHost::Reserve(const uint32 SessionKey, const uint64 ClientToken, const double Now)
+{
+	/* Requests are sent again when a reply gets lost, a client never holds more than one slot */
+	FReservation* Existing = Reservations.FindByPredicate([ClientToken](const FReservation& Reservation) { return Reservation.ClientToken == ClientToken; });
+	if (Existing && Existing->SessionKey == SessionKey)
+	{
+		Existing->ExpiryTime = Now + ReservationTimeToLive;
+		return EEnhancedReservationResult::Accepted;
+	}
+
+	const int32 OpenSlots = OnQueryOpenSlots.IsBound() ? OnQueryOpenSlots.Execute(SessionKey) : INDEX_NONE;
+	if (OpenSlots == INDEX_NONE)
+	{
+		return EEnhancedReservationResult::UnknownSession;
+	}
+
+	if (OpenSlots - GetNumReservations(SessionKey) <= 0)
+	{
+		return EEnhancedReservationResult::SessionFull;
+	}
+
+	ConsumeReservation(ClientToken);
+
+	FReservation& Reservation = Reservations.AddDefaulted_GetRef();
+	Reservation.ClientToken = ClientToken;
+	Reservation.SessionKey = SessionKey;
+	Reservation.ExpiryTime = Now + ReservationTimeToLive;
+
+	return EEnhancedReservationResult::Accepted;
+}
+
+bool FEnhancedSessionReservationHost::Tick(float DeltaTime)
+{
+	if (Socket == nullptr)
+	{
+		return false;
+	}
+
+	const double Now = FPlatformTime::Seconds();
+	Reservations.RemoveAllSwap([Now](const FReservation& Reservation) { return Reservation.ExpiryTime < Now; });
+
+	TSharedRef<FInternetAddr> Sender = ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM)->CreateInternetAddr();
+
+	uint8 Buffer[RequestSize * 2];
+	uint32 PendingDataSize = 0;
+
+	while (Socket->HasPendingData(PendingDataSize))
+	{
+		int32 BytesRead = 0;
+		if (!Socket->RecvFrom(Buffer, sizeof(Buffer), BytesRead, *Sender))
+		{
+			break;
+		}
+
+		uint32 Nonce = 0;
+		uint32 SessionKey = 0;
+		uint64 ClientToken = 0;
+		if (!ReadReservationRequest(Buffer, BytesRead, Nonce, SessionKey, ClientToken))
+		{
+			continue;
+		}
+
+		const EEnhancedReservationResult Result = Reserve(SessionKey, ClientToken, Now);
+		UE_LOG(LogEnhancedSubsystem, Verbose, TEXT("Slot reservation from %s: %s."), *Sender->ToString(true), *UEnum::GetValueAsString(Result));
+
+		uint8 Reply[ReplySize];
+		WriteReservationReply(Reply, Nonce, Result);
+
+		int32 BytesSent = 0;
+		Socket->SendTo(Reply, ReplySize, BytesSent, *Sender);
+	}
+
+	return true;
+}
+
+FEnhancedSessionReservationClient::FEnhancedSessionReservationClient(float InTimeoutSeconds, int32 InMaxAttempts)
+	: TimeoutSeconds(FMath::Max(InTimeoutSeconds, 0.01f))
+	, MaxAttempts(FMath::Max(InMaxAttempts, 1))
+{
+}
+
+FEnhancedSessionReservationClient::~FEnhancedSessionReservationClient()
+{
+	Cancel();
+}
+
+bool FEnhancedSessionReservationClient::Start(const TSharedRef<FInternetAddr>& InAddress, const uint32 InSessionKey, const uint64 InClientToken, FOnEnhancedReservationCompleted InOnCompleted)
+{
+	Cancel();
+
+	Socket = FUdpSocketBuilder(TEXT("EnhancedSessionReservationClient"))
+		.AsNonBlocking()
+		.AsReusable()
+		.Build();
+
+	if (Socket == nullptr)
+	{
+		UE_LOG(LogEnhancedSubsystem, Error, TEXT("Failed to create the reservation socket."));
+		return false;
+	}
+
+	Address = InAddress;
+	SessionKey = InSessionKey;
+	ClientToken = InClientToken;
+	Attempts = 0;
+	OnCompleted = InOnCompleted;
+
+	TickerHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateSP(this, &FEnhancedSessionReservationClient::Tick));
+	SendRequest(FPlatformTime::Seconds());
+
+	return true;
+}
+
+void FEnhancedSessionReservationClient::Cancel()
+{
+	FTSTicker::GetCoreTicker().RemoveTicker(TickerHandle);
+	TickerHandle.Reset();
+
+	DestroySocket(Socket);
+	OnCompleted.Unbind();
+}
+
+void FEnhancedSessionReservationClient::SendRequest(const double Now)
+{
+	uint8 Buffer[FEnhancedSessionReservationHost::RequestSize];
+	WriteReservationRequest(Buffer, static_cast<uint32>(Attempts), SessionKey, ClientToken);
+
+	int32 BytesSent = 0;
+	if (!Socket->SendTo(Buffer, FEnhancedSessionReservationHost::RequestSize, BytesSent, *Address))
+	{
+		UE_LOG(LogEnhancedSubsystem, Verbose, TEXT("Failed to send the slot reservation to %s."), *Address->ToString(true));
+	}
+
+	SendTime = Now;
+	Attempts++;
+}
+
+bool FEnhancedSessionReservationClient::Tick(float DeltaTime)
+{
+	/* Keep ourselves alive in case the owner drops us from the completion delegate */
+	TSharedRef<FEnhancedSessionReservationClient> KeepAlive = AsShared();
+
+	TSharedRef<FInternetAddr> Sender = ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM)->CreateInternetAddr();
+
+	uint8 Buffer[FEnhancedSessionReservationHost::ReplySize * 2];
+	uint32 PendingDataSize = 0;
+
+	while (Socket && Socket->HasPendingData(PendingDataSize))
+	{
+		int32 BytesRead = 0;
+		if (!Socket->RecvFrom(Buffer, sizeof(Buffer), BytesRead, *Sender))
+		{
+			break;
+		}
+
+		/* Any answered attempt counts, the host treats repeated requests of a client as one */
+		uint32 Nonce = 0;
+		EEnhancedReservationResult Result = EEnhancedReservationResult::NoResponse;
+		if (ReadReservationReply(Buffer, BytesRead, Nonce, Result) && Nonce < static_cast<uint32>(Attempts))
+		{
+			Finish(Result);
+			return false;
+		}
+	}
+
+	if (Socket == nullptr)
+	{
+		return false;
+	}
+
+	const double Now = FPlatformTime::Seconds();
+	if (Now - SendTime >= TimeoutSeconds)
+	{
+		if (Attempts < MaxAttempts)
+		{
+			SendRequest(Now);
+		}
+		else
+		{
+			Finish(EEnhancedReservationResult::NoResponse);
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void FEnhancedSessionReservationClient::Finish(const EEnhancedReservationResult Result)
+{
+	TickerHandle.Reset();
+	DestroySocket(Socket);
+
+	FOnEnhancedReservationCompleted CompletedDelegate = OnCompleted;
+	OnCompleted.Unbind();
+	CompletedDelegate.ExecuteIfBound(Result);
+}
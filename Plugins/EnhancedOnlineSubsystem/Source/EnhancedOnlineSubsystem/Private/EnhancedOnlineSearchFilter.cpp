@@ -0,0 +1,199 @@
+// Copyright © 2024 MajorT. All rights reserved.
+
+#include "EnhancedOnlineSearchFilter.h"
+
+#include "EnhancedOnlineRequests.h"
+#include "Algo/Sort.h"
+
+void FEnhancedSessionSearchColumns::Build(TConstArrayView<UEnhancedSessionSearchResult*> Results)
+{
+	const int32 Count = Results.Num();
+
+	Ping.SetNumUninitialized(Count);
+	OpenPublicConnections.SetNumUninitialized(Count);
+	CurrentPlayers.SetNumUninitialized(Count);
+	MaxPlayers.SetNumUninitialized(Count);
+	GameModeHash.SetNumUninitialized(Count);
+	MapNameHash.SetNumUninitialized(Count);
+	Attributes.SetNumUninitialized(Count);
+
+	for (int32 Row = 0; Row < Count; ++Row)
+	{
+		const FEnhancedSessionSearchResultAttributes& RowAttributes = Results[Row]->GetAttributes();
+
+		Ping[Row] = RowAttributes.PingInMs;
+		OpenPublicConnections[Row] = RowAttributes.OpenPublicConnections;
+		CurrentPlayers[Row] = RowAttributes.CurrentPlayers;
+		MaxPlayers[Row] = RowAttributes.MaxPlayers;
+		GameModeHash[Row] = RowAttributes.GameModeHash;
+		MapNameHash[Row] = RowAttributes.MapNameHash;
+		Attributes[Row] = &RowAttributes;
+	}
+}
+
+void FEnhancedSessionSearchColumns::Filter(const FEnhancedSessionSearchFilter& InFilter, TArray<int32>& OutRows) const
+{
+	const int32 Count = Num();
+
+	Mask.SetNumUninitialized(Count);
+	uint8* RESTRICT MaskData = Mask.GetData();
+	FMemory::Memset(MaskData, 1, Count);
+
+	/* Every predicate is a branchless pass over a single column */
+	const int32 MinOpenSlots = FMath::Max(InFilter.MinOpenSlots, InFilter.bExcludeFull ? 1 : 0);
+	if (MinOpenSlots > 0)
+	{
+		const int32* RESTRICT Column = OpenPublicConnections.GetData();
+		for (int32 Row = 0; Row < Count; ++Row)
+		{
+			MaskData[Row] &= static_cast<uint8>(Column[Row] >= MinOpenSlots);
+		}
+	}
+
+	if (InFilter.MaxPingInMs > 0)
+	{
+		const int32 MaxPing = InFilter.MaxPingInMs;
+		const int32* RESTRICT Column = Ping.GetData();
+		for (int32 Row = 0; Row < Count; ++Row)
+		{
+			MaskData[Row] &= static_cast<uint8>(Column[Row] <= MaxPing);
+		}
+	}
+
+	if (!InFilter.GameMode.IsEmpty())
+	{
+		const uint32 Hash = GetTypeHash(InFilter.GameMode);
+		const uint32* RESTRICT Column = GameModeHash.GetData();
+		for (int32 Row = 0; Row < Count; ++Row)
+		{
+			MaskData[Row] &= static_cast<uint8>(Column[Row] == Hash);
+		}
+	}
+
+	if (!InFilter.MapName.IsEmpty())
+	{
+		const uint32 Hash = GetTypeHash(InFilter.MapName);
+		const uint32* RESTRICT Column = MapNameHash.GetData();
+		for (int32 Row = 0; Row < Count; ++Row)
+		{
+			MaskData[Row] &= static_cast<uint8>(Column[Row] == Hash);
+		}
+	}
+
+	/* Hashes can collide, so the few rows that passed a string filter are confirmed by comparing the strings */
+	if (!InFilter.GameMode.IsEmpty() || !InFilter.MapName.IsEmpty())
+	{
+		for (int32 Row = 0; Row < Count; ++Row)
+		{
+			if (MaskData[Row]
+				&& ((!InFilter.GameMode.IsEmpty() && Attributes[Row]->GameMode != InFilter.GameMode)
+					|| (!InFilter.MapName.IsEmpty() && Attributes[Row]->MapName != InFilter.MapName)))
+			{
+				MaskData[Row] = 0;
+			}
+		}
+	}
+
+	/* Branchless compaction of the mask into row indices */
+	OutRows.SetNumUninitialized(Count);
+	int32* RESTRICT RowData = OutRows.GetData();
+	int32 NumRows = 0;
+	for (int32 Row = 0; Row < Count; ++Row)
+	{
+		RowData[NumRows] = Row;
+		NumRows += MaskData[Row];
+	}
+	OutRows.SetNum(NumRows, false);
+}
+
+const TArray<int32>& FEnhancedSessionSearchColumns::GetSortColumn(EEnhancedSessionSortKey SortKey) const
+{
+	switch (SortKey)
+	{
+	case EEnhancedSessionSortKey::OpenSlots:
+		return OpenPublicConnections;
+	case EEnhancedSessionSortKey::CurrentPlayers:
+		return CurrentPlayers;
+	case EEnhancedSessionSortKey::MaxPlayers:
+		return MaxPlayers;
+	case EEnhancedSessionSortKey::Ping:
+	default:
+		return Ping;
+	}
+}
+
+void FEnhancedSessionSearchColumns::Sort(const FEnhancedSessionSearchFilter& InFilter, TArray<int32>& InOutRows) const
+{
+	if (InFilter.SortKey == EEnhancedSessionSortKey::None || InOutRows.Num() < 2)
+	{
+		return;
+	}
+
+	const int32* RESTRICT Column = GetSortColumn(InFilter.SortKey).GetData();
+	const uint32 Flip = InFilter.bSortDescending ? 0xFFFFFFFFu : 0u;
+	const int32 Count = InOutRows.Num();
+
+	/* Pack the order preserving key and the row into one integer, sorting those is stable and cache friendly */
+	SortKeys.SetNumUninitialized(Count);
+	for (int32 Index = 0; Index < Count; ++Index)
+	{
+		const int32 Row = InOutRows[Index];
+		const uint32 Key = (static_cast<uint32>(Column[Row]) ^ 0x80000000u) ^ Flip;
+		SortKeys[Index] = (static_cast<uint64>(Key) << 32) | static_cast<uint32>(Row);
+	}
+
+	Algo::Sort(SortKeys);
+
+	for (int32 Index = 0; Index < Count; ++Index)
+	{
+		InOutRows[Index] = static_cast<int32>(SortKeys[Index] & 0xFFFFFFFFu);
+	}
+}
+
+void FEnhancedSessionSearchColumns::FilterAndSort(TConstArrayView<UEnhancedSessionSearchResult*> Results, const FEnhancedSessionSearchFilter& InFilter, TArray<UEnhancedSessionSearchResult*>& OutResults)
+{
+	FEnhancedSessionSearchColumns Columns;
+	Columns.Build(Results);
+
+	TArray<int32> Rows;
+	Columns.Filter(InFilter, Rows);
+	Columns.Sort(InFilter, Rows);
+
+	if (InFilter.MaxResults > 0 && Rows.Num() > InFilter.MaxResults)
+	{
+		Rows.SetNum(InFilter.MaxResults, false);
+	}
+
+	OutResults.Reset(Rows.Num());
+	for (const int32 Row : Rows)
+	{
+		OutResults.Add(Results[Row]);
+	}
+}
+
+float FEnhancedQuickJoinScoring::Score(const FEnhancedSessionSearchResultAttributes& Attributes) const
+{
+	const bool bHasGameMode = !GameMode.IsEmpty() && Attributes.GameModeHash == GetTypeHash(GameMode) && Attributes.GameMode == GameMode;
+
+	if (Attributes.OpenPublicConnections < FMath::Max(MinOpenSlots, 1)
+		|| (MaxPingInMs > 0 && Attributes.PingInMs > MaxPingInMs)
+		|| (bRequireGameMode && !GameMode.IsEmpty() && !bHasGameMode))
+	{
+		return -1.f;
+	}
+
+	const float PingScore = 1.f - FMath::Clamp(static_cast<float>(Attributes.PingInMs) / FMath::Max(ReferencePingInMs, 1), 0.f, 1.f);
+	const float FillScore = Attributes.MaxPlayers > 0 ? FMath::Clamp(static_cast<float>(Attributes.CurrentPlayers) / Attributes.MaxPlayers, 0.f, 1.f) : 0.f;
+	const float GameModeScore = bHasGameMode ? 1.f : 0.f;
+	const float BackfillScore = Attributes.BackfillSlots > 0 ? 1.f : 0.f;
+
+	/* A preference nobody set doesn't dilute the others */
+	const float EffectiveGameModeWeight = GameMode.IsEmpty() ? 0.f : GameModeWeight;
+	const float TotalWeight = PingWeight + FillWeight + EffectiveGameModeWeight + BackfillWeight;
+	if (TotalWeight <= 0.f)
+	{
+		return 0.f;
+	}
+
+	return (PingWeight * PingScore + FillWeight * FillScore + EffectiveGameModeWeight * GameModeScore + BackfillWeight * BackfillScore) / TotalWeight;
+}
@@ -3,6 +3,11 @@
 
 #include "EnhancedOnlineSessionsSubsystem.h"
 
+#include "EnhancedOnlineBrowser.h"
+#include "EnhancedOnlineMapRegistry.h"
+#include "EnhancedOnlineQos.h"
+#include "EnhancedOnlineRequests.h"
+#include "EnhancedOnlineReservation.h"
 #include "OnlineSessionSettings.h"
 #include "OnlineSubsystemUtils.h"
 #include "Interfaces/OnlineSessionInterface.h"
@@ -14,10 +19,87 @@ class IOnlineSubsystem;
 void UEnhancedOnlineSessionsSubsystem::Initialize(FSubsystemCollectionBase& Collection)
 {
 	Super::Initialize(Collection);
+
+	SearchCache = MakeShared<FEnhancedSessionSearchCache>();
+
+	/* Every join travels the game session, so only one runs at a time */
+	RequestScheduler = MakeShared<FEnhancedRequestScheduler>();
+	RequestScheduler->SetCategoryLimits(EEnhancedRequestCategory::Identity, MaxConcurrentIdentityRequests, MaxQueuedRequests);
+	RequestScheduler->SetCategoryLimits(EEnhancedRequestCategory::StartSession, MaxConcurrentStartSessionRequests, MaxQueuedRequests);
+	RequestScheduler->SetCategoryLimits(EEnhancedRequestCategory::Join, 1, MaxQueuedRequests);
+
+	MapRegistry = MakeShared<FEnhancedMapRegistry>();
+	MapRegistry->Initialize();
 }
 
 void UEnhancedOnlineSessionsSubsystem::Deinitialize()
 {
+	if (IOnlineSessionPtr Sessions = Online::GetSessionInterface(GetWorld()))
+	{
+		Sessions->ClearOnFindSessionsCompleteDelegate_Handle(FindSessionsDelegateHandle);
+		Sessions->ClearOnCreateSessionCompleteDelegate_Handle(CreateSessionDelegateHandle);
+		Sessions->ClearOnStartSessionCompleteDelegate_Handle(StartSessionDelegateHandle);
+		Sessions->ClearOnUpdateSessionCompleteDelegate_Handle(UpdateSessionDelegateHandle);
+		Sessions->ClearOnEndSessionCompleteDelegate_Handle(EndSessionDelegateHandle);
+		Sessions->ClearOnJoinSessionCompleteDelegate_Handle(JoinSessionDelegateHandle);
+	}
+	FindSessionsDelegateHandle.Reset();
+	CreateSessionDelegateHandle.Reset();
+	StartSessionDelegateHandle.Reset();
+	UpdateSessionDelegateHandle.Reset();
+	EndSessionDelegateHandle.Reset();
+	JoinSessionDelegateHandle.Reset();
+	HostedSessions.Empty();
+	FTSTicker::GetCoreTicker().RemoveTicker(HostedSessionWatchdogHandle);
+	HostedSessionWatchdogHandle.Reset();
+	FTSTicker::GetCoreTicker().RemoveTicker(BackfillWatchHandle);
+	BackfillWatchHandle.Reset();
+	FTSTicker::GetCoreTicker().RemoveTicker(DrainWatchHandle);
+	DrainWatchHandle.Reset();
+
+	FTSTicker::GetCoreTicker().RemoveTicker(SearchStreamingTickerHandle);
+	SearchStreamingTickerHandle.Reset();
+
+	ActiveSearches.Empty();
+	QueuedSearches.Empty();
+	SearchCache.Reset();
+	SearchSnapshots.Empty();
+	PendingPageRequests.Empty();
+
+	FCoreUObjectDelegates::PostLoadMapWithWorld.Remove(PostLoadMapDelegateHandle);
+	PostLoadMapDelegateHandle.Reset();
+	PendingMapPreloads.Empty();
+	CancelledMapPreloads.Empty();
+	PreloadedMapPackages.Empty();
+	MapRegistry.Reset();
+
+	for (UEnhancedSessionBrowserSubscription* Subscription : TArray<UEnhancedSessionBrowserSubscription*>(BrowserSubscriptions))
+	{
+		UnsubscribeFromSessionBrowser(Subscription);
+	}
+
+	for (const TSharedPtr<FEnhancedSessionQosProber>& Prober : ActiveQosProbers)
+	{
+		Prober->Cancel();
+	}
+	ActiveQosProbers.Empty();
+	StopQosResponder();
+
+	if (ReservationClient.IsValid())
+	{
+		ReservationClient->Cancel();
+		ReservationClient.Reset();
+	}
+	PendingJoinRequest = nullptr;
+	PendingQuickJoinRequest = nullptr;
+	RequestScheduler.Reset();
+	ScheduledRequests.Empty();
+	LoginDelegateHandles.Empty();
+	LogoutDelegateHandles.Empty();
+	StopReservationHost();
+	FreeSearchResults.Empty();
+	FreeRequests.Empty();
+
 	Super::Deinitialize();
 }
 
@@ -0,0 +1,210 @@
+// Copyright © 2024 MajorT. All rights reserved.
+
+#include "EnhancedOnlineSettingsPublisher.h"
+
+const FName FEnhancedSessionSettingsPublisher::JoinInProgressKey(TEXT("bAllowJoinInProgress"));
+const FName FEnhancedSessionSettingsPublisher::ShouldAdvertiseKey(TEXT("bShouldAdvertise"));
+
+namespace
+{
+	bool AreSettingsEqual(const FOnlineSessionSetting& A, const FOnlineSessionSetting& B)
+	{
+		return A.AdvertisementType == B.AdvertisementType && A.Data == B.Data;
+	}
+}
+
+FEnhancedSessionSettingsPublisher::FEnhancedSessionSettingsPublisher(const TSharedRef<FEnhancedOnlineSessionSettings>& InSessionSettings, const FEnhancedSettingsPublishRules& InRules)
+	: SessionSettings(InSessionSettings)
+	, Rules(InRules)
+{
+	LastPublishTime = FPlatformTime::Seconds();
+}
+
+void FEnhancedSessionSettingsPublisher::SetSetting(const FName Key, const FOnlineSessionSetting& Setting, const EEnhancedSettingPublishPriority Priority)
+{
+	const FOnlineSessionSetting* ExistingSetting = SessionSettings->Settings.Find(Key);
+	if (ExistingSetting && AreSettingsEqual(*ExistingSetting, Setting))
+	{
+		Stats.NumUpdatesSuppressed++;
+		return;
+	}
+
+	SessionSettings->Settings.Add(Key, Setting);
+	MarkDirty(Key, Priority);
+}
+
+void FEnhancedSessionSettingsPublisher::SetAllowJoinInProgress(const bool bAllowJoinInProgress, const EEnhancedSettingPublishPriority Priority)
+{
+	if (SessionSettings->bAllowJoinInProgress == bAllowJoinInProgress)
+	{
+		Stats.NumUpdatesSuppressed++;
+		return;
+	}
+
+	SessionSettings->bAllowJoinInProgress = bAllowJoinInProgress;
+	MarkDirty(JoinInProgressKey, Priority);
+}
+
+void FEnhancedSessionSettingsPublisher::SetShouldAdvertise(const bool bShouldAdvertise, const EEnhancedSettingPublishPriority Priority)
+{
+	if (SessionSettings->bShouldAdvertise == bShouldAdvertise)
+	{
+		Stats.NumUpdatesSuppressed++;
+		return;
+	}
+
+	SessionSettings->bShouldAdvertise = bShouldAdvertise;
+	MarkDirty(ShouldAdvertiseKey, Priority);
+}
+
+void FEnhancedSessionSettingsPublisher::MarkDirty(const FName Key, const EEnhancedSettingPublishPriority Priority)
+{
+	const bool bWasDirty = IsDirty();
+	const double OldPublishTime = GetPublishTime();
+
+	if (!bWasDirty)
+	{
+		FirstDirtyTime = FPlatformTime::Seconds();
+	}
+
+	EEnhancedSettingPublishPriority& DirtyPriority = DirtyKeys.FindOrAdd(Key, Priority);
+	DirtyPriority = FMath::Max(DirtyPriority, Priority);
+
+	/* The change rides along with an update that is due anyway */
+	if (bWasDirty)
+	{
+		Stats.NumUpdatesSuppressed++;
+	}
+
+	if (!bWasDirty || GetPublishTime() < OldPublishTime)
+	{
+		OnPublishTimeChanged.ExecuteIfBound();
+	}
+}
+
+double FEnhancedSessionSettingsPublisher::GetPublishTime() const
+{
+	if (!IsDirty())
+	{
+		return 0.0;
+	}
+
+	EEnhancedSettingPublishPriority Priority = EEnhancedSettingPublishPriority::Low;
+	for (const TPair<FName, EEnhancedSettingPublishPriority>& Pair : DirtyKeys)
+	{
+		Priority = FMath::Max(Priority, Pair.Value);
+	}
+
+	/* A failing online service is given time to recover, whatever the priority of the changes */
+	const double BatchTime = FMath::Max(FirstDirtyTime + Rules.BatchWindow, RetryTime);
+	switch (Priority)
+	{
+	case EEnhancedSettingPublishPriority::Low:
+		return FMath::Max(BatchTime, LastPublishTime + Rules.LowPriorityInterval);
+	case EEnhancedSettingPublishPriority::Normal:
+		return FMath::Max(BatchTime, LastPublishTime + Rules.MinInterval);
+	default:
+		return BatchTime;
+	}
+}
+
+int32 FEnhancedSessionSettingsPublisher::BeginPublish(const FOnlineSessionSettings& CurrentSettings, FOnlineSessionSettings& OutUpdate)
+{
+	check(!bIsPublishing);
+
+	OutUpdate = CurrentSettings;
+	int32 NumChanges = 0;
+
+	for (const TPair<FName, EEnhancedSettingPublishPriority>& Pair : DirtyKeys)
+	{
+		if (Pair.Key == JoinInProgressKey)
+		{
+			if (CurrentSettings.bAllowJoinInProgress != SessionSettings->bAllowJoinInProgress)
+			{
+				OutUpdate.bAllowJoinInProgress = SessionSettings->bAllowJoinInProgress;
+				NumChanges++;
+			}
+			continue;
+		}
+
+		if (Pair.Key == ShouldAdvertiseKey)
+		{
+			if (CurrentSettings.bShouldAdvertise != SessionSettings->bShouldAdvertise)
+			{
+				OutUpdate.bShouldAdvertise = SessionSettings->bShouldAdvertise;
+				NumChanges++;
+			}
+			continue;
+		}
+
+		const FOnlineSessionSetting* DesiredSetting = SessionSettings->Settings.Find(Pair.Key);
+		const FOnlineSessionSetting* CurrentSetting = CurrentSettings.Settings.Find(Pair.Key);
+
+		if (DesiredSetting == nullptr)
+		{
+			if (CurrentSetting)
+			{
+				OutUpdate.Settings.Remove(Pair.Key);
+				NumChanges++;
+			}
+		}
+		else if (CurrentSetting == nullptr || !AreSettingsEqual(*CurrentSetting, *DesiredSetting))
+		{
+			OutUpdate.Settings.Add(Pair.Key, *DesiredSetting);
+			NumChanges++;
+		}
+	}
+
+	PublishingKeys = MoveTemp(DirtyKeys);
+	DirtyKeys.Reset();
+
+	/* Every change was reverted before it was published, the online service is already up to date */
+	if (NumChanges == 0)
+	{
+		if (!PublishingKeys.IsEmpty())
+		{
+			Stats.NumUpdatesSuppressed++;
+		}
+		PublishingKeys.Reset();
+		return 0;
+	}
+
+	bIsPublishing = true;
+	LastPublishTime = FPlatformTime::Seconds();
+	Stats.NumSettingsSent += NumChanges;
+
+	return NumChanges;
+}
+
+void FEnhancedSessionSettingsPublisher::EndPublish(const bool bWasSuccessful)
+{
+	if (!bIsPublishing)
+	{
+		return;
+	}
+
+	bIsPublishing = false;
+
+	if (bWasSuccessful)
+	{
+		Stats.NumUpdatesSent++;
+		NumConsecutiveFailures = 0;
+		RetryTime = 0.0;
+		PublishingKeys.Reset();
+		return;
+	}
+
+	Stats.NumUpdatesFailed++;
+
+	/* Back off further with every failure in a row before the changes are sent again */
+	NumConsecutiveFailures++;
+	FirstDirtyTime = FPlatformTime::Seconds();
+	RetryTime = FirstDirtyTime + Rules.RetryPolicy.GetRetryDelay(NumConsecutiveFailures);
+
+	for (const TPair<FName, EEnhancedSettingPublishPriority>& Pair : PublishingKeys)
+	{
+		EEnhancedSettingPublishPriority& DirtyPriority = DirtyKeys.FindOrAdd(Pair.Key, Pair.Value);
+		DirtyPriority = FMath::Max(DirtyPriority, Pair.Value);
+	}
+	PublishingKeys.Reset();
+}
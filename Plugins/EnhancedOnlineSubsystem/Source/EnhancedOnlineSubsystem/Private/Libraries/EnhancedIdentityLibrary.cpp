@@ -3,6 +3,7 @@
 #include "Libraries/EnhancedIdentityLibrary.h"
 
 #include "EnhancedOnlineRequests.h"
+#include "EnhancedOnlineSessionsSubsystem.h"
 #include "Libraries/EnhancedSessionsLibrary.h"
 #include "GameFramework/GameModeBase.h"
 #include "GameFramework/GameSession.h"
@@ -38,7 +39,7 @@ UEnhancedOnlineRequest_LoginUser* UEnhancedIdentityLibrary::ConstructOnlineLogin
                                                                                             const int32 LocalUserIndex, const bool bInvalidateOnCompletion, FBPOnLoginRequestSuceeded OnSucceededDelegate,
                                                                                             FBPOnRequestFailedWithLog OnFailedDelegate)
 {
-	UEnhancedOnlineRequest_LoginUser* Request = NewObject<UEnhancedOnlineRequest_LoginUser>(WorldContextObject);
+	UEnhancedOnlineRequest_LoginUser* Request = UEnhancedOnlineSessionsSubsystem::AcquireRequest<UEnhancedOnlineRequest_LoginUser>(WorldContextObject);
 	Request->ConstructRequest();
 
 	Request->AuthType = AuthType;
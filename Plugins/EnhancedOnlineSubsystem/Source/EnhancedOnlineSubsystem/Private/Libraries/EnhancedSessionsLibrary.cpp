@@ -4,6 +4,7 @@
 #include "Libraries/EnhancedSessionsLibrary.h"
 
 #include "EnhancedOnlineRequests.h"
+#include "EnhancedOnlineSessionsSubsystem.h"
 
 
 void UEnhancedSessionsLibrary::SetupFailureDelegate(UEnhancedOnlineRequestBase* Request, FBPOnRequestFailedWithLog OnFailedDelegate)
@@ -40,13 +41,28 @@ FString UEnhancedSessionsLibrary::GetSessionFriendlyName(UEnhancedSessionSearchR
 	return SearchResult->GetSessionFriendlyName();
 }
 
+FString UEnhancedSessionsLibrary::GetSessionGameMode(UEnhancedSessionSearchResult* SearchResult)
+{
+	return SearchResult->GetGameMode();
+}
+
+FString UEnhancedSessionsLibrary::GetSessionMapName(UEnhancedSessionSearchResult* SearchResult)
+{
+	return SearchResult->GetMapName();
+}
+
+FString UEnhancedSessionsLibrary::GetSessionSearchKeyword(UEnhancedSessionSearchResult* SearchResult)
+{
+	return SearchResult->GetSearchKeyword();
+}
+
 UEnhancedOnlineRequest_CreateSession* UEnhancedSessionsLibrary::ConstructOnlineHostSessionRequest(
 	UObject* WorldContextObject, const EEnhancedSessionOnlineMode OnlineMode, const int32 MaxPlayerCount,
 	FPrimaryAssetId MapId, TArray<FString> TravelURLOperators, const FString FriendlyName, const FString SearchKeyword, const bool bUseLobbiesIfAvailable,
 	const bool bUseVoiceChatIfAvailable, const FString GameModeAdvertisementName, const bool bIsPresence, const bool bAllowJoinInProgress,
 	const int32 LocalUserIndex, const bool bInvalidateOnCompletion, FBPOnRequestFailedWithLog OnFailedDelegate)
 {
-	UEnhancedOnlineRequest_CreateSession* Request = NewObject<UEnhancedOnlineRequest_CreateSession>(WorldContextObject);
+	UEnhancedOnlineRequest_CreateSession* Request = UEnhancedOnlineSessionsSubsystem::AcquireRequest<UEnhancedOnlineRequest_CreateSession>(WorldContextObject);
 	Request->ConstructRequest();
 
 	Request->LocalUserIndex = LocalUserIndex;
@@ -75,7 +91,7 @@ UEnhancedOnlineRequest_CreateLobby* UEnhancedSessionsLibrary::ConstructOnlineHos
 	bool bInvalidateOnCompletion, FBPOnHostLobbyRequestSucceeded OnSucceededDelegate,
 	FBPOnRequestFailedWithLog OnFailedDelegate)
 {
-	UEnhancedOnlineRequest_CreateLobby* Request = NewObject<UEnhancedOnlineRequest_CreateLobby>(WorldContextObject);
+	UEnhancedOnlineRequest_CreateLobby* Request = UEnhancedOnlineSessionsSubsystem::AcquireRequest<UEnhancedOnlineRequest_CreateLobby>(WorldContextObject);
 	Request->ConstructRequest();
 
 	Request->LocalUserIndex = LocalUserIndex;
@@ -112,7 +128,7 @@ UEnhancedOnlineRequest_FindSessions* UEnhancedSessionsLibrary::ConstructOnlineFi
 	const bool bInvalidateOnCompletion, FBPOnFindSessionsSuceeeded OnSucceededDelegate,
 	FBPOnRequestFailedWithLog OnFailedDelegate)
 {
-	UEnhancedOnlineRequest_FindSessions* Request = NewObject<UEnhancedOnlineRequest_FindSessions>(WorldContextObject);
+	UEnhancedOnlineRequest_FindSessions* Request = UEnhancedOnlineSessionsSubsystem::AcquireRequest<UEnhancedOnlineRequest_FindSessions>(WorldContextObject);
 	Request->ConstructRequest();
 
 	Request->LocalUserIndex = LocalUserIndex;
@@ -138,18 +154,147 @@ UEnhancedOnlineRequest_FindSessions* UEnhancedSessionsLibrary::ConstructOnlineFi
 	return Request;
 }
 
+UEnhancedOnlineRequest_FindSessions* UEnhancedSessionsLibrary::ConstructOnlineStreamingFindSessionsRequest(
+	UObject* WorldContextObject, const EEnhancedSessionOnlineMode OnlineMode, const int32 MaxSearchResults,
+	const bool bFindLobbies, const FString SearchKeyword, const int32 LocalUserIndex,
+	const bool bInvalidateOnCompletion, FBPOnFindSessionsBatchReceived OnBatchReceivedDelegate,
+	FBPOnFindSessionsSuceeeded OnSucceededDelegate, FBPOnRequestFailedWithLog OnFailedDelegate)
+{
+	UEnhancedOnlineRequest_FindSessions* Request = ConstructOnlineFindSessionsRequest(WorldContextObject, OnlineMode, MaxSearchResults,
+		bFindLobbies, SearchKeyword, LocalUserIndex, bInvalidateOnCompletion, OnSucceededDelegate, OnFailedDelegate);
+
+	Request->bStreamResults = true;
+
+	Request->OnSearchResultsBatchReceived.AddLambda(
+		[OnBatchReceivedDelegate] (const TArray<UEnhancedSessionSearchResult*>& SearchResults)
+		{
+			if (OnBatchReceivedDelegate.IsBound())
+			{
+				OnBatchReceivedDelegate.Execute(SearchResults);
+			}
+		});
+
+	return Request;
+}
+
+UEnhancedOnlineRequest_FindSessionsPage* UEnhancedSessionsLibrary::ConstructOnlineFindSessionsPageRequest(
+	UObject* WorldContextObject, const EEnhancedSessionOnlineMode OnlineMode, const int32 PageSize,
+	const FEnhancedSessionSearchCursor& Cursor, const bool bFindLobbies, const FString SearchKeyword,
+	const int32 LocalUserIndex, const bool bInvalidateOnCompletion, FBPOnFindSessionsPageSucceeded OnSucceededDelegate,
+	FBPOnRequestFailedWithLog OnFailedDelegate)
+{
+	UEnhancedOnlineRequest_FindSessionsPage* Request = UEnhancedOnlineSessionsSubsystem::AcquireRequest<UEnhancedOnlineRequest_FindSessionsPage>(WorldContextObject);
+	Request->ConstructRequest();
+
+	Request->LocalUserIndex = LocalUserIndex;
+	Request->bInvalidateOnCompletion = bInvalidateOnCompletion;
+	Request->OnlineMode = OnlineMode;
+	Request->PageSize = PageSize;
+	Request->Cursor = Cursor;
+	Request->bFindLobbies = bFindLobbies;
+	Request->SearchKeyword = SearchKeyword;
+
+	SetupFailureDelegate(Request, OnFailedDelegate);
+
+	Request->OnFindOnlineSessionsCompleted.AddLambda(
+		[OnSucceededDelegate, Request] (const TArray<UEnhancedSessionSearchResult*>& SearchResults)
+		{
+			if (OnSucceededDelegate.IsBound())
+			{
+				OnSucceededDelegate.Execute(SearchResults, Request->NextCursor, Request->bHasMorePages);
+			}
+
+			Request->CompleteRequest();
+		});
+
+	return Request;
+}
+
+UEnhancedSessionBrowserSubscription* UEnhancedSessionsLibrary::ConstructSessionBrowserSubscription(
+	UObject* WorldContextObject, const EEnhancedSessionOnlineMode OnlineMode, const int32 MaxSearchResults,
+	const bool bFindLobbies, const FString SearchKeyword, const float MinRefreshInterval,
+	const float MaxRefreshInterval, FBPOnSessionBrowserUpdated OnUpdatedDelegate)
+{
+	UEnhancedSessionBrowserSubscription* Subscription = NewObject<UEnhancedSessionBrowserSubscription>(WorldContextObject);
+
+	Subscription->OnlineMode = OnlineMode;
+	Subscription->MaxSearchResults = MaxSearchResults;
+	Subscription->bFindLobbies = bFindLobbies;
+	Subscription->SearchKeyword = SearchKeyword;
+	Subscription->MinRefreshInterval = MinRefreshInterval;
+	Subscription->MaxRefreshInterval = MaxRefreshInterval;
+
+	Subscription->OnBrowserUpdated.AddLambda(
+		[OnUpdatedDelegate] (const FEnhancedSessionBrowserDelta& Delta)
+		{
+			if (OnUpdatedDelegate.IsBound())
+			{
+				OnUpdatedDelegate.Execute(Delta);
+			}
+		});
+
+	return Subscription;
+}
+
 UEnhancedOnlineRequest_JoinSession* UEnhancedSessionsLibrary::ConstructOnlineJoinSessionRequest(
-	UObject* WorldContextObject, UEnhancedSessionSearchResult* SessionToJoin, const int32 LocalUserIndex,
-	const bool bInvalidateOnCompletion, FBPOnRequestFailedWithLog OnFailedDelegate)
+	UObject* WorldContextObject, UEnhancedSessionSearchResult* SessionToJoin,
+	const TArray<UEnhancedSessionSearchResult*>& FallbackSessions, const int32 LocalUserIndex,
+	const bool bInvalidateOnCompletion, FBPOnJoinSessionRequestSucceeded OnSucceededDelegate,
+	FBPOnRequestFailedWithLog OnFailedDelegate)
 {
-	UEnhancedOnlineRequest_JoinSession* Request = NewObject<UEnhancedOnlineRequest_JoinSession>(WorldContextObject);
+	UEnhancedOnlineRequest_JoinSession* Request = UEnhancedOnlineSessionsSubsystem::AcquireRequest<UEnhancedOnlineRequest_JoinSession>(WorldContextObject);
 	Request->ConstructRequest();
 
 	Request->LocalUserIndex = LocalUserIndex;
 	Request->bInvalidateOnCompletion = bInvalidateOnCompletion;
 	Request->SessionToJoin = SessionToJoin;
+	Request->FallbackSessions = FallbackSessions;
+
+	SetupFailureDelegate(Request, OnFailedDelegate);
+
+	Request->OnJoinSessionCompleted.AddLambda(
+		[OnSucceededDelegate] (FName SessionName)
+		{
+			if (OnSucceededDelegate.IsBound())
+			{
+				OnSucceededDelegate.Execute(SessionName);
+			}
+		});
+
+	return Request;
+}
+
+UEnhancedOnlineRequest_QuickJoin* UEnhancedSessionsLibrary::ConstructOnlineQuickJoinRequest(
+	UObject* WorldContextObject, const EEnhancedSessionOnlineMode OnlineMode, const int32 MaxSearchResults,
+	const bool bFindLobbies, const FString SearchKeyword, const FEnhancedQuickJoinScoring& Scoring,
+	const float GoodEnoughScore, const float MaxSearchWait, const int32 LocalUserIndex,
+	const bool bInvalidateOnCompletion, FBPOnQuickJoinRequestSucceeded OnSucceededDelegate,
+	FBPOnRequestFailedWithLog OnFailedDelegate)
+{
+	UEnhancedOnlineRequest_QuickJoin* Request = UEnhancedOnlineSessionsSubsystem::AcquireRequest<UEnhancedOnlineRequest_QuickJoin>(WorldContextObject);
+	Request->ConstructRequest();
+
+	Request->LocalUserIndex = LocalUserIndex;
+	Request->bInvalidateOnCompletion = bInvalidateOnCompletion;
+	Request->OnlineMode = OnlineMode;
+	Request->MaxSearchResults = MaxSearchResults;
+	Request->bFindLobbies = bFindLobbies;
+	Request->SearchKeyword = SearchKeyword;
+	Request->Scoring = Scoring;
+	Request->GoodEnoughScore = GoodEnoughScore;
+	Request->MaxSearchWait = MaxSearchWait;
 
 	SetupFailureDelegate(Request, OnFailedDelegate);
+
+	Request->OnQuickJoinCompleted.AddLambda(
+		[OnSucceededDelegate] (FName SessionName, UEnhancedSessionSearchResult* JoinedSession)
+		{
+			if (OnSucceededDelegate.IsBound())
+			{
+				OnSucceededDelegate.Execute(SessionName, JoinedSession);
+			}
+		});
+
 	return Request;
 }
 
@@ -157,7 +302,7 @@ UEnhancedOnlineRequest_StartSession* UEnhancedSessionsLibrary::ConstructOnlineSt
 	UObject* WorldContextObject, const bool bInvalidateOnCompletion,
 	FBPOnStartSessionRequestSucceeded OnSucceededDelegate, FBPOnRequestFailedWithLog OnFailedDelegate)
 {
-	UEnhancedOnlineRequest_StartSession* Request = NewObject<UEnhancedOnlineRequest_StartSession>(WorldContextObject);
+	UEnhancedOnlineRequest_StartSession* Request = UEnhancedOnlineSessionsSubsystem::AcquireRequest<UEnhancedOnlineRequest_StartSession>(WorldContextObject);
 	Request->ConstructRequest();
 
 	Request->bInvalidateOnCompletion = bInvalidateOnCompletion;
@@ -177,3 +322,32 @@ UEnhancedOnlineRequest_StartSession* UEnhancedSessionsLibrary::ConstructOnlineSt
 	
 	return Request;
 }
+
+UEnhancedOnlineRequest_RecycleSession* UEnhancedSessionsLibrary::ConstructOnlineRecycleSessionRequest(
+	UObject* WorldContextObject, const FName SessionName, FPrimaryAssetId MapId, const FString GameModeAdvertisementName,
+	const FString FriendlyName, const bool bTravelToMap, const bool bInvalidateOnCompletion,
+	FBPOnRecycleSessionRequestSucceeded OnSucceededDelegate, FBPOnRequestFailedWithLog OnFailedDelegate)
+{
+	UEnhancedOnlineRequest_RecycleSession* Request = UEnhancedOnlineSessionsSubsystem::AcquireRequest<UEnhancedOnlineRequest_RecycleSession>(WorldContextObject);
+	Request->ConstructRequest();
+
+	Request->bInvalidateOnCompletion = bInvalidateOnCompletion;
+	Request->SessionName = SessionName;
+	Request->MapId = MapId;
+	Request->GameModeAdvertisementName = GameModeAdvertisementName;
+	Request->FriendlyName = FriendlyName;
+	Request->bTravelToMap = bTravelToMap;
+
+	SetupFailureDelegate(Request, OnFailedDelegate);
+
+	Request->OnRecycleSessionCompleted.AddLambda(
+		[OnSucceededDelegate] (const FName SessionName)
+		{
+			if (OnSucceededDelegate.IsBound())
+			{
+				OnSucceededDelegate.Execute(SessionName);
+			}
+		});
+
+	return Request;
+}
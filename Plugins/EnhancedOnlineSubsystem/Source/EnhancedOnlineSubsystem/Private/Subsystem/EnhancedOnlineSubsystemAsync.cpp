@@ -0,0 +1,182 @@
+// Copyright © 2024 MajorT. All rights reserved.
+
+#include "EnhancedOnlineSessionsSubsystem.h"
+
+#include "EnhancedOnlineAsync.h"
+#include "EnhancedOnlineMapRegistry.h"
+#include "EnhancedOnlineRequests.h"
+
+namespace
+{
+	/** Promise shared by the delegates of a request, whichever fires first sets it */
+	struct FRequestPromise
+	{
+		~FRequestPromise()
+		{
+			/* The delegates were cleared without firing, e.g. the subsystem shut down */
+			SetResult(FEnhancedOnlineResult::Failure(TEXT("The request was dropped before it completed.")));
+		}
+
+		void SetResult(FEnhancedOnlineResult&& Result)
+		{
+			if (!bIsSet)
+			{
+				bIsSet = true;
+				Promise.SetValue(MoveTemp(Result));
+			}
+		}
+
+		TPromise<FEnhancedOnlineResult> Promise;
+		bool bIsSet = false;
+	};
+
+	/** Creates the promise of a request and sets it when the request fails */
+	TSharedRef<FRequestPromise> MakeRequestPromise(UEnhancedOnlineRequestBase* Request)
+	{
+		TSharedRef<FRequestPromise> RequestPromise = MakeShared<FRequestPromise>();
+
+		Request->OnRequestFailedDelegate.AddLambda([RequestPromise] (const FString& Reason)
+		{
+			RequestPromise->SetResult(FEnhancedOnlineResult::Failure(Reason));
+		});
+
+		return RequestPromise;
+	}
+}
+
+TFuture<FEnhancedOnlineResult> UEnhancedOnlineSessionsSubsystem::LoginOnlineUserAsync(UEnhancedOnlineRequest_LoginUser* Request)
+{
+	if (Request == nullptr)
+	{
+		return FEnhancedOnlineAsync::MakeReady(FEnhancedOnlineResult::Failure(TEXT("Login Online User was called with a bad request.")));
+	}
+
+	TSharedRef<FRequestPromise> RequestPromise = MakeRequestPromise(Request);
+	TFuture<FEnhancedOnlineResult> Future = RequestPromise->Promise.GetFuture();
+
+	Request->OnUserLoginCompleted.AddLambda([RequestPromise] (int32 LocalUserIndex)
+	{
+		FEnhancedOnlineResult Result;
+		Result.bWasSuccessful = true;
+		Result.LocalUserIndex = LocalUserIndex;
+		RequestPromise->SetResult(MoveTemp(Result));
+	});
+
+	LoginOnlineUser(Request);
+	return Future;
+}
+
+TFuture<FEnhancedOnlineResult> UEnhancedOnlineSessionsSubsystem::HostOnlineSessionAsync(UEnhancedOnlineRequest_Session* Request)
+{
+	if (Request == nullptr)
+	{
+		return FEnhancedOnlineAsync::MakeReady(FEnhancedOnlineResult::Failure(TEXT("Host Online Session was called with a bad request.")));
+	}
+
+	TSharedRef<FRequestPromise> RequestPromise = MakeRequestPromise(Request);
+	TFuture<FEnhancedOnlineResult> Future = RequestPromise->Promise.GetFuture();
+
+	Request->OnCreateSessionCompleted.AddLambda([RequestPromise] (int32 LocalUserIndex, const FName SessionName)
+	{
+		FEnhancedOnlineResult Result;
+		Result.bWasSuccessful = true;
+		Result.LocalUserIndex = LocalUserIndex;
+		Result.SessionName = SessionName;
+		RequestPromise->SetResult(MoveTemp(Result));
+	});
+
+	HostOnlineSession(Request);
+	return Future;
+}
+
+TFuture<FEnhancedOnlineResult> UEnhancedOnlineSessionsSubsystem::FindOnlineSessionsAsync(UEnhancedOnlineRequest_FindSessions* Request)
+{
+	if (Request == nullptr)
+	{
+		return FEnhancedOnlineAsync::MakeReady(FEnhancedOnlineResult::Failure(TEXT("Find Online Sessions was called with a bad request.")));
+	}
+
+	TSharedRef<FRequestPromise> RequestPromise = MakeRequestPromise(Request);
+	TFuture<FEnhancedOnlineResult> Future = RequestPromise->Promise.GetFuture();
+
+	Request->OnFindOnlineSessionsCompleted.AddLambda([RequestPromise] (const TArray<UEnhancedSessionSearchResult*>& SearchResults)
+	{
+		FEnhancedOnlineResult Result;
+		Result.bWasSuccessful = true;
+		Result.SearchResults = SearchResults;
+		RequestPromise->SetResult(MoveTemp(Result));
+	});
+
+	FindOnlineSessions(Request);
+	return Future;
+}
+
+TFuture<FEnhancedOnlineResult> UEnhancedOnlineSessionsSubsystem::JoinOnlineSessionAsync(UEnhancedOnlineRequest_JoinSession* Request)
+{
+	if (Request == nullptr)
+	{
+		return FEnhancedOnlineAsync::MakeReady(FEnhancedOnlineResult::Failure(TEXT("Join Online Session was called with a bad request.")));
+	}
+
+	TSharedRef<FRequestPromise> RequestPromise = MakeRequestPromise(Request);
+	TFuture<FEnhancedOnlineResult> Future = RequestPromise->Promise.GetFuture();
+
+	Request->OnJoinSessionCompleted.AddLambda([RequestPromise] (const FName SessionName)
+	{
+		FEnhancedOnlineResult Result;
+		Result.bWasSuccessful = true;
+		Result.SessionName = SessionName;
+		RequestPromise->SetResult(MoveTemp(Result));
+	});
+
+	JoinOnlineSession(Request);
+	return Future;
+}
+
+TFuture<FEnhancedOnlineResult> UEnhancedOnlineSessionsSubsystem::StartOnlineSessionAsync(UEnhancedOnlineRequest_StartSession* Request)
+{
+	if (Request == nullptr)
+	{
+		return FEnhancedOnlineAsync::MakeReady(FEnhancedOnlineResult::Failure(TEXT("Start Online Session was called with a bad request.")));
+	}
+
+	TSharedRef<FRequestPromise> RequestPromise = MakeRequestPromise(Request);
+	TFuture<FEnhancedOnlineResult> Future = RequestPromise->Promise.GetFuture();
+
+	Request->OnStartSessionCompleted.AddLambda([RequestPromise] (FName SessionName, bool bWasSuccessful)
+	{
+		FEnhancedOnlineResult Result;
+		Result.bWasSuccessful = bWasSuccessful;
+		Result.SessionName = SessionName;
+		RequestPromise->SetResult(MoveTemp(Result));
+	});
+
+	StartOnlineSession(Request);
+	return Future;
+}
+
+TFuture<FEnhancedOnlineResult> UEnhancedOnlineSessionsSubsystem::PreloadMapAsync(const FPrimaryAssetId& MapId)
+{
+	FEnhancedMapRegistryEntry MapEntry;
+	if (!FEnhancedMapRegistry::ResolveMap(this, MapId, MapEntry))
+	{
+		return FEnhancedOnlineAsync::MakeReady(FEnhancedOnlineResult::Failure(FString::Printf(TEXT("Can't find the map %s."), *MapId.ToString())));
+	}
+
+	TSharedRef<FRequestPromise> RequestPromise = MakeShared<FRequestPromise>();
+	TFuture<FEnhancedOnlineResult> Future = RequestPromise->Promise.GetFuture();
+
+	PreloadMapPackage(MapEntry.PackageName, FOnEnhancedMapPreloaded::CreateLambda([RequestPromise] (const FName PackageName, bool bWasSuccessful)
+	{
+		FEnhancedOnlineResult Result;
+		Result.bWasSuccessful = bWasSuccessful;
+		Result.PackageName = PackageName;
+		if (!bWasSuccessful)
+		{
+			Result.Error = FString::Printf(TEXT("Failed to load the map package %s."), *PackageName.ToString());
+		}
+		RequestPromise->SetResult(MoveTemp(Result));
+	}));
+
+	return Future;
+}
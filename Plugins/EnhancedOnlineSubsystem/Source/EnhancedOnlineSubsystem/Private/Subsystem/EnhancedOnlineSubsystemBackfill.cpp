@@ -0,0 +1,144 @@
+// Copyright © 2024 MajorT. All rights reserved.
+
+#include "EnhancedOnlineSessionsSubsystem.h"
+
+#include "EnhancedOnlineRequests.h"
+#include "EnhancedOnlineReservation.h"
+#include "EnhancedOnlineSettingsPublisher.h"
+#include "EnhancedOnlineSubsystem.h"
+#include "OnlineSessionSettings.h"
+#include "OnlineSubsystemUtils.h"
+
+bool UEnhancedOnlineSessionsSubsystem::SetHostedSessionBackfill(FName SessionName, bool bEnabled)
+{
+	FEnhancedHostedSession* HostedSession = HostedSessions.Find(SessionName);
+	if (HostedSession == nullptr)
+	{
+		UE_LOG(LogEnhancedSubsystem, Error, TEXT("Set Hosted Session Backfill was called with an unknown session: %s."), *SessionName.ToString());
+		return false;
+	}
+
+	/* Backfill would advertise the session again while it is being unadvertised and destroyed */
+	if (HostedSession->DrainPhase != EEnhancedSessionDrainPhase::None)
+	{
+		UE_LOG(LogEnhancedSubsystem, Warning, TEXT("Session %s is being drained, its backfill can't be changed."), *SessionName.ToString());
+		return false;
+	}
+
+	HostedSession->bBackfillEnabled = bEnabled;
+
+	/* The next check opens the session, or closes a running backfill */
+	StartBackfillWatch();
+	return true;
+}
+
+bool UEnhancedOnlineSessionsSubsystem::IsHostedSessionBackfilling(FName SessionName) const
+{
+	const FEnhancedHostedSession* HostedSession = HostedSessions.Find(SessionName);
+	return HostedSession && HostedSession->bIsBackfilling;
+}
+
+void UEnhancedOnlineSessionsSubsystem::StartBackfillWatch()
+{
+	if (BackfillWatchHandle.IsValid())
+	{
+		return;
+	}
+
+	BackfillWatchHandle = FTSTicker::GetCoreTicker().AddTicker(
+		FTickerDelegate::CreateUObject(this, &ThisClass::TickBackfillWatch), FMath::Max(BackfillCheckInterval, 0.f));
+}
+
+bool UEnhancedOnlineSessionsSubsystem::TickBackfillWatch(float DeltaTime)
+{
+	const double Now = FPlatformTime::Seconds();
+
+	TArray<FName> SessionNames;
+	HostedSessions.GetKeys(SessionNames);
+
+	bool bIsAnyWatched = false;
+	for (const FName& SessionName : SessionNames)
+	{
+		bIsAnyWatched |= UpdateHostedSessionBackfill(SessionName, Now);
+	}
+
+	if (!bIsAnyWatched)
+	{
+		BackfillWatchHandle.Reset();
+		return false;
+	}
+
+	return true;
+}
+
+bool UEnhancedOnlineSessionsSubsystem::UpdateHostedSessionBackfill(const FName SessionName, const double Now)
+{
+	FEnhancedHostedSession* HostedSession = HostedSessions.Find(SessionName);
+	IOnlineSessionPtr Sessions = Online::GetSessionInterface(GetWorld());
+	if (HostedSession == nullptr || !HostedSession->Publisher.IsValid() || Sessions == nullptr)
+	{
+		return false;
+	}
+
+	const bool bIsWatched = HostedSession->bBackfillEnabled && HostedSession->State == EEnhancedHostedSessionState::InProgress;
+	if (!bIsWatched && !HostedSession->bIsBackfilling)
+	{
+		return false;
+	}
+
+	int32 OpenSlots = 0;
+	if (bIsWatched)
+	{
+		if (const FNamedOnlineSession* NamedSession = Sessions->GetNamedSession(SessionName))
+		{
+			OpenSlots = NamedSession->NumOpenPublicConnections;
+
+			/* Reserved seats are already promised to clients on their way */
+			if (ReservationHost.IsValid())
+			{
+				OpenSlots -= ReservationHost->GetNumReservations(FEnhancedSessionReservationHost::MakeSessionKey(UEnhancedSessionSearchResult::GetSessionId(*NamedSession)));
+			}
+
+			OpenSlots = FMath::Max(OpenSlots, 0);
+		}
+	}
+
+	/* The publisher schedules the update through the subsystem, keep it alive independently of the entry */
+	const TSharedRef<FEnhancedSessionSettingsPublisher> Publisher = HostedSession->Publisher.ToSharedRef();
+	const bool bWantsBackfill = OpenSlots > 0;
+
+	if (bWantsBackfill != HostedSession->bIsBackfilling)
+	{
+		/* Seats opening and filling up are throttled, a match that is over stops backfilling right away */
+		if (bIsWatched && Now - HostedSession->LastBackfillChangeTime < BackfillJoinabilityInterval)
+		{
+			return true;
+		}
+
+		if (bWantsBackfill)
+		{
+			HostedSession->bAllowJoinInProgressBeforeBackfill = HostedSession->SessionSettings->bAllowJoinInProgress;
+			UE_LOG(LogEnhancedSubsystem, Log, TEXT("Backfilling %d seats of session %s."), OpenSlots, *SessionName.ToString());
+		}
+		else
+		{
+			UE_LOG(LogEnhancedSubsystem, Log, TEXT("Session %s stopped backfilling."), *SessionName.ToString());
+		}
+
+		HostedSession->bIsBackfilling = bWantsBackfill;
+		HostedSession->BackfillSlots = OpenSlots;
+		HostedSession->LastBackfillChangeTime = Now;
+
+		const bool bAllowJoinInProgress = bWantsBackfill || HostedSession->bAllowJoinInProgressBeforeBackfill;
+		Publisher->Set(SETTING_BACKFILL, OpenSlots, EOnlineDataAdvertisementType::ViaOnlineService, EEnhancedSettingPublishPriority::High);
+		Publisher->SetAllowJoinInProgress(bAllowJoinInProgress, EEnhancedSettingPublishPriority::High);
+	}
+	else if (bWantsBackfill && OpenSlots != HostedSession->BackfillSlots)
+	{
+		/* Seat counts changing during the backfill ride along with the next update */
+		HostedSession->BackfillSlots = OpenSlots;
+		Publisher->Set(SETTING_BACKFILL, OpenSlots, EOnlineDataAdvertisementType::ViaOnlineService, EEnhancedSettingPublishPriority::Low);
+	}
+
+	return bIsWatched;
+}
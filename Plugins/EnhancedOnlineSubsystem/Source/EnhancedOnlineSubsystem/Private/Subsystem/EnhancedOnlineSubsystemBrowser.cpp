@@ -0,0 +1,236 @@
+// Copyright © 2024 MajorT. All rights reserved.
+
+#include "EnhancedOnlineSessionsSubsystem.h"
+
+#include "EnhancedOnlineBrowser.h"
+#include "EnhancedOnlineRequests.h"
+#include "EnhancedOnlineSubsystem.h"
+#include "TimerManager.h"
+#include "Engine/GameInstance.h"
+
+namespace
+{
+	EEnhancedSessionChangedFields DiffSessionAttributes(const FEnhancedSessionSearchResultAttributes& Old, const FEnhancedSessionSearchResultAttributes& New, const int32 PingChangeThreshold)
+	{
+		EEnhancedSessionChangedFields ChangedFields = EEnhancedSessionChangedFields::None;
+
+		if (FMath::Abs(New.PingInMs - Old.PingInMs) >= FMath::Max(PingChangeThreshold, 1))
+		{
+			ChangedFields |= EEnhancedSessionChangedFields::Ping;
+		}
+
+		if (New.CurrentPlayers != Old.CurrentPlayers)
+		{
+			ChangedFields |= EEnhancedSessionChangedFields::Players;
+		}
+
+		if (New.MaxPlayers != Old.MaxPlayers)
+		{
+			ChangedFields |= EEnhancedSessionChangedFields::MaxPlayers;
+		}
+
+		if (New.FriendlyName != Old.FriendlyName)
+		{
+			ChangedFields |= EEnhancedSessionChangedFields::FriendlyName;
+		}
+
+		if (New.GameModeHash != Old.GameModeHash || New.GameMode != Old.GameMode)
+		{
+			ChangedFields |= EEnhancedSessionChangedFields::GameMode;
+		}
+
+		if (New.MapNameHash != Old.MapNameHash || New.MapName != Old.MapName)
+		{
+			ChangedFields |= EEnhancedSessionChangedFields::MapName;
+		}
+
+		return ChangedFields;
+	}
+}
+
+void UEnhancedOnlineSessionsSubsystem::SubscribeToSessionBrowser(UEnhancedSessionBrowserSubscription* Subscription)
+{
+	if (Subscription == nullptr)
+	{
+		UE_LOG(LogEnhancedSubsystem, Error, TEXT("Subscribe To Session Browser was called with a bad subscription."));
+		return;
+	}
+
+	if (Subscription->bIsSubscribed)
+	{
+		UE_LOG(LogEnhancedSubsystem, Warning, TEXT("Subscribe To Session Browser was called twice with the same subscription."));
+		return;
+	}
+
+	Subscription->bIsSubscribed = true;
+	Subscription->CurrentRefreshInterval = FMath::Max(Subscription->MinRefreshInterval, 0.f);
+	BrowserSubscriptions.AddUnique(Subscription);
+
+	StartSessionBrowserRefresh(Subscription);
+}
+
+void UEnhancedOnlineSessionsSubsystem::UnsubscribeFromSessionBrowser(UEnhancedSessionBrowserSubscription* Subscription)
+{
+	if (Subscription == nullptr || !Subscription->bIsSubscribed)
+	{
+		return;
+	}
+
+	if (UGameInstance* GameInstance = GetGameInstance())
+	{
+		GameInstance->GetTimerManager().ClearTimer(Subscription->RefreshTimerHandle);
+	}
+
+	Subscription->bIsSubscribed = false;
+	BrowserSubscriptions.Remove(Subscription);
+
+	for (const TPair<FString, TObjectPtr<UEnhancedSessionSearchResult>>& Pair : Subscription->LiveSessions)
+	{
+		ReleaseSearchResult(Pair.Value);
+	}
+	Subscription->LiveSessions.Empty();
+}
+
+void UEnhancedOnlineSessionsSubsystem::RefreshSessionBrowser(UEnhancedSessionBrowserSubscription* Subscription)
+{
+	if (Subscription == nullptr || !Subscription->bIsSubscribed)
+	{
+		return;
+	}
+
+	if (UGameInstance* GameInstance = GetGameInstance())
+	{
+		GameInstance->GetTimerManager().ClearTimer(Subscription->RefreshTimerHandle);
+	}
+
+	Subscription->CurrentRefreshInterval = FMath::Max(Subscription->MinRefreshInterval, 0.f);
+	StartSessionBrowserRefresh(Subscription);
+}
+
+void UEnhancedOnlineSessionsSubsystem::StartSessionBrowserRefresh(TWeakObjectPtr<UEnhancedSessionBrowserSubscription> WeakSubscription)
+{
+	UEnhancedSessionBrowserSubscription* Subscription = WeakSubscription.Get();
+	if (Subscription == nullptr || !Subscription->bIsSubscribed || Subscription->bIsRefreshing)
+	{
+		return;
+	}
+
+	Subscription->bIsRefreshing = true;
+
+	/* The live set is diffed against the raw results, result objects are only created for new sessions */
+	const FEnhancedSessionSearchQuery Query(Subscription->OnlineMode, Subscription->bFindLobbies, Subscription->SearchKeyword, Subscription->MaxSearchResults);
+	RequestRawSessionSearch(Query, FOnEnhancedRawSessionSearchCompleted::FDelegate::CreateUObject(this, &ThisClass::HandleSessionBrowserRefreshed, WeakSubscription));
+}
+
+void UEnhancedOnlineSessionsSubsystem::HandleSessionBrowserRefreshed(const TArray<FOnlineSessionSearchResult>& SearchResults, bool bWasSuccessful, TWeakObjectPtr<UEnhancedSessionBrowserSubscription> WeakSubscription)
+{
+	UEnhancedSessionBrowserSubscription* Subscription = WeakSubscription.Get();
+	if (Subscription == nullptr)
+	{
+		return;
+	}
+
+	Subscription->bIsRefreshing = false;
+
+	if (!Subscription->bIsSubscribed)
+	{
+		return;
+	}
+
+	const float MinInterval = FMath::Max(Subscription->MinRefreshInterval, 0.f);
+	const float MaxInterval = FMath::Max(Subscription->MaxRefreshInterval, MinInterval);
+	const float BackedOffInterval = FMath::Clamp(Subscription->CurrentRefreshInterval * FMath::Max(Subscription->BackoffMultiplier, 1.f), MinInterval, MaxInterval);
+
+	if (!bWasSuccessful)
+	{
+		UE_LOG(LogEnhancedSubsystem, Warning, TEXT("Failed to refresh the session browser, retrying in %.2fs."), BackedOffInterval);
+
+		Subscription->CurrentRefreshInterval = BackedOffInterval;
+		ScheduleSessionBrowserRefresh(Subscription);
+		return;
+	}
+
+	FEnhancedSessionBrowserDelta Delta;
+
+	TSet<FString> SeenSessions;
+	SeenSessions.Reserve(SearchResults.Num());
+
+	for (const FOnlineSessionSearchResult& SearchResult : SearchResults)
+	{
+		/* Sessions without an id can't be matched across refreshes */
+		const FString SessionId = UEnhancedSessionSearchResult::GetSessionId(SearchResult);
+		if (SessionId.IsEmpty() || SeenSessions.Contains(SessionId))
+		{
+			continue;
+		}
+		SeenSessions.Add(SessionId);
+
+		if (const TObjectPtr<UEnhancedSessionSearchResult>* KnownResult = Subscription->LiveSessions.Find(SessionId))
+		{
+			UEnhancedSessionSearchResult* Result = *KnownResult;
+
+			FEnhancedSessionSearchResultAttributes NewAttributes;
+			UEnhancedSessionSearchResult::DecodeAttributes(SearchResult, NewAttributes);
+
+			const EEnhancedSessionChangedFields ChangedFields = DiffSessionAttributes(Result->GetAttributes(), NewAttributes, Subscription->PingChangeThreshold);
+			const int32 KnownPing = Result->GetPingInMs();
+
+			/* Update the object in place so listeners can keep using it, ping jitter keeps the ping they already know */
+			Result->InitializeSearchResult(SearchResult);
+			if (!EnumHasAnyFlags(ChangedFields, EEnhancedSessionChangedFields::Ping))
+			{
+				Result->SetMeasuredPing(KnownPing);
+			}
+
+			if (ChangedFields != EEnhancedSessionChangedFields::None)
+			{
+				Delta.Changed.Emplace(Result, ChangedFields);
+			}
+		}
+		else
+		{
+			UEnhancedSessionSearchResult* Result = AcquireSearchResult(SearchResult);
+			Subscription->LiveSessions.Add(SessionId, Result);
+			Delta.Added.Add(Result);
+		}
+	}
+
+	for (auto It = Subscription->LiveSessions.CreateIterator(); It; ++It)
+	{
+		if (!SeenSessions.Contains(It.Key()))
+		{
+			Delta.Removed.Add(It.Value());
+			It.RemoveCurrent();
+		}
+	}
+
+	/* Refresh quickly while sessions change, back off while the list is quiet */
+	Subscription->CurrentRefreshInterval = Delta.IsEmpty() ? BackedOffInterval : MinInterval;
+	ScheduleSessionBrowserRefresh(Subscription);
+
+	if (!Delta.IsEmpty())
+	{
+		UE_LOG(LogEnhancedSubsystem, Log, TEXT("Session browser refreshed: %d added, %d removed, %d changed."), Delta.Added.Num(), Delta.Removed.Num(), Delta.Changed.Num());
+		Subscription->OnBrowserUpdated.Broadcast(Delta);
+	}
+
+	/* Removed sessions were only kept for the listeners, the pool hands them to the next sessions that show up */
+	for (UEnhancedSessionSearchResult* Result : Delta.Removed)
+	{
+		ReleaseSearchResult(Result);
+	}
+}
+
+void UEnhancedOnlineSessionsSubsystem::ScheduleSessionBrowserRefresh(UEnhancedSessionBrowserSubscription* Subscription)
+{
+	UGameInstance* GameInstance = GetGameInstance();
+	if (GameInstance == nullptr)
+	{
+		return;
+	}
+
+	const TWeakObjectPtr<UEnhancedSessionBrowserSubscription> WeakSubscription = Subscription;
+	GameInstance->GetTimerManager().SetTimer(Subscription->RefreshTimerHandle,
+		FTimerDelegate::CreateUObject(this, &ThisClass::StartSessionBrowserRefresh, WeakSubscription),
+		FMath::Max(Subscription->CurrentRefreshInterval, KINDA_SMALL_NUMBER), false);
+}
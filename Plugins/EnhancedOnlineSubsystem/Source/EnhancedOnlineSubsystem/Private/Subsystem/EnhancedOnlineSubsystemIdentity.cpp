@@ -6,18 +6,21 @@
 #include "Kismet/GameplayStatics.h"
 #include "Engine/LocalPlayer.h"
 
-void UEnhancedOnlineSessionsSubsystem::LoginOnlineUser(UEnhancedOnlineRequest_LoginUser* Request)
+namespace
 {
-	if (Request == nullptr)
+	/** Resolves the local player of a request again once it was started, the player may have left while it was queued */
+	ULocalPlayer* GetRequestLocalPlayer(const UEnhancedOnlineRequestBase* Request)
 	{
-		UE_LOG(LogEnhancedSubsystem, Error, TEXT("Login Online User was called with a bad request."));
-		return;
+		const APlayerController* PlayerController = UGameplayStatics::GetPlayerController(Request->GetWorld(), Request->LocalUserIndex);
+		return PlayerController ? PlayerController->GetLocalPlayer() : nullptr;
 	}
+}
 
-	if (IsValid(PendingLoginRequest))
+void UEnhancedOnlineSessionsSubsystem::LoginOnlineUser(UEnhancedOnlineRequest_LoginUser* Request)
+{
+	if (Request == nullptr)
 	{
-		UE_LOG(LogEnhancedSubsystem, Error, TEXT("A login request is already pending."));
-		Request->OnRequestFailedDelegate.Broadcast(TEXT("A login request is already pending."));
+		UE_LOG(LogEnhancedSubsystem, Error, TEXT("Login Online User was called with a bad request."));
 		return;
 	}
 
@@ -37,20 +40,47 @@ void UEnhancedOnlineSessionsSubsystem::LoginOnlineUser(UEnhancedOnlineRequest_Lo
 		return;
 	}
 
+	/* Logins and logouts of the same user wait for each other, other users log in alongside */
+	ScheduleRequest(Request, EEnhancedRequestCategory::Identity, FEnhancedRequestScheduler::MakeUserLane(LocalPlayer->GetControllerId()),
+		FOnEnhancedScheduledRequestStart::CreateUObject(this, &ThisClass::RunLoginRequest));
+}
+
+void UEnhancedOnlineSessionsSubsystem::RunLoginRequest(uint64 CorrelationId)
+{
+	UEnhancedOnlineRequest_LoginUser* Request = GetScheduledRequest<UEnhancedOnlineRequest_LoginUser>(CorrelationId);
+	if (!IsValid(Request))
+	{
+		CompleteScheduledRequest(CorrelationId);
+		return;
+	}
+
+	ULocalPlayer* LocalPlayer = GetRequestLocalPlayer(Request);
+	if (LocalPlayer == nullptr)
+	{
+		UE_LOG(LogEnhancedSubsystem, Error, TEXT("Login Online User was called with a bad local user index: %d."), Request->LocalUserIndex);
+		Request->OnRequestFailedDelegate.Broadcast(FString::Printf(TEXT("Login Online User was called with a bad local user index: %d."), Request->LocalUserIndex));
+		CompleteScheduledRequest(CorrelationId);
+		return;
+	}
+
 	LoginOnlineUserInternal(LocalPlayer, Request);
 }
 
 void UEnhancedOnlineSessionsSubsystem::LoginOnlineUserInternal(ULocalPlayer* LocalPlayer, UEnhancedOnlineRequest_LoginUser* Request)
 {
-	if (Request->Identity->GetLoginStatus(0) == ELoginStatus::LoggedIn)
+	/* The online service knows users by their controller, not by their index among the local players */
+	const int32 LocalUserNum = LocalPlayer->GetControllerId();
+	const uint64 CorrelationId = Request->CorrelationId;
+
+	if (Request->Identity->GetLoginStatus(LocalUserNum) == ELoginStatus::LoggedIn)
 	{
 		UE_LOG(LogEnhancedSubsystem, Error, TEXT("Login Online User was called with a user that is already logged in."));
-		Request->OnUserLoginCompleted.Broadcast(0);
+		Request->OnUserLoginCompleted.Broadcast(Request->LocalUserIndex);
+		CompleteScheduledRequest(CorrelationId);
 		return;
 	}
 
-	LoginDelegateHandle = Request->Identity->AddOnLoginCompleteDelegate_Handle(0, FOnLoginCompleteDelegate::CreateUObject(this, &UEnhancedOnlineSessionsSubsystem::HandleLoginComplete));
-	PendingLoginRequest = Request;
+	LoginDelegateHandles.Add(LocalUserNum, Request->Identity->AddOnLoginCompleteDelegate_Handle(LocalUserNum, FOnLoginCompleteDelegate::CreateUObject(this, &UEnhancedOnlineSessionsSubsystem::HandleLoginComplete)));
 
 	FString AuthTypeString;
 	StaticEnum<EEnhancedLoginAuthType>()->FindNameStringByValue(AuthTypeString, static_cast<int32>(Request->AuthType));
@@ -63,11 +93,15 @@ void UEnhancedOnlineSessionsSubsystem::LoginOnlineUserInternal(ULocalPlayer* Loc
 
 	UE_LOG(LogEnhancedSubsystem, Log, TEXT("Logging in user with type: %s, token: %s, id: %s"), *Credentials.Type, *Credentials.Token, *Credentials.Id);
 
-	if (!Request->Identity->Login(0, Credentials))
+	if (!Request->Identity->Login(LocalUserNum, Credentials))
 	{
 		UE_LOG(LogEnhancedSubsystem, Error, TEXT("Login Online User failed."));
+		Request->Identity->ClearOnLoginCompleteDelegate_Handle(LocalUserNum, LoginDelegateHandles.FindRef(LocalUserNum));
+		LoginDelegateHandles.Remove(LocalUserNum);
+
 		Request->OnRequestFailedDelegate.Broadcast(TEXT("Login Online User failed."));
 		Request->InvalidateRequest();
+		CompleteScheduledRequest(CorrelationId);
 	}
 }
 
@@ -76,13 +110,16 @@ void UEnhancedOnlineSessionsSubsystem::HandleLoginComplete(int32 LocalUserNum, b
 	IOnlineSubsystem* OnlineSub = Online::GetSubsystem(GetWorld());
 	IOnlineIdentityPtr Identity = OnlineSub->GetIdentityInterface();
 
+	/* The backend reports the user's controller, the controller's lane knows which request it answers */
+	UEnhancedOnlineRequest_LoginUser* PendingLoginRequest = FindRunningRequest<UEnhancedOnlineRequest_LoginUser>(EEnhancedRequestCategory::Identity, FEnhancedRequestScheduler::MakeUserLane(LocalUserNum));
+
 	if (bWasSuccessful)
 	{
 		UE_LOG(LogEnhancedSubsystem, Log, TEXT("Login Online User succeeded."));
 
 		if (PendingLoginRequest)
 		{
-			PendingLoginRequest->OnUserLoginCompleted.Broadcast(LocalUserNum);
+			PendingLoginRequest->OnUserLoginCompleted.Broadcast(PendingLoginRequest->LocalUserIndex);
 		}
 		else
 		{
@@ -103,15 +140,15 @@ void UEnhancedOnlineSessionsSubsystem::HandleLoginComplete(int32 LocalUserNum, b
 		}
 	}
 
-	Identity->ClearOnLoginCompleteDelegate_Handle(LocalUserNum, LoginDelegateHandle);
-	LoginDelegateHandle.Reset();
+	Identity->ClearOnLoginCompleteDelegate_Handle(LocalUserNum, LoginDelegateHandles.FindRef(LocalUserNum));
+	LoginDelegateHandles.Remove(LocalUserNum);
 
-	if (PendingSessionRequest)
+	if (PendingLoginRequest)
 	{
+		const uint64 CorrelationId = PendingLoginRequest->CorrelationId;
 		PendingLoginRequest->CompleteRequest();
+		CompleteScheduledRequest(CorrelationId);
 	}
-
-	PendingSessionRequest = nullptr;
 }
 
 void UEnhancedOnlineSessionsSubsystem::LogoutOnlineUser(UEnhancedOnlineRequest_LogoutUser* Request)
@@ -122,13 +159,6 @@ void UEnhancedOnlineSessionsSubsystem::LogoutOnlineUser(UEnhancedOnlineRequest_L
 		return;
 	}
 
-	if (IsValid(PendingLoginRequest))
-	{
-		UE_LOG(LogEnhancedSubsystem, Error, TEXT("A logout request is already pending."));
-		Request->OnRequestFailedDelegate.Broadcast(TEXT("A logout request is already pending."));
-		return;
-	}
-
 	APlayerController* PlayerController = UGameplayStatics::GetPlayerController(Request->GetWorld(), Request->LocalUserIndex);
 	if (PlayerController == nullptr)
 	{
@@ -145,28 +175,57 @@ void UEnhancedOnlineSessionsSubsystem::LogoutOnlineUser(UEnhancedOnlineRequest_L
 		return;
 	}
 
+	ScheduleRequest(Request, EEnhancedRequestCategory::Identity, FEnhancedRequestScheduler::MakeUserLane(LocalPlayer->GetControllerId()),
+		FOnEnhancedScheduledRequestStart::CreateUObject(this, &ThisClass::RunLogoutRequest));
+}
+
+void UEnhancedOnlineSessionsSubsystem::RunLogoutRequest(uint64 CorrelationId)
+{
+	UEnhancedOnlineRequest_LogoutUser* Request = GetScheduledRequest<UEnhancedOnlineRequest_LogoutUser>(CorrelationId);
+	if (!IsValid(Request))
+	{
+		CompleteScheduledRequest(CorrelationId);
+		return;
+	}
+
+	ULocalPlayer* LocalPlayer = GetRequestLocalPlayer(Request);
+	if (LocalPlayer == nullptr)
+	{
+		UE_LOG(LogEnhancedSubsystem, Error, TEXT("Logout Online User was called with a bad local user index: %d."), Request->LocalUserIndex);
+		Request->OnRequestFailedDelegate.Broadcast(FString::Printf(TEXT("Logout Online User was called with a bad local user index: %d."), Request->LocalUserIndex));
+		CompleteScheduledRequest(CorrelationId);
+		return;
+	}
+
 	LogoutOnlineUserInternal(LocalPlayer, Request);
 }
 
 void UEnhancedOnlineSessionsSubsystem::LogoutOnlineUserInternal(ULocalPlayer* LocalPlayer, UEnhancedOnlineRequest_LogoutUser* Request)
 {
-	if (Request->Identity->GetLoginStatus(0) != ELoginStatus::LoggedIn)
+	const int32 LocalUserNum = LocalPlayer->GetControllerId();
+	const uint64 CorrelationId = Request->CorrelationId;
+
+	if (Request->Identity->GetLoginStatus(LocalUserNum) != ELoginStatus::LoggedIn)
 	{
 		UE_LOG(LogEnhancedSubsystem, Error, TEXT("Logout Online User was called with a user that is already logged out."));
-		Request->OnUserLogoutCompleted.Broadcast(LocalPlayer->GetControllerId());
+		Request->OnUserLogoutCompleted.Broadcast(Request->LocalUserIndex);
+		CompleteScheduledRequest(CorrelationId);
 		return;
 	}
 
-	LogoutDelegateHandle = Request->Identity->AddOnLogoutCompleteDelegate_Handle(0, FOnLogoutCompleteDelegate::CreateUObject(this, &UEnhancedOnlineSessionsSubsystem::HandleLogoutComplete));
-	PendingLogoutRequest = Request;
+	LogoutDelegateHandles.Add(LocalUserNum, Request->Identity->AddOnLogoutCompleteDelegate_Handle(LocalUserNum, FOnLogoutCompleteDelegate::CreateUObject(this, &UEnhancedOnlineSessionsSubsystem::HandleLogoutComplete)));
 
 	UE_LOG(LogEnhancedSubsystem, Log, TEXT("Logging out user."));
 
-	if (!Request->Identity->Logout(0))
+	if (!Request->Identity->Logout(LocalUserNum))
 	{
 		UE_LOG(LogEnhancedSubsystem, Error, TEXT("Logout Online User failed."));
+		Request->Identity->ClearOnLogoutCompleteDelegate_Handle(LocalUserNum, LogoutDelegateHandles.FindRef(LocalUserNum));
+		LogoutDelegateHandles.Remove(LocalUserNum);
+
 		Request->OnRequestFailedDelegate.Broadcast(TEXT("Logout Online User failed."));
 		Request->InvalidateRequest();
+		CompleteScheduledRequest(CorrelationId);
 	}
 }
 
@@ -175,13 +234,15 @@ void UEnhancedOnlineSessionsSubsystem::HandleLogoutComplete(int32 LocalUserNum,
 	IOnlineSubsystem* OnlineSub = Online::GetSubsystem(GetWorld());
 	IOnlineIdentityPtr Identity = OnlineSub->GetIdentityInterface();
 
+	UEnhancedOnlineRequest_LogoutUser* PendingLogoutRequest = FindRunningRequest<UEnhancedOnlineRequest_LogoutUser>(EEnhancedRequestCategory::Identity, FEnhancedRequestScheduler::MakeUserLane(LocalUserNum));
+
 	if (bWasSuccessful)
 	{
 		UE_LOG(LogEnhancedSubsystem, Log, TEXT("Logout Online User succeeded."));
 
 		if (PendingLogoutRequest)
 		{
-			PendingLogoutRequest->OnUserLogoutCompleted.Broadcast(LocalUserNum);
+			PendingLogoutRequest->OnUserLogoutCompleted.Broadcast(PendingLogoutRequest->LocalUserIndex);
 		}
 		else
 		{
@@ -202,14 +263,14 @@ void UEnhancedOnlineSessionsSubsystem::HandleLogoutComplete(int32 LocalUserNum,
 		}
 	}
 
-	Identity->ClearOnLogoutCompleteDelegate_Handle(LocalUserNum, LogoutDelegateHandle);
-	LogoutDelegateHandle.Reset();
+	Identity->ClearOnLogoutCompleteDelegate_Handle(LocalUserNum, LogoutDelegateHandles.FindRef(LocalUserNum));
+	LogoutDelegateHandles.Remove(LocalUserNum);
 
 	if (PendingLogoutRequest)
 	{
+		const uint64 CorrelationId = PendingLogoutRequest->CorrelationId;
 		PendingLogoutRequest->CompleteRequest();
+		CompleteScheduledRequest(CorrelationId);
 	}
-
-	PendingLogoutRequest = nullptr;
 }
 
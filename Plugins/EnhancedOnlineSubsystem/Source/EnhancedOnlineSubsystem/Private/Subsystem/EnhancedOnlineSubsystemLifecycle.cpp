@@ -0,0 +1,445 @@
+// Copyright © 2024 MajorT. All rights reserved.
+
+#include "EnhancedOnlineSessionsSubsystem.h"
+
+#include "EnhancedOnlineRequests.h"
+#include "EnhancedOnlineSettingsPublisher.h"
+#include "EnhancedOnlineSubsystem.h"
+#include "OnlineSessionSettings.h"
+#include "TimerManager.h"
+#include "Engine/GameInstance.h"
+#include "Interfaces/OnlineSessionInterface.h"
+
+bool UEnhancedOnlineSessionsSubsystem::EndHostedSession(FName SessionName)
+{
+	const FEnhancedHostedSession* HostedSession = HostedSessions.Find(SessionName);
+	if (HostedSession == nullptr)
+	{
+		UE_LOG(LogEnhancedSubsystem, Error, TEXT("End Hosted Session was called with an unknown session: %s."), *SessionName.ToString());
+		return false;
+	}
+
+	if (HostedSession->State != EEnhancedHostedSessionState::InProgress)
+	{
+		UE_LOG(LogEnhancedSubsystem, Warning, TEXT("Session %s cannot be ended, it isn't in progress."), *SessionName.ToString());
+		return false;
+	}
+
+	IOnlineSessionPtr Sessions = Online::GetSessionInterface(GetWorld());
+	if (Sessions == nullptr)
+	{
+		UE_LOG(LogEnhancedSubsystem, Error, TEXT("End Hosted Session was called without a session interface."));
+		return false;
+	}
+
+	if (!EndSessionDelegateHandle.IsValid())
+	{
+		EndSessionDelegateHandle = Sessions->AddOnEndSessionCompleteDelegate_Handle(FOnEndSessionCompleteDelegate::CreateUObject(this, &ThisClass::HandleEndHostedSessionComplete));
+	}
+
+	SetHostedSessionState(SessionName, EEnhancedHostedSessionState::Ending);
+
+	if (!Sessions->EndSession(SessionName))
+	{
+		UE_LOG(LogEnhancedSubsystem, Error, TEXT("Failed to end session %s."), *SessionName.ToString());
+		SetHostedSessionState(SessionName, EEnhancedHostedSessionState::InProgress);
+		ClearStaleHostedSessionDelegates();
+		return false;
+	}
+
+	return true;
+}
+
+void UEnhancedOnlineSessionsSubsystem::HandleEndHostedSessionComplete(FName SessionName, bool bWasSuccessful)
+{
+	if (GetHostedSessionState(SessionName) == EEnhancedHostedSessionState::Ending)
+	{
+		if (!bWasSuccessful)
+		{
+			UE_LOG(LogEnhancedSubsystem, Error, TEXT("Failed to end session %s."), *SessionName.ToString());
+		}
+
+		SetHostedSessionState(SessionName, bWasSuccessful ? EEnhancedHostedSessionState::Pending : EEnhancedHostedSessionState::InProgress);
+	}
+
+	ClearStaleHostedSessionDelegates();
+}
+
+void UEnhancedOnlineSessionsSubsystem::StartHostedSessionWatchdog()
+{
+	if (HostedSessionWatchdogHandle.IsValid())
+	{
+		return;
+	}
+
+	HostedSessionWatchdogHandle = FTSTicker::GetCoreTicker().AddTicker(
+		FTickerDelegate::CreateUObject(this, &ThisClass::TickHostedSessionWatchdog), FMath::Max(HostedSessionWatchdogInterval, 0.f));
+}
+
+bool UEnhancedOnlineSessionsSubsystem::TickHostedSessionWatchdog(float DeltaTime)
+{
+	const double Now = FPlatformTime::Seconds();
+	const UGameInstance* GameInstance = GetGameInstance();
+
+	TArray<TPair<FName, EEnhancedHostedSessionState>> ExpiredStates;
+	TArray<FName> ExpiredUpdates;
+	bool bHasDeadlines = false;
+
+	for (const TPair<FName, FEnhancedHostedSession>& Pair : HostedSessions)
+	{
+		const FEnhancedHostedSession& HostedSession = Pair.Value;
+
+		/* A creation waiting for its next attempt isn't talking to the online service */
+		const bool bIsWaitingForRetry = HostedSession.bIsAbandoningCreate || (GameInstance && GameInstance->GetTimerManager().IsTimerActive(HostedSession.RetryTimerHandle));
+
+		const float StateTimeout = GetHostedSessionStateTimeout(HostedSession.State);
+		if (StateTimeout > 0.f && !bIsWaitingForRetry)
+		{
+			bHasDeadlines = true;
+			if (Now - HostedSession.StateEnterTime > StateTimeout)
+			{
+				ExpiredStates.Emplace(Pair.Key, HostedSession.State);
+			}
+		}
+
+		if (HostedSession.bIsUpdating && SessionUpdateTimeout > 0.f)
+		{
+			bHasDeadlines = true;
+			if (Now - HostedSession.UpdateStartTime > SessionUpdateTimeout)
+			{
+				ExpiredUpdates.Add(Pair.Key);
+			}
+		}
+
+		bHasDeadlines |= bIsWaitingForRetry;
+	}
+
+	for (const TPair<FName, EEnhancedHostedSessionState>& Expired : ExpiredStates)
+	{
+		/* An earlier timeout may have moved the session along already */
+		if (GetHostedSessionState(Expired.Key) == Expired.Value)
+		{
+			HandleHostedSessionStateTimeout(Expired.Key, Expired.Value);
+		}
+	}
+
+	for (const FName& SessionName : ExpiredUpdates)
+	{
+		UE_LOG(LogEnhancedSubsystem, Warning, TEXT("Updating session %s timed out after %.1fs."), *SessionName.ToString(), SessionUpdateTimeout);
+		HandleUpdateSessionComplete(SessionName, false);
+	}
+
+	if (!ExpiredStates.IsEmpty() || !ExpiredUpdates.IsEmpty())
+	{
+		ClearStaleHostedSessionDelegates();
+	}
+
+	if (!bHasDeadlines)
+	{
+		HostedSessionWatchdogHandle.Reset();
+		return false;
+	}
+
+	return true;
+}
+
+float UEnhancedOnlineSessionsSubsystem::GetHostedSessionStateTimeout(const EEnhancedHostedSessionState State) const
+{
+	switch (State)
+	{
+	case EEnhancedHostedSessionState::Creating:
+		return CreatingStateTimeout;
+	case EEnhancedHostedSessionState::Starting:
+		return StartingStateTimeout;
+	case EEnhancedHostedSessionState::Ending:
+		return EndingStateTimeout;
+	case EEnhancedHostedSessionState::Destroying:
+		return DestroyingStateTimeout;
+	default:
+		return 0.f;
+	}
+}
+
+void UEnhancedOnlineSessionsSubsystem::HandleHostedSessionStateTimeout(const FName SessionName, const EEnhancedHostedSessionState State)
+{
+	UE_LOG(LogEnhancedSubsystem, Warning, TEXT("Session %s timed out in state %s after %.1fs."),
+		*SessionName.ToString(), *UEnum::GetValueAsString(State), GetHostedSessionStateTimeout(State));
+
+	IOnlineSessionPtr Sessions = Online::GetSessionInterface(GetWorld());
+
+	switch (State)
+	{
+	case EEnhancedHostedSessionState::Creating:
+		{
+			/* Abandon the wedged attempt, the retry waits until the name is free to be registered again */
+			if (Sessions && Sessions->GetNamedSession(SessionName))
+			{
+				HostedSessions[SessionName].bIsAbandoningCreate = true;
+				const bool bIsDestroying = Sessions->DestroySession(SessionName, FOnDestroySessionCompleteDelegate::CreateUObject(this, &ThisClass::HandleAbandonedCreateDestroyed));
+
+				/* The completion may have fired synchronously and moved the session along already */
+				FEnhancedHostedSession* HostedSession = HostedSessions.Find(SessionName);
+				if (bIsDestroying || HostedSession == nullptr || !HostedSession->bIsAbandoningCreate)
+				{
+					break;
+				}
+				HostedSession->bIsAbandoningCreate = false;
+			}
+			HandleCreateSessionComplete(SessionName, false);
+			break;
+		}
+	case EEnhancedHostedSessionState::Starting:
+		{
+			UEnhancedOnlineRequest_StartSession* Request = FindRunningRequest<UEnhancedOnlineRequest_StartSession>(EEnhancedRequestCategory::StartSession, SessionName);
+
+			/* The online service may have started the session without telling, or still be starting it */
+			const FNamedOnlineSession* NamedSession = Sessions ? Sessions->GetNamedSession(SessionName) : nullptr;
+			const EOnlineSessionState::Type BackendState = NamedSession ? NamedSession->SessionState : EOnlineSessionState::NoSession;
+
+			SetHostedSessionState(SessionName, BackendState == EOnlineSessionState::InProgress ? EEnhancedHostedSessionState::InProgress : EEnhancedHostedSessionState::Pending);
+			if (FEnhancedHostedSession* HostedSession = HostedSessions.Find(SessionName))
+			{
+				HostedSession->bIsAwaitingLateStart = BackendState == EOnlineSessionState::Starting;
+			}
+
+			if (Request)
+			{
+				/* Frees the lane, a late completion of the backend then finds no request */
+				const uint64 CorrelationId = Request->CorrelationId;
+				Request->OnRequestFailedDelegate.Broadcast(FString::Printf(TEXT("Starting session %s timed out."), *SessionName.ToString()));
+				Request->CompleteRequest();
+				CompleteScheduledRequest(CorrelationId);
+			}
+
+			/* The caller was told the start failed, end the match the online service started anyway */
+			if (BackendState == EOnlineSessionState::InProgress)
+			{
+				EndHostedSession(SessionName);
+			}
+			break;
+		}
+	case EEnhancedHostedSessionState::Ending:
+		{
+			SetHostedSessionState(SessionName, EEnhancedHostedSessionState::Pending);
+			break;
+		}
+	case EEnhancedHostedSessionState::Destroying:
+		{
+			SetHostedSessionState(SessionName, EEnhancedHostedSessionState::Destroyed);
+			break;
+		}
+	default:
+		break;
+	}
+}
+
+void UEnhancedOnlineSessionsSubsystem::HandleAbandonedCreateDestroyed(FName SessionName, bool bWasSuccessful)
+{
+	FEnhancedHostedSession* HostedSession = HostedSessions.Find(SessionName);
+	if (HostedSession == nullptr || !HostedSession->bIsAbandoningCreate)
+	{
+		return;
+	}
+
+	if (!bWasSuccessful)
+	{
+		UE_LOG(LogEnhancedSubsystem, Warning, TEXT("Failed to destroy the timed out session %s, the next attempt may not be able to register it."), *SessionName.ToString());
+	}
+
+	HostedSession->bIsAbandoningCreate = false;
+	HandleCreateSessionComplete(SessionName, false);
+}
+
+void UEnhancedOnlineSessionsSubsystem::ClearStaleHostedSessionDelegates()
+{
+	ClearCreateSessionDelegateIfIdle();
+
+	bool bIsAnyEnding = false;
+	bool bIsAnyUpdating = false;
+	for (const TPair<FName, FEnhancedHostedSession>& Pair : HostedSessions)
+	{
+		bIsAnyEnding |= Pair.Value.State == EEnhancedHostedSessionState::Ending;
+		bIsAnyUpdating |= Pair.Value.bIsUpdating;
+	}
+
+	IOnlineSessionPtr Sessions = Online::GetSessionInterface(GetWorld());
+
+	ClearStartSessionDelegateIfIdle();
+
+	if (!bIsAnyEnding && EndSessionDelegateHandle.IsValid())
+	{
+		if (Sessions)
+		{
+			Sessions->ClearOnEndSessionCompleteDelegate_Handle(EndSessionDelegateHandle);
+		}
+		EndSessionDelegateHandle.Reset();
+	}
+
+	if (!bIsAnyUpdating && UpdateSessionDelegateHandle.IsValid())
+	{
+		if (Sessions)
+		{
+			Sessions->ClearOnUpdateSessionCompleteDelegate_Handle(UpdateSessionDelegateHandle);
+		}
+		UpdateSessionDelegateHandle.Reset();
+	}
+}
+
+bool UEnhancedOnlineSessionsSubsystem::DrainHostedSession(FName SessionName, float Deadline)
+{
+	FEnhancedHostedSession* HostedSession = HostedSessions.Find(SessionName);
+	if (HostedSession == nullptr || !HostedSession->Publisher.IsValid())
+	{
+		UE_LOG(LogEnhancedSubsystem, Error, TEXT("Drain Hosted Session was called with an unknown session: %s."), *SessionName.ToString());
+		return false;
+	}
+
+	if (HostedSession->DrainPhase != EEnhancedSessionDrainPhase::None)
+	{
+		UE_LOG(LogEnhancedSubsystem, Warning, TEXT("Session %s is already being drained."), *SessionName.ToString());
+		return false;
+	}
+
+	if (HostedSession->State == EEnhancedHostedSessionState::Creating || HostedSession->State == EEnhancedHostedSessionState::Destroying)
+	{
+		UE_LOG(LogEnhancedSubsystem, Warning, TEXT("Session %s cannot be drained while it is being created or destroyed."), *SessionName.ToString());
+		return false;
+	}
+
+	UE_LOG(LogEnhancedSubsystem, Log, TEXT("Draining session %s%s."), *SessionName.ToString(),
+		Deadline > 0.f ? *FString::Printf(TEXT(" within %.1fs"), Deadline) : TEXT(" once its match ended"));
+
+	HostedSession->DrainDeadlineTime = Deadline > 0.f ? FPlatformTime::Seconds() + Deadline : 0.0;
+
+	/* The backfill would open the session again */
+	HostedSession->bBackfillEnabled = false;
+	HostedSession->bIsBackfilling = false;
+
+	const TSharedRef<FEnhancedSessionSettingsPublisher> Publisher = HostedSession->Publisher.ToSharedRef();
+	SetHostedSessionDrainPhase(SessionName, EEnhancedSessionDrainPhase::Unadvertising);
+
+	Publisher->SetShouldAdvertise(false, EEnhancedSettingPublishPriority::High);
+	Publisher->SetAllowJoinInProgress(false, EEnhancedSettingPublishPriority::High);
+
+	StartDrainWatch();
+	return true;
+}
+
+EEnhancedSessionDrainPhase UEnhancedOnlineSessionsSubsystem::GetHostedSessionDrainPhase(FName SessionName) const
+{
+	const FEnhancedHostedSession* HostedSession = HostedSessions.Find(SessionName);
+	return HostedSession ? HostedSession->DrainPhase : EEnhancedSessionDrainPhase::None;
+}
+
+void UEnhancedOnlineSessionsSubsystem::StartDrainWatch()
+{
+	if (DrainWatchHandle.IsValid())
+	{
+		return;
+	}
+
+	DrainWatchHandle = FTSTicker::GetCoreTicker().AddTicker(
+		FTickerDelegate::CreateUObject(this, &ThisClass::TickDrainWatch), FMath::Max(DrainCheckInterval, 0.f));
+}
+
+bool UEnhancedOnlineSessionsSubsystem::TickDrainWatch(float DeltaTime)
+{
+	const double Now = FPlatformTime::Seconds();
+
+	TArray<FName> SessionNames;
+	HostedSessions.GetKeys(SessionNames);
+
+	bool bIsAnyDraining = false;
+	for (const FName& SessionName : SessionNames)
+	{
+		bIsAnyDraining |= UpdateHostedSessionDrain(SessionName, Now);
+	}
+
+	if (!bIsAnyDraining)
+	{
+		DrainWatchHandle.Reset();
+		return false;
+	}
+
+	return true;
+}
+
+bool UEnhancedOnlineSessionsSubsystem::UpdateHostedSessionDrain(const FName SessionName, const double Now)
+{
+	FEnhancedHostedSession* HostedSession = HostedSessions.Find(SessionName);
+	if (HostedSession == nullptr)
+	{
+		return false;
+	}
+
+	/* Destroying sessions are moved along by the watchdog */
+	const EEnhancedSessionDrainPhase Phase = HostedSession->DrainPhase;
+	if (Phase != EEnhancedSessionDrainPhase::Unadvertising && Phase != EEnhancedSessionDrainPhase::WaitingForMatch)
+	{
+		return false;
+	}
+
+	const bool bDeadlinePassed = HostedSession->DrainDeadlineTime > 0.0 && Now >= HostedSession->DrainDeadlineTime;
+
+	if (Phase == EEnhancedSessionDrainPhase::Unadvertising && !bDeadlinePassed)
+	{
+		/* Failed updates are sent again by the publisher, the session is hidden once nothing is pending */
+		if (!HostedSession->Publisher->IsDirty() && !HostedSession->Publisher->IsPublishing())
+		{
+			SetHostedSessionDrainPhase(SessionName, EEnhancedSessionDrainPhase::WaitingForMatch);
+		}
+		return true;
+	}
+
+	/* Players waiting in a session whose match hasn't started yet are kept too */
+	const EEnhancedHostedSessionState State = HostedSession->State;
+	const bool bCanHoldPlayers = State == EEnhancedHostedSessionState::Pending
+		|| State == EEnhancedHostedSessionState::Starting
+		|| State == EEnhancedHostedSessionState::InProgress
+		|| State == EEnhancedHostedSessionState::Ending;
+
+	bool bIsEmpty = true;
+	if (IOnlineSessionPtr Sessions = Online::GetSessionInterface(GetWorld()))
+	{
+		if (const FNamedOnlineSession* NamedSession = Sessions->GetNamedSession(SessionName))
+		{
+			bIsEmpty = NamedSession->NumOpenPublicConnections >= NamedSession->SessionSettings.NumPublicConnections;
+		}
+	}
+
+	if (bCanHoldPlayers && !bIsEmpty && !bDeadlinePassed)
+	{
+		return true;
+	}
+
+	if (bDeadlinePassed && bCanHoldPlayers && !bIsEmpty)
+	{
+		UE_LOG(LogEnhancedSubsystem, Warning, TEXT("Session %s missed its drain deadline, destroying it with players still in it."), *SessionName.ToString());
+	}
+
+	SetHostedSessionDrainPhase(SessionName, EEnhancedSessionDrainPhase::Destroying);
+
+	if (!DestroyHostedSession(SessionName))
+	{
+		/* Tried again with the next check */
+		if (FEnhancedHostedSession* FailedSession = HostedSessions.Find(SessionName))
+		{
+			FailedSession->DrainPhase = EEnhancedSessionDrainPhase::WaitingForMatch;
+		}
+		return true;
+	}
+
+	return false;
+}
+
+void UEnhancedOnlineSessionsSubsystem::SetHostedSessionDrainPhase(const FName SessionName, EEnhancedSessionDrainPhase NewPhase)
+{
+	FEnhancedHostedSession* HostedSession = HostedSessions.Find(SessionName);
+	if (HostedSession == nullptr || HostedSession->DrainPhase == NewPhase)
+	{
+		return;
+	}
+
+	HostedSession->DrainPhase = NewPhase;
+	OnHostedSessionDrainProgress.Broadcast(SessionName, NewPhase);
+}
@@ -0,0 +1,178 @@
+// Copyright © 2024 MajorT. All rights reserved.
+
+#include "EnhancedOnlineSessionsSubsystem.h"
+
+#include "EnhancedOnlineRequests.h"
+#include "EnhancedOnlineSubsystem.h"
+#include "UObject/Package.h"
+#include "UObject/UObjectGlobals.h"
+
+bool UEnhancedOnlineSessionsSubsystem::PreloadMapPackage(const FName PackageName, const FOnEnhancedMapPreloaded& OnPreloaded)
+{
+	if (PackageName.IsNone())
+	{
+		UE_LOG(LogEnhancedSubsystem, Warning, TEXT("Can't preload a map without a package name."));
+		OnPreloaded.ExecuteIfBound(PackageName, false);
+		return false;
+	}
+
+	if (!PostLoadMapDelegateHandle.IsValid())
+	{
+		PostLoadMapDelegateHandle = FCoreUObjectDelegates::PostLoadMapWithWorld.AddUObject(this, &ThisClass::HandlePostLoadMapWithWorld);
+	}
+
+	if (PreloadedMapPackages.Contains(PackageName))
+	{
+		OnPreloaded.ExecuteIfBound(PackageName, true);
+		return true;
+	}
+
+	/* Requests for a package that is already loading wait for the same load */
+	if (TArray<FOnEnhancedMapPreloaded>* PendingCallbacks = PendingMapPreloads.Find(PackageName))
+	{
+		CancelledMapPreloads.Remove(PackageName);
+		PendingCallbacks->Add(OnPreloaded);
+		return true;
+	}
+
+	PendingMapPreloads.Add(PackageName).Add(OnPreloaded);
+
+	UE_LOG(LogEnhancedSubsystem, Log, TEXT("Preloading map %s."), *PackageName.ToString());
+
+	LoadPackageAsync(PackageName.ToString(), FLoadPackageAsyncDelegate::CreateUObject(this, &ThisClass::HandleMapPackagePreloaded));
+	return true;
+}
+
+void UEnhancedOnlineSessionsSubsystem::ReleasePreloadedMapPackage(const FName PackageName)
+{
+	if (PreloadedMapPackages.Remove(PackageName) > 0)
+	{
+		UE_LOG(LogEnhancedSubsystem, Log, TEXT("Released preloaded map %s."), *PackageName.ToString());
+	}
+	else if (PendingMapPreloads.Contains(PackageName))
+	{
+		/* The running load can't be aborted, it just isn't kept once it completes */
+		CancelledMapPreloads.Add(PackageName);
+		UE_LOG(LogEnhancedSubsystem, Log, TEXT("Cancelled the preload of map %s."), *PackageName.ToString());
+	}
+}
+
+void UEnhancedOnlineSessionsSubsystem::HandleMapPackagePreloaded(const FName& PackageName, UPackage* LoadedPackage, EAsyncLoadingResult::Type Result)
+{
+	TArray<FOnEnhancedMapPreloaded> Callbacks;
+	if (!PendingMapPreloads.RemoveAndCopyValue(PackageName, Callbacks))
+	{
+		/* The subsystem was torn down while the package was loading */
+		return;
+	}
+
+	if (CancelledMapPreloads.Remove(PackageName) > 0)
+	{
+		UE_LOG(LogEnhancedSubsystem, Log, TEXT("Dropped map %s, its preload was cancelled while it was loading."), *PackageName.ToString());
+
+		for (const FOnEnhancedMapPreloaded& Callback : Callbacks)
+		{
+			Callback.ExecuteIfBound(PackageName, false);
+		}
+		return;
+	}
+
+	const bool bWasSuccessful = Result == EAsyncLoadingResult::Succeeded && LoadedPackage != nullptr;
+	if (bWasSuccessful)
+	{
+		PreloadedMapPackages.Add(PackageName, LoadedPackage);
+		UE_LOG(LogEnhancedSubsystem, Log, TEXT("Preloaded map %s."), *PackageName.ToString());
+	}
+	else
+	{
+		UE_LOG(LogEnhancedSubsystem, Warning, TEXT("Failed to preload map %s, the travel will load it instead."), *PackageName.ToString());
+	}
+
+	for (const FOnEnhancedMapPreloaded& Callback : Callbacks)
+	{
+		Callback.ExecuteIfBound(PackageName, bWasSuccessful);
+	}
+}
+
+void UEnhancedOnlineSessionsSubsystem::HandlePostLoadMapWithWorld(UWorld* LoadedWorld)
+{
+	if (LoadedWorld == nullptr)
+	{
+		return;
+	}
+
+	/* The loaded world keeps its own package alive now */
+	ReleasePreloadedMapPackage(LoadedWorld->GetOutermost()->GetFName());
+}
+
+void UEnhancedOnlineSessionsSubsystem::HandleCreateSessionMapPreloaded(const FName PackageName, bool bWasSuccessful, TWeakObjectPtr<UEnhancedOnlineRequest_CreateSession> WeakRequest, uint32 RequestSerial)
+{
+	/* A pooled request may have been reused by another create since the load started */
+	UEnhancedOnlineRequest_CreateSession* Request = WeakRequest.Get();
+	if (Request == nullptr || Request->RequestSerial != RequestSerial || !bWasSuccessful)
+	{
+		return;
+	}
+
+	Request->bMapPreloadCompleted = true;
+	Request->HostTimings.MapPreloadSeconds = FPlatformTime::Seconds() - Request->CreateSessionStartTime;
+}
+
+void UEnhancedOnlineSessionsSubsystem::PreloadJoinCandidateMap(UEnhancedOnlineRequest_JoinSession* Request, UEnhancedSessionSearchResult* Candidate)
+{
+	if (!Request->bPreloadMapDuringJoin)
+	{
+		return;
+	}
+
+	/* Sessions only advertise the short map name, the registry knows the package to load */
+	const FString& MapName = Candidate->GetAttributes().MapName;
+	FEnhancedMapRegistryEntry MapEntry;
+	if (MapName.IsEmpty() || !MapRegistry.IsValid() || !MapRegistry->FindMapByName(FName(*MapName), MapEntry))
+	{
+		UE_LOG(LogEnhancedSubsystem, Verbose, TEXT("Can't preload the map of session %s, the travel will load it instead."), *Candidate->GetAttributes().FriendlyName);
+		ReleaseJoinCandidateMap(Request);
+		return;
+	}
+
+	/* Fallback sessions on the same map keep the load that is already running */
+	if (MapEntry.PackageName == Request->PreloadMapPackageName)
+	{
+		return;
+	}
+
+	ReleaseJoinCandidateMap(Request);
+
+	Request->PreloadMapPackageName = MapEntry.PackageName;
+	Request->MapPreloadStartTime = FPlatformTime::Seconds();
+	Request->bMapPreloadCompleted = false;
+
+	PreloadMapPackage(MapEntry.PackageName, FOnEnhancedMapPreloaded::CreateUObject(this, &ThisClass::HandleJoinSessionMapPreloaded, TWeakObjectPtr<UEnhancedOnlineRequest_JoinSession>(Request), Request->RequestSerial));
+}
+
+void UEnhancedOnlineSessionsSubsystem::ReleaseJoinCandidateMap(UEnhancedOnlineRequest_JoinSession* Request)
+{
+	if (Request->PreloadMapPackageName.IsNone())
+	{
+		return;
+	}
+
+	/* Also cancels a load that is still running, so candidates that weren't joined don't stay resident */
+	ReleasePreloadedMapPackage(Request->PreloadMapPackageName);
+
+	Request->PreloadMapPackageName = NAME_None;
+	Request->bMapPreloadCompleted = false;
+}
+
+void UEnhancedOnlineSessionsSubsystem::HandleJoinSessionMapPreloaded(const FName PackageName, bool bWasSuccessful, TWeakObjectPtr<UEnhancedOnlineRequest_JoinSession> WeakRequest, uint32 RequestSerial)
+{
+	/* A pooled request may have been reused by another join since the load started */
+	UEnhancedOnlineRequest_JoinSession* Request = WeakRequest.Get();
+	if (Request == nullptr || Request->RequestSerial != RequestSerial || !bWasSuccessful || Request->PreloadMapPackageName != PackageName)
+	{
+		return;
+	}
+
+	Request->bMapPreloadCompleted = true;
+	Request->JoinTimings.MapPreloadSeconds = FPlatformTime::Seconds() - Request->MapPreloadStartTime;
+}
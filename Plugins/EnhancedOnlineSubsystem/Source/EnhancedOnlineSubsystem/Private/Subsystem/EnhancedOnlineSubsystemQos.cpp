@@ -0,0 +1,94 @@
+// Copyright © 2024 MajorT. All rights reserved.
+
+#include "EnhancedOnlineSessionsSubsystem.h"
+
+#include "EnhancedOnlineQos.h"
+#include "EnhancedOnlineRequests.h"
+#include "EnhancedOnlineSubsystem.h"
+#include "OnlineSubsystemUtils.h"
+#include "SocketSubsystem.h"
+#include "IPAddress.h"
+
+bool UEnhancedOnlineSessionsSubsystem::StartQosResponder(int32 Port)
+{
+	if (!QosResponder.IsValid())
+	{
+		QosResponder = MakeShared<FEnhancedSessionQosResponder>();
+	}
+
+	return QosResponder->Start(Port > 0 ? Port : QosPort);
+}
+
+void UEnhancedOnlineSessionsSubsystem::StopQosResponder()
+{
+	if (QosResponder.IsValid())
+	{
+		QosResponder->Stop();
+		QosResponder.Reset();
+	}
+}
+
+void UEnhancedOnlineSessionsSubsystem::AdvertiseQosPort(FEnhancedOnlineSessionSettings& InSessionSettings)
+{
+	if (bStartQosResponderWhenHosting && !(QosResponder.IsValid() && QosResponder->IsRunning()))
+	{
+		StartQosResponder();
+	}
+
+	if (QosResponder.IsValid() && QosResponder->IsRunning())
+	{
+		InSessionSettings.Set(SETTING_QOSPORT, QosResponder->GetPort(), EOnlineDataAdvertisementType::ViaOnlineService);
+	}
+}
+
+bool UEnhancedOnlineSessionsSubsystem::StartSessionSearchQos(const TSharedRef<FEnhancedOnlineSearchSettings>& Search)
+{
+	IOnlineSessionPtr Sessions = Online::GetSessionInterface(GetWorld());
+	ISocketSubsystem* SocketSubsystem = ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM);
+
+	if (!Sessions.IsValid() || SocketSubsystem == nullptr)
+	{
+		return false;
+	}
+
+	TSharedRef<FEnhancedSessionQosProber> Prober = MakeShared<FEnhancedSessionQosProber>(MaxConcurrentQosProbes, QosProbeTimeout, QosProbeAttempts);
+
+	for (UEnhancedSessionSearchResult* Result : Search->MaterializedResults)
+	{
+		/* Only hosts reachable by IP can be probed, relayed connections keep the ping of the online service */
+		FString ConnectString;
+		if (!Sessions->GetResolvedConnectString(Result->StoredSearchResult, NAME_GamePort, ConnectString))
+		{
+			continue;
+		}
+
+		TSharedPtr<FInternetAddr> Address = SocketSubsystem->GetAddressFromString(ConnectString);
+		if (!Address.IsValid() || !Address->IsValid())
+		{
+			continue;
+		}
+
+		const int32 HostQosPort = Result->GetAttributes().QosPort;
+		Address->SetPort(HostQosPort > 0 ? HostQosPort : QosPort);
+
+		Prober->AddProbe(Result, Address.ToSharedRef());
+	}
+
+	UE_LOG(LogEnhancedSubsystem, Log, TEXT("Measuring the ping of %d out of %d sessions."), Prober->GetNumProbes(), Search->MaterializedResults.Num());
+
+	TWeakPtr<FEnhancedSessionQosProber> WeakProber = Prober;
+	const bool bStarted = Prober->Start(FOnEnhancedQosProbesCompleted::CreateWeakLambda(this,
+		[this, Search, WeakProber]()
+		{
+			ActiveQosProbers.Remove(WeakProber.Pin());
+			FinishSessionSearch(Search);
+		}));
+
+	if (!bStarted)
+	{
+		return false;
+	}
+
+	ActiveQosProbers.Add(Prober);
+	return true;
+}
@@ -0,0 +1,314 @@
+// Copyright © 2024 MajorT. All rights reserved.
+
+#include "EnhancedOnlineSessionsSubsystem.h"
+
+#include "EnhancedOnlineRequests.h"
+#include "EnhancedOnlineSubsystem.h"
+#include "TimerManager.h"
+#include "Engine/GameInstance.h"
+
+void UEnhancedOnlineSessionsSubsystem::QuickJoinOnlineSession(UEnhancedOnlineRequest_QuickJoin* Request)
+{
+	if (Request == nullptr)
+	{
+		UE_LOG(LogEnhancedSubsystem, Error, TEXT("Quick Join Online Session was called with a bad request."));
+		return;
+	}
+
+	if (Request->Sessions == nullptr)
+	{
+		UE_LOG(LogEnhancedSubsystem, Error, TEXT("Quick Join Online Session was called with a bad session interface."));
+		Request->OnRequestFailedDelegate.Broadcast(TEXT("Quick Join Online Session was called with a bad session interface."));
+		return;
+	}
+
+	/* The quick join holds the join lane until it joined, its own joins skip the queue */
+	ScheduleRequest(Request, EEnhancedRequestCategory::Join, NAME_GameSession,
+		FOnEnhancedScheduledRequestStart::CreateUObject(this, &ThisClass::RunQuickJoinRequest));
+}
+
+void UEnhancedOnlineSessionsSubsystem::RunQuickJoinRequest(uint64 CorrelationId)
+{
+	UEnhancedOnlineRequest_QuickJoin* Request = GetScheduledRequest<UEnhancedOnlineRequest_QuickJoin>(CorrelationId);
+	if (!IsValid(Request))
+	{
+		CompleteScheduledRequest(CorrelationId);
+		return;
+	}
+
+	Request->Candidates.Reset();
+	Request->CandidateScores.Reset();
+	Request->SeenSessionIds.Reset();
+	Request->JoinRequest = nullptr;
+	Request->JoinedSession = nullptr;
+	Request->Timings = FEnhancedQuickJoinTimings();
+	Request->StartTime = FPlatformTime::Seconds();
+	Request->bSearchCompleted = false;
+	Request->bSearchWaitExpired = Request->MaxSearchWait <= 0.f;
+
+	/* Results are ranked as they stream in, so a good session is joined before the search completed */
+	UEnhancedOnlineRequest_FindSessions* FindRequest = NewObject<UEnhancedOnlineRequest_FindSessions>(Request);
+	FindRequest->ConstructRequest();
+	FindRequest->LocalUserIndex = Request->LocalUserIndex;
+	FindRequest->bInvalidateOnCompletion = false;
+	FindRequest->OnlineMode = Request->OnlineMode;
+	FindRequest->bFindLobbies = Request->bFindLobbies;
+	FindRequest->MaxSearchResults = Request->MaxSearchResults;
+	FindRequest->SearchKeyword = Request->SearchKeyword;
+	FindRequest->bAllowCachedResults = Request->bAllowCachedResults;
+	FindRequest->bStreamResults = true;
+
+	FindRequest->OnSearchResultsBatchReceived.AddUObject(this, &ThisClass::HandleQuickJoinSearchBatch);
+	FindRequest->OnFindOnlineSessionsCompleted.AddUObject(this, &ThisClass::HandleQuickJoinSearchCompleted);
+	FindRequest->OnRequestFailedDelegate.AddUObject(this, &ThisClass::HandleQuickJoinSearchFailed);
+
+	Request->FindRequest = FindRequest;
+	PendingQuickJoinRequest = Request;
+
+	if (!Request->bSearchWaitExpired)
+	{
+		if (UGameInstance* GameInstance = GetGameInstance())
+		{
+			GameInstance->GetTimerManager().SetTimer(Request->SearchWaitTimerHandle,
+				FTimerDelegate::CreateUObject(this, &ThisClass::HandleQuickJoinSearchWaitExpired, Request->RequestSerial), Request->MaxSearchWait, false);
+		}
+	}
+
+	UE_LOG(LogEnhancedSubsystem, Log, TEXT("Quick joining a session..."));
+
+	FindOnlineSessions(FindRequest);
+}
+
+void UEnhancedOnlineSessionsSubsystem::HandleQuickJoinSearchBatch(const TArray<UEnhancedSessionSearchResult*>& Results)
+{
+	if (UEnhancedOnlineRequest_QuickJoin* Request = PendingQuickJoinRequest)
+	{
+		AddQuickJoinCandidates(Request, Results);
+		TryStartQuickJoin();
+	}
+}
+
+void UEnhancedOnlineSessionsSubsystem::HandleQuickJoinSearchCompleted(const TArray<UEnhancedSessionSearchResult*> Results)
+{
+	UEnhancedOnlineRequest_QuickJoin* Request = PendingQuickJoinRequest;
+	if (Request == nullptr)
+	{
+		return;
+	}
+
+	/* Cached results are only delivered on completion, streamed ones were seen already */
+	AddQuickJoinCandidates(Request, Results);
+
+	Request->bSearchCompleted = true;
+	TryStartQuickJoin();
+}
+
+void UEnhancedOnlineSessionsSubsystem::HandleQuickJoinSearchFailed(const FString& Reason)
+{
+	UEnhancedOnlineRequest_QuickJoin* Request = PendingQuickJoinRequest;
+	if (Request == nullptr)
+	{
+		return;
+	}
+
+	/* Sessions found before the search failed can still be joined */
+	UE_LOG(LogEnhancedSubsystem, Warning, TEXT("Quick join search failed: %s"), *Reason);
+
+	Request->bSearchCompleted = true;
+	TryStartQuickJoin();
+}
+
+void UEnhancedOnlineSessionsSubsystem::HandleQuickJoinSearchWaitExpired(uint32 RequestSerial)
+{
+	UEnhancedOnlineRequest_QuickJoin* Request = PendingQuickJoinRequest;
+	if (Request && Request->RequestSerial == RequestSerial)
+	{
+		Request->bSearchWaitExpired = true;
+		TryStartQuickJoin();
+	}
+}
+
+void UEnhancedOnlineSessionsSubsystem::AddQuickJoinCandidates(UEnhancedOnlineRequest_QuickJoin* Request, const TArray<UEnhancedSessionSearchResult*>& Results)
+{
+	for (UEnhancedSessionSearchResult* Result : Results)
+	{
+		if (Result == nullptr)
+		{
+			continue;
+		}
+
+		/* Every session is scored once, even if a later batch or the completion delivers it again */
+		const FString& SessionId = Result->GetAttributes().SessionId;
+		if (SessionId.IsEmpty())
+		{
+			continue;
+		}
+
+		bool bIsAlreadySeen = false;
+		Request->SeenSessionIds.Add(SessionId, &bIsAlreadySeen);
+		if (bIsAlreadySeen)
+		{
+			continue;
+		}
+
+		const float Score = Request->ScoreCandidate(Result);
+		if (Score < 0.f)
+		{
+			continue;
+		}
+
+		if (Request->Timings.FirstCandidateSeconds <= 0.f)
+		{
+			Request->Timings.FirstCandidateSeconds = FPlatformTime::Seconds() - Request->StartTime;
+		}
+
+		int32 InsertIndex = 0;
+		while (InsertIndex < Request->CandidateScores.Num() && Request->CandidateScores[InsertIndex] >= Score)
+		{
+			InsertIndex++;
+		}
+
+		/* The search releases its results once it completed, the candidates have to outlive it */
+		RetainSearchResult(Result);
+		Request->Candidates.Insert(Result, InsertIndex);
+		Request->CandidateScores.Insert(Score, InsertIndex);
+	}
+}
+
+void UEnhancedOnlineSessionsSubsystem::TryStartQuickJoin()
+{
+	UEnhancedOnlineRequest_QuickJoin* Request = PendingQuickJoinRequest;
+	if (Request == nullptr || Request->JoinRequest)
+	{
+		return;
+	}
+
+	if (Request->Timings.JoinAttempts >= FMath::Max(Request->MaxJoinAttempts, 1))
+	{
+		FailQuickJoinRequest(TEXT("None of the tried sessions could be joined."));
+		return;
+	}
+
+	if (Request->Candidates.IsEmpty())
+	{
+		if (Request->bSearchCompleted)
+		{
+			FailQuickJoinRequest(Request->Timings.JoinAttempts > 0 ? TEXT("None of the tried sessions could be joined.") : TEXT("No joinable session was found."));
+		}
+		return;
+	}
+
+	/* Wait for a better session unless the best one is good enough, or waiting any longer costs more than it gains */
+	if (!Request->bSearchCompleted && !Request->bSearchWaitExpired && Request->CandidateScores[0] < Request->GoodEnoughScore)
+	{
+		return;
+	}
+
+	UEnhancedSessionSearchResult* Candidate = Request->Candidates[0];
+	UE_LOG(LogEnhancedSubsystem, Log, TEXT("Quick joining session %s with a score of %.2f."), *Candidate->GetAttributes().FriendlyName, Request->CandidateScores[0]);
+
+	Request->Candidates.RemoveAt(0);
+	Request->CandidateScores.RemoveAt(0);
+	Request->Timings.JoinAttempts++;
+
+	UEnhancedOnlineRequest_JoinSession* JoinRequest = NewObject<UEnhancedOnlineRequest_JoinSession>(Request);
+	JoinRequest->ConstructRequest();
+	JoinRequest->LocalUserIndex = Request->LocalUserIndex;
+	JoinRequest->bInvalidateOnCompletion = false;
+	JoinRequest->SessionToJoin = Candidate;
+	JoinRequest->bReserveSlot = Request->bReserveSlot;
+
+	JoinRequest->OnJoinSessionCompleted.AddUObject(this, &ThisClass::HandleQuickJoinJoined);
+	JoinRequest->OnRequestFailedDelegate.AddUObject(this, &ThisClass::HandleQuickJoinJoinFailed);
+
+	Request->JoinRequest = JoinRequest;
+	StartJoinSessionRequest(JoinRequest);
+}
+
+void UEnhancedOnlineSessionsSubsystem::HandleQuickJoinJoined(const FName SessionName)
+{
+	UEnhancedOnlineRequest_QuickJoin* Request = PendingQuickJoinRequest;
+	if (Request == nullptr || Request->JoinRequest == nullptr)
+	{
+		return;
+	}
+
+	Request->JoinedSession = Request->JoinRequest->JoinedSession;
+	Request->Timings.TimeToJoinSeconds = FPlatformTime::Seconds() - Request->StartTime;
+	Request->Timings.bJoinedBeforeSearchCompleted = !Request->bSearchCompleted;
+
+	UE_LOG(LogEnhancedSubsystem, Log, TEXT("Quick joined a session in %.2f seconds after %d attempts."), Request->Timings.TimeToJoinSeconds, Request->Timings.JoinAttempts);
+
+	FinishQuickJoinRequest(Request);
+
+	const uint64 CorrelationId = Request->CorrelationId;
+	Request->OnQuickJoinCompleted.Broadcast(SessionName, Request->JoinedSession);
+	Request->CompleteRequest();
+	CompleteScheduledRequest(CorrelationId);
+}
+
+void UEnhancedOnlineSessionsSubsystem::HandleQuickJoinJoinFailed(const FString& Reason)
+{
+	UEnhancedOnlineRequest_QuickJoin* Request = PendingQuickJoinRequest;
+	if (Request == nullptr || Request->JoinRequest == nullptr)
+	{
+		return;
+	}
+
+	UE_LOG(LogEnhancedSubsystem, Warning, TEXT("Quick join attempt failed, trying the next session: %s"), *Reason);
+
+	ReleaseSearchResult(Request->JoinRequest->SessionToJoin);
+	Request->JoinRequest = nullptr;
+
+	TryStartQuickJoin();
+}
+
+void UEnhancedOnlineSessionsSubsystem::FinishQuickJoinRequest(UEnhancedOnlineRequest_QuickJoin* Request)
+{
+	PendingQuickJoinRequest = nullptr;
+
+	if (UGameInstance* GameInstance = GetGameInstance())
+	{
+		GameInstance->GetTimerManager().ClearTimer(Request->SearchWaitTimerHandle);
+	}
+
+	/* A search that is still running has nobody left to deliver to, the request keeps it alive until it completes */
+	if (Request->FindRequest)
+	{
+		Request->FindRequest->OnSearchResultsBatchReceived.RemoveAll(this);
+		Request->FindRequest->OnFindOnlineSessionsCompleted.RemoveAll(this);
+		Request->FindRequest->OnRequestFailedDelegate.RemoveAll(this);
+	}
+
+	if (Request->JoinRequest)
+	{
+		Request->JoinRequest->OnJoinSessionCompleted.RemoveAll(this);
+		Request->JoinRequest->OnRequestFailedDelegate.RemoveAll(this);
+		Request->JoinRequest = nullptr;
+	}
+
+	for (UEnhancedSessionSearchResult* Candidate : Request->Candidates)
+	{
+		ReleaseSearchResult(Candidate);
+	}
+	Request->Candidates.Reset();
+	Request->CandidateScores.Reset();
+}
+
+void UEnhancedOnlineSessionsSubsystem::FailQuickJoinRequest(const FString& Reason)
+{
+	UEnhancedOnlineRequest_QuickJoin* Request = PendingQuickJoinRequest;
+	if (Request == nullptr)
+	{
+		return;
+	}
+
+	FinishQuickJoinRequest(Request);
+
+	UE_LOG(LogEnhancedSubsystem, Error, TEXT("%s"), *Reason);
+
+	const uint64 CorrelationId = Request->CorrelationId;
+	Request->OnRequestFailedDelegate.Broadcast(Reason);
+	Request->CompleteRequest();
+	CompleteScheduledRequest(CorrelationId);
+}
@@ -0,0 +1,137 @@
+// Copyright © 2024 MajorT. All rights reserved.
+
+#include "EnhancedOnlineSessionsSubsystem.h"
+
+#include "EnhancedOnlineRequests.h"
+#include "EnhancedOnlineSubsystem.h"
+#include "Engine/GameInstance.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+
+namespace
+{
+	UEnhancedOnlineSessionsSubsystem* GetWorldSubsystem(const UObject* WorldContextObject)
+	{
+		const UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+		const UGameInstance* GameInstance = World ? World->GetGameInstance() : nullptr;
+		return GameInstance ? GameInstance->GetSubsystem<UEnhancedOnlineSessionsSubsystem>() : nullptr;
+	}
+
+	FAutoConsoleCommandWithWorld PoolStatsCommand(
+		TEXT("EnhancedOnline.PoolStats"),
+		TEXT("Logs the counters of the request and search result pools"),
+		FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+		{
+			const UEnhancedOnlineSessionsSubsystem* Subsystem = GetWorldSubsystem(World);
+			if (Subsystem == nullptr)
+			{
+				UE_LOG(LogEnhancedSubsystem, Display, TEXT("No enhanced online subsystem is running in this world."));
+				return;
+			}
+
+			const FEnhancedRequestPoolStats RequestStats = Subsystem->GetRequestPoolStats();
+			UE_LOG(LogEnhancedSubsystem, Display, TEXT("Requests: %d hits, %d misses, %d recycled, %d discarded, %d pooled."),
+				RequestStats.Hits, RequestStats.Misses, RequestStats.Recycled, RequestStats.Discarded, RequestStats.Pooled);
+
+			const FEnhancedSearchResultPoolStats ResultStats = Subsystem->GetSearchResultPoolStats();
+			UE_LOG(LogEnhancedSubsystem, Display, TEXT("Search results: %d hits, %d misses, %d recycled, %d pooled."),
+				ResultStats.Hits, ResultStats.Misses, ResultStats.Recycled, ResultStats.Pooled);
+		}));
+}
+
+void UEnhancedOnlineRequestBase::ReleaseToPool()
+{
+	UEnhancedOnlineSessionsSubsystem* Pool = OwningPool.Get();
+	OwningPool.Reset();
+
+	if (Pool)
+	{
+		Pool->ReleaseRequest(this);
+	}
+	else
+	{
+		MarkAsGarbage();
+	}
+}
+
+void UEnhancedOnlineRequestBase::ReleaseSearchResults(TArray<TObjectPtr<UEnhancedSessionSearchResult>>& Results)
+{
+	if (UEnhancedOnlineSessionsSubsystem* Pool = OwningPool.Get())
+	{
+		for (UEnhancedSessionSearchResult* Result : Results)
+		{
+			Pool->ReleaseSearchResult(Result);
+		}
+	}
+
+	Results.Reset();
+}
+
+UEnhancedOnlineRequestBase* UEnhancedOnlineSessionsSubsystem::AcquireRequest(UObject* WorldContextObject, UClass* RequestClass)
+{
+	check(RequestClass && RequestClass->IsChildOf(UEnhancedOnlineRequestBase::StaticClass()));
+
+	if (UEnhancedOnlineSessionsSubsystem* Subsystem = GetWorldSubsystem(WorldContextObject))
+	{
+		return Subsystem->AcquirePooledRequest(RequestClass);
+	}
+
+	return NewObject<UEnhancedOnlineRequestBase>(WorldContextObject, RequestClass);
+}
+
+UEnhancedOnlineRequestBase* UEnhancedOnlineSessionsSubsystem::AcquirePooledRequest(UClass* RequestClass)
+{
+	/* Requests released this frame may still be touched by the code that completed them */
+	const int32 Index = FreeRequests.FindLastByPredicate([RequestClass](const TObjectPtr<UEnhancedOnlineRequestBase>& Request)
+	{
+		return Request->GetClass() == RequestClass && Request->PoolReleaseFrame != GFrameCounter;
+	});
+
+	UEnhancedOnlineRequestBase* Request = nullptr;
+
+	if (Index != INDEX_NONE)
+	{
+		Request = FreeRequests[Index];
+		FreeRequests.RemoveAtSwap(Index, 1, false);
+
+		/* The reset hands the search results of the previous use back to this pool */
+		Request->OwningPool = this;
+		Request->ResetRequest();
+		RequestPoolStats.Hits++;
+	}
+	else
+	{
+		Request = NewObject<UEnhancedOnlineRequestBase>(this, RequestClass);
+		Request->OwningPool = this;
+		RequestPoolStats.Misses++;
+	}
+
+	return Request;
+}
+
+void UEnhancedOnlineSessionsSubsystem::ReleaseRequest(UEnhancedOnlineRequestBase* Request)
+{
+	if (Request == nullptr || FreeRequests.Contains(Request))
+	{
+		return;
+	}
+
+	/* Requests beyond the pool's capacity are left to the garbage collector */
+	if (FreeRequests.Num() >= MaxPooledRequests)
+	{
+		Request->MarkAsGarbage();
+		RequestPoolStats.Discarded++;
+		return;
+	}
+
+	Request->PoolReleaseFrame = GFrameCounter;
+	FreeRequests.Add(Request);
+	RequestPoolStats.Recycled++;
+}
+
+FEnhancedRequestPoolStats UEnhancedOnlineSessionsSubsystem::GetRequestPoolStats() const
+{
+	FEnhancedRequestPoolStats Stats = RequestPoolStats;
+	Stats.Pooled = FreeRequests.Num();
+	return Stats;
+}
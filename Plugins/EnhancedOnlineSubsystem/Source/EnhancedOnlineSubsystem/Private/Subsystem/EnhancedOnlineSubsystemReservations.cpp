@@ -0,0 +1,246 @@
+// Copyright © 2024 MajorT. All rights reserved.
+
+#include "EnhancedOnlineSessionsSubsystem.h"
+
+#include "EnhancedOnlineRequests.h"
+#include "EnhancedOnlineReservation.h"
+#include "EnhancedOnlineSubsystem.h"
+#include "IPAddress.h"
+#include "OnlineSubsystemUtils.h"
+#include "SocketSubsystem.h"
+#include "Engine/NetConnection.h"
+#include "GameFramework/GameModeBase.h"
+#include "GameFramework/PlayerController.h"
+#include "Kismet/GameplayStatics.h"
+
+namespace
+{
+	/** Name of the login URL option the reservation token is passed with */
+	const TCHAR* ReservationTokenOption = TEXT("ReservationToken");
+}
+
+bool UEnhancedOnlineSessionsSubsystem::StartReservationHost(int32 Port)
+{
+	if (!ReservationHost.IsValid())
+	{
+		ReservationHost = MakeShared<FEnhancedSessionReservationHost>();
+		ReservationHost->OnQueryOpenSlots.BindUObject(this, &ThisClass::GetReservableSlots);
+	}
+
+	/* Arriving clients free their reservation, the player then counts against the session itself */
+	if (!GameModePostLoginHandle.IsValid())
+	{
+		GameModePostLoginHandle = FGameModeEvents::GameModePostLoginEvent.AddUObject(this, &ThisClass::HandleGameModePostLogin);
+	}
+
+	return ReservationHost->Start(Port > 0 ? Port : ReservationPort, ReservationTimeToLive);
+}
+
+void UEnhancedOnlineSessionsSubsystem::StopReservationHost()
+{
+	if (ReservationHost.IsValid())
+	{
+		ReservationHost->Stop();
+		ReservationHost.Reset();
+	}
+
+	FGameModeEvents::GameModePostLoginEvent.Remove(GameModePostLoginHandle);
+	GameModePostLoginHandle.Reset();
+}
+
+bool UEnhancedOnlineSessionsSubsystem::ConsumeSlotReservation(const FString& Options)
+{
+	const FString Token = UGameplayStatics::ParseOption(Options, ReservationTokenOption);
+	if (Token.IsEmpty() || !ReservationHost.IsValid())
+	{
+		return false;
+	}
+
+	return ReservationHost->ConsumeReservation(FCString::Strtoui64(*Token, nullptr, 10));
+}
+
+void UEnhancedOnlineSessionsSubsystem::HandleGameModePostLogin(AGameModeBase* GameMode, APlayerController* NewPlayer)
+{
+	/* Every game instance of a PIE session sees the logins of the others */
+	if (GameMode == nullptr || GameMode->GetGameInstance() != GetGameInstance() || NewPlayer == nullptr)
+	{
+		return;
+	}
+
+	/* Local players never reserved a slot, remote ones pass the token with the URL they logged in with */
+	const UNetConnection* Connection = NewPlayer->GetNetConnection();
+	if (Connection && !NewPlayer->IsLocalController() && ConsumeSlotReservation(Connection->RequestURL))
+	{
+		UE_LOG(LogEnhancedSubsystem, Verbose, TEXT("Consumed the slot reservation of %s."), *GetNameSafe(NewPlayer));
+	}
+}
+
+void UEnhancedOnlineSessionsSubsystem::AdvertiseReservationPort(FEnhancedOnlineSessionSettings& InSessionSettings)
+{
+	if (bStartReservationHostWhenHosting && !(ReservationHost.IsValid() && ReservationHost->IsRunning()))
+	{
+		StartReservationHost();
+	}
+
+	if (ReservationHost.IsValid() && ReservationHost->IsRunning())
+	{
+		InSessionSettings.Set(SETTING_RESERVATIONPORT, ReservationHost->GetPort(), EOnlineDataAdvertisementType::ViaOnlineService);
+	}
+}
+
+int32 UEnhancedOnlineSessionsSubsystem::GetReservableSlots(uint32 SessionKey) const
+{
+	IOnlineSessionPtr Sessions = Online::GetSessionInterface(GetWorld());
+	if (Sessions == nullptr)
+	{
+		return INDEX_NONE;
+	}
+
+	for (const TPair<FName, FEnhancedHostedSession>& Pair : HostedSessions)
+	{
+		const EEnhancedHostedSessionState State = Pair.Value.State;
+		if (State == EEnhancedHostedSessionState::Creating || State == EEnhancedHostedSessionState::Destroying)
+		{
+			continue;
+		}
+
+		const FNamedOnlineSession* NamedSession = Sessions->GetNamedSession(Pair.Key);
+		if (NamedSession == nullptr || FEnhancedSessionReservationHost::MakeSessionKey(UEnhancedSessionSearchResult::GetSessionId(*NamedSession)) != SessionKey)
+		{
+			continue;
+		}
+
+		const bool bIsDraining = Pair.Value.DrainPhase != EEnhancedSessionDrainPhase::None;
+
+		/* Drained sessions take no new players, running matches only if they allow joining in progress */
+		if (bIsDraining || (State == EEnhancedHostedSessionState::InProgress && !NamedSession->SessionSettings.bAllowJoinInProgress))
+		{
+			return 0;
+		}
+
+		return NamedSession->NumOpenPublicConnections;
+	}
+
+	return INDEX_NONE;
+}
+
+void UEnhancedOnlineSessionsSubsystem::TryNextJoinCandidate()
+{
+	UEnhancedOnlineRequest_JoinSession* Request = PendingJoinRequest;
+	check(Request);
+
+	if (Request->CandidateIndex >= Request->JoinCandidates.Num())
+	{
+		FailJoinRequest(Request->JoinCandidates.Num() > 1 ? TEXT("None of the sessions had a free slot.") : TEXT("The session has no free slot."));
+		return;
+	}
+
+	UEnhancedSessionSearchResult* Candidate = Request->JoinCandidates[Request->CandidateIndex];
+	Request->ReservationToken = 0;
+
+	/* The map loads while the slot is reserved and the session joined */
+	PreloadJoinCandidateMap(Request, Candidate);
+
+	const FEnhancedSessionSearchResultAttributes& Attributes = Candidate->GetAttributes();
+	ISocketSubsystem* SocketSubsystem = ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM);
+
+	/* Hosts that take no reservations are joined right away */
+	if (!Request->bReserveSlot || Attributes.ReservationPort <= 0 || Attributes.SessionId.IsEmpty() || SocketSubsystem == nullptr)
+	{
+		JoinCandidateSession(Candidate);
+		return;
+	}
+
+	/* Only hosts reachable by IP can be asked, relayed connections are joined right away */
+	FString ConnectString;
+	TSharedPtr<FInternetAddr> Address;
+	if (Request->Sessions->GetResolvedConnectString(Candidate->StoredSearchResult, NAME_GamePort, ConnectString))
+	{
+		Address = SocketSubsystem->GetAddressFromString(ConnectString);
+	}
+
+	if (!Address.IsValid() || !Address->IsValid())
+	{
+		JoinCandidateSession(Candidate);
+		return;
+	}
+
+	Address->SetPort(Attributes.ReservationPort);
+
+	const FGuid Guid = FGuid::NewGuid();
+	Request->ReservationToken = (static_cast<uint64>(Guid.A ^ Guid.C) << 32) | static_cast<uint64>(Guid.B ^ Guid.D);
+
+	if (!ReservationClient.IsValid())
+	{
+		ReservationClient = MakeShared<FEnhancedSessionReservationClient>(ReservationTimeout, ReservationAttempts);
+	}
+
+	UE_LOG(LogEnhancedSubsystem, Log, TEXT("Reserving a slot in session %s..."), *Attributes.FriendlyName);
+	Request->ReservationStartTime = FPlatformTime::Seconds();
+
+	const bool bStarted = ReservationClient->Start(Address.ToSharedRef(), FEnhancedSessionReservationHost::MakeSessionKey(Attributes.SessionId),
+		Request->ReservationToken, FOnEnhancedReservationCompleted::CreateUObject(this, &ThisClass::HandleSlotReservationCompleted));
+
+	if (!bStarted)
+	{
+		Request->ReservationToken = 0;
+		JoinCandidateSession(Candidate);
+	}
+}
+
+void UEnhancedOnlineSessionsSubsystem::HandleSlotReservationCompleted(EEnhancedReservationResult Result)
+{
+	UEnhancedOnlineRequest_JoinSession* Request = PendingJoinRequest;
+	if (Request == nullptr || !Request->JoinCandidates.IsValidIndex(Request->CandidateIndex))
+	{
+		return;
+	}
+
+	UEnhancedSessionSearchResult* Candidate = Request->JoinCandidates[Request->CandidateIndex];
+	Request->JoinTimings.ReservationSeconds += FPlatformTime::Seconds() - Request->ReservationStartTime;
+
+	if (Result == EEnhancedReservationResult::Accepted)
+	{
+		UE_LOG(LogEnhancedSubsystem, Log, TEXT("Reserved a slot in session %s."), *Candidate->GetAttributes().FriendlyName);
+		JoinCandidateSession(Candidate);
+		return;
+	}
+
+	/* Skip the connect and map load that would end in a rejection */
+	UE_LOG(LogEnhancedSubsystem, Warning, TEXT("Session %s refused the reservation: %s."), *Candidate->GetAttributes().FriendlyName, *UEnum::GetValueAsString(Result));
+
+	Request->CandidateIndex++;
+	TryNextJoinCandidate();
+}
+
+void UEnhancedOnlineSessionsSubsystem::FailJoinRequest(const FString& Reason)
+{
+	UEnhancedOnlineRequest_JoinSession* Request = PendingJoinRequest;
+	PendingJoinRequest = nullptr;
+
+	if (ReservationClient.IsValid())
+	{
+		ReservationClient->Cancel();
+	}
+
+	if (JoinSessionDelegateHandle.IsValid())
+	{
+		if (IOnlineSessionPtr Sessions = Online::GetSessionInterface(GetWorld()))
+		{
+			Sessions->ClearOnJoinSessionCompleteDelegate_Handle(JoinSessionDelegateHandle);
+		}
+		JoinSessionDelegateHandle.Reset();
+	}
+
+	UE_LOG(LogEnhancedSubsystem, Error, TEXT("%s"), *Reason);
+
+	if (Request)
+	{
+		ReleaseJoinCandidateMap(Request);
+
+		const uint64 CorrelationId = Request->CorrelationId;
+		Request->OnRequestFailedDelegate.Broadcast(Reason);
+		Request->CompleteRequest();
+		CompleteScheduledRequest(CorrelationId);
+	}
+}
@@ -0,0 +1,56 @@
+// Copyright © 2024 MajorT. All rights reserved.
+
+#include "EnhancedOnlineSessionsSubsystem.h"
+
+#include "EnhancedOnlineRequests.h"
+#include "EnhancedOnlineRequestScheduler.h"
+#include "EnhancedOnlineSubsystem.h"
+
+uint64 UEnhancedOnlineSessionsSubsystem::ScheduleRequest(UEnhancedOnlineRequestBase* Request, const EEnhancedRequestCategory Category, const FName Lane, const FOnEnhancedScheduledRequestStart& OnStart)
+{
+	check(Request);
+
+	const uint64 CorrelationId = RequestScheduler.IsValid() ? RequestScheduler->Schedule(Category, Lane, Request->Priority, OnStart) : 0;
+	if (CorrelationId == 0)
+	{
+		const FString Reason = FString::Printf(TEXT("Too many %s requests are queued."), *UEnum::GetDisplayValueAsText(Category).ToString());
+		UE_LOG(LogEnhancedSubsystem, Error, TEXT("%s"), *Reason);
+		Request->OnRequestFailedDelegate.Broadcast(Reason);
+		return 0;
+	}
+
+	/* Registered before the dispatch, requests that can run start from within it */
+	Request->CorrelationId = CorrelationId;
+	ScheduledRequests.Add(CorrelationId, Request);
+
+	RequestScheduler->Dispatch();
+
+	/* Still registered and not running means it waits for its lane or category */
+	if (ScheduledRequests.Contains(CorrelationId) && !RequestScheduler->IsRunning(CorrelationId))
+	{
+		UE_LOG(LogEnhancedSubsystem, Log, TEXT("Queued %s request %llu behind %d running requests, %d requests are waiting."),
+			*UEnum::GetDisplayValueAsText(Category).ToString(), CorrelationId, RequestScheduler->GetNumRunning(Category), RequestScheduler->GetNumQueued(Category));
+	}
+
+	return CorrelationId;
+}
+
+void UEnhancedOnlineSessionsSubsystem::CompleteScheduledRequest(const uint64 CorrelationId)
+{
+	if (CorrelationId == 0)
+	{
+		return;
+	}
+
+	TObjectPtr<UEnhancedOnlineRequestBase> Request;
+	if (ScheduledRequests.RemoveAndCopyValue(CorrelationId, Request) && Request)
+	{
+		Request->CorrelationId = 0;
+	}
+
+	/* Starts the next request of the lane, which may complete before this returns */
+	if (RequestScheduler.IsValid())
+	{
+		RequestScheduler->Complete(CorrelationId);
+	}
+}
@@ -0,0 +1,795 @@
+// Copyright © 2024 MajorT. All rights reserved.
+
+#include "EnhancedOnlineSessionsSubsystem.h"
+
+#include "EnhancedOnlineRequests.h"
+#include "EnhancedOnlineSubsystem.h"
+#include "OnlineSessionSettings.h"
+#include "OnlineSubsystemUtils.h"
+#include "Interfaces/OnlineSessionInterface.h"
+#include "Kismet/GameplayStatics.h"
+
+void UEnhancedOnlineSessionsSubsystem::FindOnlineSessions(UEnhancedOnlineRequest_FindSessions* Request)
+{
+	if (Request == nullptr)
+	{
+		UE_LOG(LogEnhancedSubsystem, Error, TEXT("Find Online Sessions was called with a bad request."));
+		return;
+	}
+
+	APlayerController* PlayerController = UGameplayStatics::GetPlayerController(Request->GetWorld(), Request->LocalUserIndex);
+	if (PlayerController == nullptr)
+	{
+		UE_LOG(LogEnhancedSubsystem, Error, TEXT("Find Online Sessions was called with a bad local user index."));
+		Request->OnRequestFailedDelegate.Broadcast(TEXT("Find Online Sessions was called with a bad local user index."));
+		return;
+	}
+
+	ULocalPlayer* LocalPlayer = PlayerController->GetLocalPlayer();
+	if (LocalPlayer == nullptr)
+	{
+		UE_LOG(LogEnhancedSubsystem, Error, TEXT("Find Online Sessions was called with a bad local user index: %d."), Request->LocalUserIndex);
+		Request->OnRequestFailedDelegate.Broadcast(FString::Printf(TEXT("Find Online Sessions was called with a bad local user index: %d."), Request->LocalUserIndex));
+		return;
+	}
+
+	FindOnlineSessionsInternal(LocalPlayer, Request);
+}
+
+void UEnhancedOnlineSessionsSubsystem::FindOnlineSessionsInternal(ULocalPlayer* LocalPlayer, UEnhancedOnlineRequest_FindSessions* Request)
+{
+	if (Request->bFederatedSearch && Request->PendingFederatedQueries > 0)
+	{
+		UE_LOG(LogEnhancedSubsystem, Warning, TEXT("Find Online Sessions was called twice with the same federated request."));
+		return;
+	}
+
+	/* The batches streamed to a previous search of a reused request are replaced by this one */
+	for (UEnhancedSessionSearchResult* Result : Request->StreamedResults)
+	{
+		ReleaseSearchResult(Result);
+	}
+	Request->StreamedResults.Reset();
+
+	if (!Request->bFederatedSearch)
+	{
+		RequestSessionSearch(Request, FEnhancedOnlineSearchSettings::MakeQuery(Request));
+		return;
+	}
+
+	/* Drop whatever a previous federated search of a reused request left behind */
+	for (UEnhancedSessionSearchResult* Result : Request->FederatedResults)
+	{
+		ReleaseSearchResult(Result);
+	}
+	Request->FederatedResults.Reset();
+
+	/* Both queries go through the search queue, they overlap as far as the concurrent search limit allows */
+	const EEnhancedSessionOnlineMode FederatedModes[] = { EEnhancedSessionOnlineMode::LAN, EEnhancedSessionOnlineMode::Online };
+
+	Request->PendingFederatedQueries = UE_ARRAY_COUNT(FederatedModes);
+	Request->bFederatedQuerySucceeded = false;
+
+	for (const EEnhancedSessionOnlineMode FederatedMode : FederatedModes)
+	{
+		RequestSessionSearch(Request, FEnhancedOnlineSearchSettings::MakeQuery(Request, FederatedMode));
+	}
+}
+
+void UEnhancedOnlineSessionsSubsystem::RequestSessionSearch(UEnhancedOnlineRequest_FindSessions* Request, const FEnhancedSessionSearchQuery& Query)
+{
+	if (Request->bAllowCachedResults && ServeCachedSessionSearch(Request, Query))
+	{
+		return;
+	}
+
+	/* Merge identical queries into the search that is already running or queued */
+	if (TSharedPtr<FEnhancedOnlineSearchSettings> PendingSearch = FindPendingSessionSearch(Query))
+	{
+		if (PendingSearch->Requests.Contains(Request))
+		{
+			UE_LOG(LogEnhancedSubsystem, Warning, TEXT("Find Online Sessions was called twice with the same request."));
+			return;
+		}
+
+		UE_LOG(LogEnhancedSubsystem, Log, TEXT("Merging search %s into a pending search."), *Query.ToString());
+		PendingSearch->Requests.Add(Request);
+
+		/* Catch the request up with the results the search already streamed */
+		if (Request->bStreamResults)
+		{
+			if (PendingSearch->MaterializedResults.Num() > 0)
+			{
+				StreamSearchResultsBatch(Request, PendingSearch->MaterializedResults);
+			}
+			UpdateSessionSearchStreaming();
+		}
+		return;
+	}
+
+	TSharedRef<FEnhancedOnlineSearchSettings> Search = MakeShared<FEnhancedOnlineSearchSettings>(Query);
+	Search->Requests.Add(Request);
+
+	EnqueueSessionSearch(Search);
+}
+
+void UEnhancedOnlineSessionsSubsystem::RequestRawSessionSearch(const FEnhancedSessionSearchQuery& Query, const FOnEnhancedRawSessionSearchCompleted::FDelegate& Listener)
+{
+	if (TSharedPtr<FEnhancedOnlineSearchSettings> PendingSearch = FindPendingSessionSearch(Query))
+	{
+		UE_LOG(LogEnhancedSubsystem, Log, TEXT("Listening to the pending search %s."), *Query.ToString());
+		PendingSearch->OnRawSearchCompleted.Add(Listener);
+		return;
+	}
+
+	TSharedRef<FEnhancedOnlineSearchSettings> Search = MakeShared<FEnhancedOnlineSearchSettings>(Query);
+	Search->OnRawSearchCompleted.Add(Listener);
+	Search->bRawResultsOnly = true;
+
+	EnqueueSessionSearch(Search);
+}
+
+void UEnhancedOnlineSessionsSubsystem::EnqueueSessionSearch(const TSharedRef<FEnhancedOnlineSearchSettings>& Search)
+{
+	if (ActiveSearches.Num() >= FMath::Max(MaxConcurrentSearches, 1))
+	{
+		UE_LOG(LogEnhancedSubsystem, Log, TEXT("Queueing search %s, %d searches are already running."), *Search->Query.ToString(), ActiveSearches.Num());
+		QueuedSearches.Add(Search);
+		return;
+	}
+
+	StartSessionSearch(Search);
+}
+
+TSharedPtr<FEnhancedOnlineSearchSettings> UEnhancedOnlineSessionsSubsystem::FindPendingSessionSearch(const FEnhancedSessionSearchQuery& Query) const
+{
+	if (const TSharedPtr<FEnhancedOnlineSearchSettings>* ActiveSearch = ActiveSearches.Find(Query))
+	{
+		return *ActiveSearch;
+	}
+
+	for (const TSharedPtr<FEnhancedOnlineSearchSettings>& QueuedSearch : QueuedSearches)
+	{
+		if (QueuedSearch->Query == Query)
+		{
+			return QueuedSearch;
+		}
+	}
+
+	return nullptr;
+}
+
+void UEnhancedOnlineSessionsSubsystem::StartSessionSearch(const TSharedRef<FEnhancedOnlineSearchSettings>& Search)
+{
+	IOnlineSessionPtr Sessions = Online::GetSessionInterface(GetWorld());
+	if (!Sessions.IsValid())
+	{
+		UE_LOG(LogEnhancedSubsystem, Error, TEXT("Failed to find sessions, no session interface available."));
+		CompleteSessionSearch(Search, false);
+		return;
+	}
+
+	/* A single delegate serves every running search, completions are routed by their search state */
+	if (!FindSessionsDelegateHandle.IsValid())
+	{
+		FindSessionsDelegateHandle = Sessions->AddOnFindSessionsCompleteDelegate_Handle(FOnFindSessionsCompleteDelegate::CreateUObject(this, &ThisClass::HandleFindOnlineSessionsComplete));
+	}
+
+	ActiveSearches.Add(Search->Query, Search);
+
+	UE_LOG(LogEnhancedSubsystem, Log, TEXT("Starting search %s for %d request(s)."), *Search->Query.ToString(), Search->Requests.Num());
+
+	UpdateSessionSearchStreaming();
+
+	if (!Sessions->FindSessions(0, Search))
+	{
+		UE_LOG(LogEnhancedSubsystem, Error, TEXT("Failed to find sessions. :("));
+
+		/* The backend may have already completed the search synchronously */
+		if (ActiveSearches.Remove(Search->Query) > 0)
+		{
+			CompleteSessionSearch(Search, false);
+		}
+
+		if (ActiveSearches.IsEmpty())
+		{
+			Sessions->ClearOnFindSessionsCompleteDelegate_Handle(FindSessionsDelegateHandle);
+			FindSessionsDelegateHandle.Reset();
+		}
+	}
+}
+
+void UEnhancedOnlineSessionsSubsystem::StartQueuedSessionSearches()
+{
+	while (QueuedSearches.Num() > 0 && ActiveSearches.Num() < FMath::Max(MaxConcurrentSearches, 1))
+	{
+		TSharedPtr<FEnhancedOnlineSearchSettings> NextSearch = QueuedSearches[0];
+		QueuedSearches.RemoveAt(0);
+
+		StartSessionSearch(NextSearch.ToSharedRef());
+	}
+}
+
+void UEnhancedOnlineSessionsSubsystem::HandleFindOnlineSessionsComplete(bool bWasSuccessful)
+{
+	/* The delegate doesn't tell which search finished, so route it to every search that left the in progress state */
+	TArray<TSharedPtr<FEnhancedOnlineSearchSettings>> CompletedSearches;
+	for (const TPair<FEnhancedSessionSearchQuery, TSharedPtr<FEnhancedOnlineSearchSettings>>& Pair : ActiveSearches)
+	{
+		if (Pair.Value->SearchState != EOnlineAsyncTaskState::InProgress)
+		{
+			CompletedSearches.Add(Pair.Value);
+		}
+	}
+
+	/* Some backends don't update the search state, with a single search running there's no ambiguity */
+	if (CompletedSearches.IsEmpty() && ActiveSearches.Num() == 1)
+	{
+		for (const TPair<FEnhancedSessionSearchQuery, TSharedPtr<FEnhancedOnlineSearchSettings>>& Pair : ActiveSearches)
+		{
+			CompletedSearches.Add(Pair.Value);
+		}
+	}
+
+	if (CompletedSearches.IsEmpty())
+	{
+		UE_LOG(LogEnhancedSubsystem, Error, TEXT("Invalid search settings. Did we lose a reference? :("));
+		return;
+	}
+
+	for (const TSharedPtr<FEnhancedOnlineSearchSettings>& Search : CompletedSearches)
+	{
+		ActiveSearches.Remove(Search->Query);
+
+		bool bSearchSucceeded = bWasSuccessful;
+		if (Search->SearchState == EOnlineAsyncTaskState::Done)
+		{
+			bSearchSucceeded = true;
+		}
+		else if (Search->SearchState == EOnlineAsyncTaskState::Failed)
+		{
+			bSearchSucceeded = false;
+		}
+
+		CompleteSessionSearch(Search.ToSharedRef(), bSearchSucceeded);
+	}
+
+	if (ActiveSearches.IsEmpty())
+	{
+		if (IOnlineSessionPtr Sessions = Online::GetSessionInterface(GetWorld()))
+		{
+			Sessions->ClearOnFindSessionsCompleteDelegate_Handle(FindSessionsDelegateHandle);
+		}
+		FindSessionsDelegateHandle.Reset();
+	}
+
+	StartQueuedSessionSearches();
+}
+
+void UEnhancedOnlineSessionsSubsystem::CompleteSessionSearch(const TSharedRef<FEnhancedOnlineSearchSettings>& Search, bool bWasSuccessful)
+{
+	if (bWasSuccessful)
+	{
+		UE_LOG(LogEnhancedSubsystem, Log, TEXT("Found %d sessions for search %s."), Search->SearchResults.Num(), *Search->Query.ToString());
+
+		Search->OnRawSearchCompleted.Broadcast(Search->SearchResults, true);
+		Search->OnRawSearchCompleted.Clear();
+
+		/* Nobody needs result objects, skip creating them and don't cache the results */
+		if (Search->bRawResultsOnly && Search->Requests.IsEmpty())
+		{
+			return;
+		}
+
+		/* Streaming requests receive whatever arrived since the last poll as their final batch */
+		const TArray<UEnhancedSessionSearchResult*> FinalBatch = MaterializeSessionSearchResults(*Search);
+		if (FinalBatch.Num() > 0)
+		{
+			for (UEnhancedOnlineRequest_FindSessions* Request : Search->Requests)
+			{
+				if (Request->bStreamResults)
+				{
+					StreamSearchResultsBatch(Request, FinalBatch);
+				}
+			}
+		}
+
+		/* Measuring the ping delays the delivery until every probe replied or timed out */
+		if (Search->HasPingMeasuringRequests() && StartSessionSearchQos(Search))
+		{
+			return;
+		}
+
+		FinishSessionSearch(Search);
+		return;
+	}
+
+	UE_LOG(LogEnhancedSubsystem, Error, TEXT("Failed to find sessions. :("));
+
+	Search->OnRawSearchCompleted.Broadcast(Search->SearchResults, false);
+	Search->OnRawSearchCompleted.Clear();
+
+	for (UEnhancedOnlineRequest_FindSessions* Request : Search->Requests)
+	{
+		FailSessionSearchRequest(Request, TEXT("Failed to find sessions. :("));
+	}
+	Search->Requests.Empty();
+
+	for (UEnhancedSessionSearchResult* Result : Search->MaterializedResults)
+	{
+		ReleaseSearchResult(Result);
+	}
+	Search->MaterializedResults.Empty();
+	Search->MaterializedSessionIds.Empty();
+}
+
+void UEnhancedOnlineSessionsSubsystem::FinishSessionSearch(const TSharedRef<FEnhancedOnlineSearchSettings>& Search)
+{
+	const TArray<UEnhancedSessionSearchResult*> Results(Search->MaterializedResults);
+
+	StoreSessionSearchResults(Search->Query, Results);
+
+	for (UEnhancedOnlineRequest_FindSessions* Request : Search->Requests)
+	{
+		DeliverSessionSearchResults(Request, Results);
+	}
+	Search->Requests.Empty();
+
+	/* The search is done, the cache and the requests now own the results */
+	for (UEnhancedSessionSearchResult* Result : Search->MaterializedResults)
+	{
+		ReleaseSearchResult(Result);
+	}
+	Search->MaterializedResults.Empty();
+	Search->MaterializedSessionIds.Empty();
+}
+
+TArray<UEnhancedSessionSearchResult*> UEnhancedOnlineSessionsSubsystem::MaterializeSessionSearchResults(FEnhancedOnlineSearchSettings& Search)
+{
+	TArray<UEnhancedSessionSearchResult*> NewResults;
+
+	/* Some backends rebuild or reorder their result list, so rows are matched by their session id instead of their position */
+	TMap<FString, UEnhancedSessionSearchResult*> PreviousResults;
+	PreviousResults.Reserve(Search.MaterializedResults.Num());
+	for (int32 Index = 0; Index < Search.MaterializedResults.Num(); ++Index)
+	{
+		PreviousResults.Add(Search.MaterializedSessionIds[Index], Search.MaterializedResults[Index]);
+	}
+
+	Search.MaterializedResults.Reset();
+	Search.MaterializedSessionIds.Reset();
+
+	TSet<FString> SeenSessionIds;
+	SeenSessionIds.Reserve(Search.SearchResults.Num());
+
+	for (int32 Index = 0; Index < Search.SearchResults.Num(); ++Index)
+	{
+		const FOnlineSessionSearchResult& SearchResult = Search.SearchResults[Index];
+
+		FString SessionId = UEnhancedSessionSearchResult::GetSessionId(SearchResult);
+		if (SessionId.IsEmpty())
+		{
+			SessionId = FString::Printf(TEXT("#%d"), Index);
+		}
+
+		/* A session listed twice keeps its first row */
+		bool bIsDuplicate = false;
+		SeenSessionIds.Add(SessionId, &bIsDuplicate);
+		if (bIsDuplicate)
+		{
+			continue;
+		}
+
+		UEnhancedSessionSearchResult* KnownResult = nullptr;
+		if (PreviousResults.RemoveAndCopyValue(SessionId, KnownResult))
+		{
+			Search.MaterializedResults.Add(KnownResult);
+			Search.MaterializedSessionIds.Add(SessionId);
+			continue;
+		}
+
+		UEnhancedSessionSearchResult* NewResult = AcquireSearchResult(SearchResult);
+		Search.MaterializedResults.Add(NewResult);
+		Search.MaterializedSessionIds.Add(SessionId);
+		NewResults.Add(NewResult);
+
+		FString OwningUserId = TEXT("Uknown");
+		if (SearchResult.Session.OwningUserId.IsValid())
+		{
+			OwningUserId = SearchResult.Session.OwningUserId->ToString();
+		}
+
+		UE_LOG(LogEnhancedSubsystem, Log, TEXT("\tFound session (UserId: %s, UserName: %s, NumOpenPrivConns: %d, NumOpenPubConns: %d, Ping: %d ms"),
+		*OwningUserId,
+		*SearchResult.Session.OwningUserName,
+		SearchResult.Session.NumOpenPrivateConnections,
+		SearchResult.Session.NumOpenPublicConnections,
+		SearchResult.PingInMs);
+	}
+
+	/* Sessions that left the list are only dropped by the search, listeners that received them keep their objects */
+	for (const TPair<FString, UEnhancedSessionSearchResult*>& Pair : PreviousResults)
+	{
+		ReleaseSearchResult(Pair.Value);
+	}
+
+	return NewResults;
+}
+
+void UEnhancedOnlineSessionsSubsystem::UpdateSessionSearchStreaming()
+{
+	if (SearchStreamingTickerHandle.IsValid())
+	{
+		return;
+	}
+
+	for (const TPair<FEnhancedSessionSearchQuery, TSharedPtr<FEnhancedOnlineSearchSettings>>& Pair : ActiveSearches)
+	{
+		if (Pair.Value->HasStreamingRequests())
+		{
+			SearchStreamingTickerHandle = FTSTicker::GetCoreTicker().AddTicker(
+				FTickerDelegate::CreateUObject(this, &ThisClass::TickSessionSearchStreaming), FMath::Max(SearchStreamingInterval, 0.f));
+			return;
+		}
+	}
+}
+
+bool UEnhancedOnlineSessionsSubsystem::TickSessionSearchStreaming(float DeltaTime)
+{
+	bool bHasStreamingSearches = false;
+
+	/* Copy the searches, a batch callback may start or complete searches */
+	TArray<TSharedPtr<FEnhancedOnlineSearchSettings>> Searches;
+	ActiveSearches.GenerateValueArray(Searches);
+
+	for (const TSharedPtr<FEnhancedOnlineSearchSettings>& Search : Searches)
+	{
+		if (!Search->HasStreamingRequests())
+		{
+			continue;
+		}
+
+		bHasStreamingSearches = true;
+
+		const TArray<UEnhancedSessionSearchResult*> Batch = MaterializeSessionSearchResults(*Search);
+		if (Batch.Num() == 0)
+		{
+			continue;
+		}
+
+		UE_LOG(LogEnhancedSubsystem, Verbose, TEXT("Streaming %d new sessions for search %s."), Batch.Num(), *Search->Query.ToString());
+
+		const TArray<TObjectPtr<UEnhancedOnlineRequest_FindSessions>> Requests = Search->Requests;
+		for (UEnhancedOnlineRequest_FindSessions* Request : Requests)
+		{
+			if (Request->bStreamResults)
+			{
+				StreamSearchResultsBatch(Request, Batch);
+			}
+		}
+	}
+
+	if (!bHasStreamingSearches)
+	{
+		SearchStreamingTickerHandle.Reset();
+	}
+
+	return bHasStreamingSearches;
+}
+
+void UEnhancedOnlineSessionsSubsystem::FailSessionSearchRequest(UEnhancedOnlineRequest_FindSessions* Request, const FString& Reason)
+{
+	if (Request->PendingFederatedQueries > 0)
+	{
+		CompleteFederatedSessionSearch(Request, nullptr);
+		return;
+	}
+
+	Request->OnRequestFailedDelegate.Broadcast(Reason);
+	Request->CompleteRequest();
+}
+
+void UEnhancedOnlineSessionsSubsystem::CompleteFederatedSessionSearch(UEnhancedOnlineRequest_FindSessions* Request, const TArray<UEnhancedSessionSearchResult*>* Results)
+{
+	Request->PendingFederatedQueries--;
+
+	if (Results != nullptr)
+	{
+		Request->bFederatedQuerySucceeded = true;
+
+		for (UEnhancedSessionSearchResult* Result : *Results)
+		{
+			RetainSearchResult(Result);
+		}
+		Request->FederatedResults.Append(*Results);
+	}
+
+	if (Request->PendingFederatedQueries > 0)
+	{
+		return;
+	}
+
+	/* The request owns the collected results until they are delivered */
+	const TArray<UEnhancedSessionSearchResult*> CollectedResults(Request->FederatedResults);
+	Request->FederatedResults.Reset();
+
+	if (!Request->bFederatedQuerySucceeded)
+	{
+		FailSessionSearchRequest(Request, TEXT("Failed to find sessions on LAN and online. :("));
+	}
+	else
+	{
+		/* The same session can show up on LAN and online, keep the copy with the lowest ping */
+		TMap<FString, UEnhancedSessionSearchResult*> ResultsBySessionId;
+		ResultsBySessionId.Reserve(CollectedResults.Num());
+
+		TArray<UEnhancedSessionSearchResult*> MergedResults;
+		MergedResults.Reserve(CollectedResults.Num());
+
+		for (UEnhancedSessionSearchResult* Result : CollectedResults)
+		{
+			const FString& SessionId = Result->GetAttributes().SessionId;
+			if (SessionId.IsEmpty())
+			{
+				MergedResults.Add(Result);
+				continue;
+			}
+
+			UEnhancedSessionSearchResult*& KnownResult = ResultsBySessionId.FindOrAdd(SessionId);
+			if (KnownResult == nullptr)
+			{
+				KnownResult = Result;
+				MergedResults.Add(Result);
+			}
+			else if (Result->GetPingInMs() < KnownResult->GetPingInMs())
+			{
+				MergedResults[MergedResults.IndexOfByKey(KnownResult)] = Result;
+				KnownResult = Result;
+			}
+		}
+
+		MergedResults.StableSort([](const UEnhancedSessionSearchResult& A, const UEnhancedSessionSearchResult& B)
+		{
+			return A.GetPingInMs() < B.GetPingInMs();
+		});
+
+		if (Request->MaxSearchResults > 0 && MergedResults.Num() > Request->MaxSearchResults)
+		{
+			MergedResults.SetNum(Request->MaxSearchResults, false);
+		}
+
+		UE_LOG(LogEnhancedSubsystem, Log, TEXT("Merged %d federated sessions into %d unique sessions."), CollectedResults.Num(), MergedResults.Num());
+
+		DeliverSessionSearchResults(Request, MergedResults);
+	}
+
+	for (UEnhancedSessionSearchResult* Result : CollectedResults)
+	{
+		ReleaseSearchResult(Result);
+	}
+}
+
+void UEnhancedOnlineSessionsSubsystem::DeliverSessionSearchResults(UEnhancedOnlineRequest_FindSessions* Request, const TArray<UEnhancedSessionSearchResult*>& InResults)
+{
+	/* Federated requests collect the results of every query before anything is delivered */
+	if (Request->PendingFederatedQueries > 0)
+	{
+		CompleteFederatedSessionSearch(Request, &InResults);
+		return;
+	}
+
+	/* Requests merged into the same search can have different filters, so filter per request */
+	TArray<UEnhancedSessionSearchResult*> FilteredResults;
+	if (Request->ResultFilter.IsActive())
+	{
+		FEnhancedSessionSearchColumns::FilterAndSort(InResults, Request->ResultFilter, FilteredResults);
+	}
+	const TArray<UEnhancedSessionSearchResult*>& Results = Request->ResultFilter.IsActive() ? FilteredResults : InResults;
+
+	/* Retain the new results first, they may overlap with the previous ones */
+	for (UEnhancedSessionSearchResult* Result : Results)
+	{
+		RetainSearchResult(Result);
+	}
+
+	/* The previous results of a reused request are replaced, so they can go back to the pool */
+	for (UEnhancedSessionSearchResult* Result : Request->SearchResults)
+	{
+		ReleaseSearchResult(Result);
+	}
+
+	Request->SearchResults.Reset();
+	Request->SearchResults.Append(Results);
+
+	Request->OnFindOnlineSessionsCompleted.Broadcast(Results);
+	Request->CompleteRequest();
+}
+
+bool UEnhancedOnlineSessionsSubsystem::ServeCachedSessionSearch(UEnhancedOnlineRequest_FindSessions* Request, const FEnhancedSessionSearchQuery& Query)
+{
+	if (!SearchCache.IsValid() || SearchCacheTimeToLive <= 0.f)
+	{
+		return false;
+	}
+
+	const FEnhancedSessionSearchCacheEntry* Entry = SearchCache->Entries.Find(Query);
+	if (Entry == nullptr)
+	{
+		return false;
+	}
+
+	const double Age = FPlatformTime::Seconds() - Entry->Timestamp;
+	if (Age > SearchCacheTimeToLive + FMath::Max(SearchCacheStaleWindow, 0.f))
+	{
+		for (UEnhancedSessionSearchResult* Result : Entry->Results)
+		{
+			ReleaseSearchResult(Result);
+		}
+		SearchCache->Entries.Remove(Query);
+		return false;
+	}
+
+	/* Copy and retain the results, delivering them may start a new search that replaces the entry */
+	const TArray<UEnhancedSessionSearchResult*> Results(Entry->Results);
+	const bool bIsStale = Age > SearchCacheTimeToLive;
+
+	for (UEnhancedSessionSearchResult* Result : Results)
+	{
+		RetainSearchResult(Result);
+	}
+
+	UE_LOG(LogEnhancedSubsystem, Log, TEXT("Serving %d cached sessions for search %s (Age: %.2fs%s)."),
+		Results.Num(), *Query.ToString(), Age, bIsStale ? TEXT(", refreshing") : TEXT(""));
+
+	if (Request->bStreamResults && Results.Num() > 0)
+	{
+		StreamSearchResultsBatch(Request, Results);
+	}
+
+	/* Stale while revalidate: serve the stale results right away and refresh them in the background */
+	if (bIsStale)
+	{
+		RevalidateSessionSearch(Query);
+	}
+
+	DeliverSessionSearchResults(Request, Results);
+
+	for (UEnhancedSessionSearchResult* Result : Results)
+	{
+		ReleaseSearchResult(Result);
+	}
+	return true;
+}
+
+void UEnhancedOnlineSessionsSubsystem::RevalidateSessionSearch(const FEnhancedSessionSearchQuery& Query)
+{
+	if (TSharedPtr<FEnhancedOnlineSearchSettings> PendingSearch = FindPendingSessionSearch(Query))
+	{
+		/* The pending search refreshes the cache, even if it was only started for raw listeners */
+		PendingSearch->bRawResultsOnly = false;
+		return;
+	}
+
+	/* A search without requests only refreshes the cache */
+	EnqueueSessionSearch(MakeShared<FEnhancedOnlineSearchSettings>(Query));
+}
+
+void UEnhancedOnlineSessionsSubsystem::StoreSessionSearchResults(const FEnhancedSessionSearchQuery& Query, const TArray<UEnhancedSessionSearchResult*>& Results)
+{
+	if (!SearchCache.IsValid() || SearchCacheTimeToLive <= 0.f)
+	{
+		return;
+	}
+
+	const double Now = FPlatformTime::Seconds();
+	const double MaxAge = SearchCacheTimeToLive + FMath::Max(SearchCacheStaleWindow, 0.f);
+
+	/* Drop entries that are too old to be served anymore */
+	for (auto It = SearchCache->Entries.CreateIterator(); It; ++It)
+	{
+		if (Now - It.Value().Timestamp > MaxAge)
+		{
+			for (UEnhancedSessionSearchResult* Result : It.Value().Results)
+			{
+				ReleaseSearchResult(Result);
+			}
+			It.RemoveCurrent();
+		}
+	}
+
+	for (UEnhancedSessionSearchResult* Result : Results)
+	{
+		RetainSearchResult(Result);
+	}
+
+	FEnhancedSessionSearchCacheEntry& Entry = SearchCache->Entries.FindOrAdd(Query);
+	for (UEnhancedSessionSearchResult* Result : Entry.Results)
+	{
+		ReleaseSearchResult(Result);
+	}
+	Entry.Results.Reset();
+	Entry.Results.Append(Results);
+	Entry.Timestamp = Now;
+}
+
+void UEnhancedOnlineSessionsSubsystem::ClearSessionSearchCache()
+{
+	if (SearchCache.IsValid())
+	{
+		for (const TPair<FEnhancedSessionSearchQuery, FEnhancedSessionSearchCacheEntry>& Pair : SearchCache->Entries)
+		{
+			for (UEnhancedSessionSearchResult* Result : Pair.Value.Results)
+			{
+				ReleaseSearchResult(Result);
+			}
+		}
+		SearchCache->Entries.Empty();
+	}
+}
+
+UEnhancedSessionSearchResult* UEnhancedOnlineSessionsSubsystem::AcquireSearchResult(const FOnlineSessionSearchResult& SearchResult)
+{
+	UEnhancedSessionSearchResult* Result = nullptr;
+
+	if (FreeSearchResults.Num() > 0)
+	{
+		Result = FreeSearchResults.Pop(false);
+		SearchResultPoolStats.Hits++;
+	}
+	else
+	{
+		Result = NewObject<UEnhancedSessionSearchResult>(this);
+		SearchResultPoolStats.Misses++;
+	}
+
+	Result->InitializeSearchResult(SearchResult);
+	Result->PoolReferenceCount = 1;
+
+	return Result;
+}
+
+void UEnhancedOnlineSessionsSubsystem::RetainSearchResult(UEnhancedSessionSearchResult* Result)
+{
+	if (Result)
+	{
+		Result->PoolReferenceCount++;
+	}
+}
+
+void UEnhancedOnlineSessionsSubsystem::ReleaseSearchResult(UEnhancedSessionSearchResult* Result)
+{
+	if (Result == nullptr || Result->PoolReferenceCount <= 0)
+	{
+		return;
+	}
+
+	if (--Result->PoolReferenceCount > 0)
+	{
+		return;
+	}
+
+	/* Results beyond the pool's capacity are left to the garbage collector */
+	if (FreeSearchResults.Num() < MaxPooledSearchResults && Result->GetOuter() == this)
+	{
+		FreeSearchResults.Add(Result);
+		SearchResultPoolStats.Recycled++;
+	}
+}
+
+void UEnhancedOnlineSessionsSubsystem::StreamSearchResultsBatch(UEnhancedOnlineRequest_FindSessions* Request, const TArray<UEnhancedSessionSearchResult*>& Batch)
+{
+	for (UEnhancedSessionSearchResult* Result : Batch)
+	{
+		RetainSearchResult(Result);
+	}
+	Request->StreamedResults.Append(Batch);
+
+	Request->OnSearchResultsBatchReceived.Broadcast(Batch);
+}
+
+FEnhancedSearchResultPoolStats UEnhancedOnlineSessionsSubsystem::GetSearchResultPoolStats() const
+{
+	FEnhancedSearchResultPoolStats Stats = SearchResultPoolStats;
+	Stats.Pooled = FreeSearchResults.Num();
+	return Stats;
+}
@@ -0,0 +1,270 @@
+// Copyright © 2024 MajorT. All rights reserved.
+
+#include "EnhancedOnlineSessionsSubsystem.h"
+
+#include "EnhancedOnlineRequests.h"
+#include "EnhancedOnlineSubsystem.h"
+#include "OnlineSessionSettings.h"
+#include "Kismet/GameplayStatics.h"
+
+void UEnhancedOnlineSessionsSubsystem::FindOnlineSessionsPage(UEnhancedOnlineRequest_FindSessionsPage* Request)
+{
+	if (Request == nullptr)
+	{
+		UE_LOG(LogEnhancedSubsystem, Error, TEXT("Find Online Sessions Page was called with a bad request."));
+		return;
+	}
+
+	APlayerController* PlayerController = UGameplayStatics::GetPlayerController(Request->GetWorld(), Request->LocalUserIndex);
+	if (PlayerController == nullptr)
+	{
+		UE_LOG(LogEnhancedSubsystem, Error, TEXT("Find Online Sessions Page was called with a bad local user index."));
+		Request->OnRequestFailedDelegate.Broadcast(TEXT("Find Online Sessions Page was called with a bad local user index."));
+		return;
+	}
+
+	ULocalPlayer* LocalPlayer = PlayerController->GetLocalPlayer();
+	if (LocalPlayer == nullptr)
+	{
+		UE_LOG(LogEnhancedSubsystem, Error, TEXT("Find Online Sessions Page was called with a bad local user index: %d."), Request->LocalUserIndex);
+		Request->OnRequestFailedDelegate.Broadcast(FString::Printf(TEXT("Find Online Sessions Page was called with a bad local user index: %d."), Request->LocalUserIndex));
+		return;
+	}
+
+	FindOnlineSessionsPageInternal(LocalPlayer, Request);
+}
+
+void UEnhancedOnlineSessionsSubsystem::FindOnlineSessionsPageInternal(ULocalPlayer* LocalPlayer, UEnhancedOnlineRequest_FindSessionsPage* Request)
+{
+	if (Request->PageSize <= 0)
+	{
+		FailSearchSnapshotPage(Request, FString::Printf(TEXT("Find Online Sessions Page was called with a bad page size: %d."), Request->PageSize));
+		return;
+	}
+
+	if (PendingPageRequests.Contains(Request))
+	{
+		UE_LOG(LogEnhancedSubsystem, Warning, TEXT("Find Online Sessions Page was called twice with the same request."));
+		return;
+	}
+
+	PruneSearchSnapshots();
+
+	int32 SnapshotId = Request->Cursor.SnapshotId;
+
+	/* A default cursor starts a new search */
+	if (!Request->Cursor.IsValid())
+	{
+		SnapshotId = NextSearchSnapshotId++;
+
+		TSharedRef<FEnhancedSessionSearchSnapshot> NewSnapshot = MakeShared<FEnhancedSessionSearchSnapshot>();
+		NewSnapshot->Query = FEnhancedSessionSearchQuery(Request->OnlineMode, Request->bFindLobbies, Request->SearchKeyword, 0);
+		NewSnapshot->LastAccessTime = FPlatformTime::Seconds();
+		SearchSnapshots.Add(SnapshotId, NewSnapshot);
+
+		PruneSearchSnapshots();
+	}
+
+	TSharedPtr<FEnhancedSessionSearchSnapshot> Snapshot = SearchSnapshots.FindRef(SnapshotId);
+	if (!Snapshot.IsValid())
+	{
+		FailSearchSnapshotPage(Request, TEXT("The search cursor expired, start a new search."));
+		return;
+	}
+
+	Snapshot->LastAccessTime = FPlatformTime::Seconds();
+	Request->PageCursor = FEnhancedSessionSearchCursor(SnapshotId, FMath::Max(Request->Cursor.Offset, 0));
+
+	const int32 RowsNeeded = Request->PageCursor.Offset + Request->PageSize;
+	if (Snapshot->Rows.Num() >= RowsNeeded || Snapshot->bIsExhausted)
+	{
+		ServeSearchSnapshotPage(Request, *Snapshot);
+		return;
+	}
+
+	PendingPageRequests.Add(Request);
+
+	/* Fetch the page and the one after it in one go */
+	FetchSearchSnapshot(SnapshotId, RowsNeeded + Request->PageSize);
+}
+
+void UEnhancedOnlineSessionsSubsystem::FetchSearchSnapshot(int32 SnapshotId, int32 NumRows)
+{
+	TSharedPtr<FEnhancedSessionSearchSnapshot> Snapshot = SearchSnapshots.FindRef(SnapshotId);
+
+	/* A running fetch is never interrupted, rows still missing afterwards are fetched when it completes */
+	if (!Snapshot.IsValid() || Snapshot->FetchingRows > 0)
+	{
+		return;
+	}
+
+	Snapshot->FetchingRows = NumRows;
+
+	UE_LOG(LogEnhancedSubsystem, Log, TEXT("Fetching %d sessions for search snapshot %d."), NumRows, SnapshotId);
+
+	const FEnhancedSessionSearchQuery Query(Snapshot->Query.OnlineMode, Snapshot->Query.bFindLobbies, Snapshot->Query.SearchKeyword, NumRows);
+	RequestRawSessionSearch(Query, FOnEnhancedRawSessionSearchCompleted::FDelegate::CreateUObject(this, &ThisClass::HandleSearchSnapshotFetched, SnapshotId));
+}
+
+void UEnhancedOnlineSessionsSubsystem::HandleSearchSnapshotFetched(const TArray<FOnlineSessionSearchResult>& SearchResults, bool bWasSuccessful, int32 SnapshotId)
+{
+	TSharedPtr<FEnhancedSessionSearchSnapshot> Snapshot = SearchSnapshots.FindRef(SnapshotId);
+	if (!Snapshot.IsValid())
+	{
+		return;
+	}
+
+	const int32 RequestedRows = Snapshot->FetchingRows;
+	Snapshot->FetchingRows = 0;
+
+	if (bWasSuccessful)
+	{
+		/* The online service has no offsets, every fetch returns the first rows again, so only append the new sessions */
+		const int32 PreviousNumRows = Snapshot->Rows.Num();
+
+		TSet<FString> KnownRows;
+		KnownRows.Reserve(PreviousNumRows);
+		for (const FOnlineSessionSearchResult& Row : Snapshot->Rows)
+		{
+			KnownRows.Add(UEnhancedSessionSearchResult::GetSessionId(Row));
+		}
+
+		for (int32 Index = 0; Index < SearchResults.Num(); ++Index)
+		{
+			const FString RowKey = UEnhancedSessionSearchResult::GetSessionId(SearchResults[Index]);
+
+			/* Without an id, trust the position of the row */
+			const bool bIsNewRow = RowKey.IsEmpty() ? Index >= PreviousNumRows : !KnownRows.Contains(RowKey);
+			if (bIsNewRow)
+			{
+				Snapshot->Rows.Add(SearchResults[Index]);
+				KnownRows.Add(RowKey);
+			}
+		}
+
+		/* Rows the backend returns again don't count, a fetch that adds nothing would be repeated forever */
+		const bool bAddedRows = Snapshot->Rows.Num() > PreviousNumRows;
+		Snapshot->NumFetches++;
+		Snapshot->bIsExhausted = SearchResults.Num() < RequestedRows || !bAddedRows || Snapshot->NumFetches >= MaxSearchSnapshotFetches;
+
+		if (Snapshot->bIsExhausted && SearchResults.Num() >= RequestedRows)
+		{
+			UE_LOG(LogEnhancedSubsystem, Log, TEXT("Search snapshot %d stopped growing after %d fetches, treating it as exhausted."), SnapshotId, Snapshot->NumFetches);
+		}
+	}
+
+	int32 RowsToFetch = 0;
+
+	/* Copy the requests, serving a page may start another fetch */
+	const TArray<TObjectPtr<UEnhancedOnlineRequest_FindSessionsPage>> WaitingRequests = PendingPageRequests;
+	for (UEnhancedOnlineRequest_FindSessionsPage* Request : WaitingRequests)
+	{
+		if (Request->PageCursor.SnapshotId != SnapshotId)
+		{
+			continue;
+		}
+
+		if (!bWasSuccessful)
+		{
+			PendingPageRequests.Remove(Request);
+			FailSearchSnapshotPage(Request, TEXT("Failed to find sessions. :("));
+			continue;
+		}
+
+		const int32 RowsNeeded = Request->PageCursor.Offset + Request->PageSize;
+		if (Snapshot->Rows.Num() >= RowsNeeded || Snapshot->bIsExhausted)
+		{
+			PendingPageRequests.Remove(Request);
+			ServeSearchSnapshotPage(Request, *Snapshot);
+			continue;
+		}
+
+		RowsToFetch = FMath::Max(RowsToFetch, RowsNeeded + Request->PageSize);
+	}
+
+	if (RowsToFetch > 0)
+	{
+		FetchSearchSnapshot(SnapshotId, RowsToFetch);
+	}
+}
+
+void UEnhancedOnlineSessionsSubsystem::ServeSearchSnapshotPage(UEnhancedOnlineRequest_FindSessionsPage* Request, FEnhancedSessionSearchSnapshot& Snapshot)
+{
+	const int32 SnapshotId = Request->PageCursor.SnapshotId;
+	const int32 Offset = FMath::Min(Request->PageCursor.Offset, Snapshot.Rows.Num());
+	const int32 End = FMath::Min(Offset + Request->PageSize, Snapshot.Rows.Num());
+
+	/* The previous page of a reused request goes back to the pool first, so the new page can take its objects */
+	for (UEnhancedSessionSearchResult* Result : Request->SearchResults)
+	{
+		ReleaseSearchResult(Result);
+	}
+	Request->SearchResults.Reset();
+
+	/* Only the rows on the page become result objects */
+	TArray<UEnhancedSessionSearchResult*> Page;
+	Page.Reserve(End - Offset);
+	for (int32 Index = Offset; Index < End; ++Index)
+	{
+		Page.Add(AcquireSearchResult(Snapshot.Rows[Index]));
+	}
+
+	Request->SearchResults.Append(Page);
+	Request->NextCursor = FEnhancedSessionSearchCursor(SnapshotId, End);
+	Request->bHasMorePages = End < Snapshot.Rows.Num() || !Snapshot.bIsExhausted;
+
+	UE_LOG(LogEnhancedSubsystem, Log, TEXT("Serving sessions %d to %d of search snapshot %d."), Offset, End, SnapshotId);
+
+	/* Prefetch the following page while this one is shown */
+	if (!Snapshot.bIsExhausted && Snapshot.Rows.Num() < End + Request->PageSize)
+	{
+		FetchSearchSnapshot(SnapshotId, End + Request->PageSize);
+	}
+
+	Request->OnFindOnlineSessionsCompleted.Broadcast(Page);
+	Request->CompleteRequest();
+}
+
+void UEnhancedOnlineSessionsSubsystem::FailSearchSnapshotPage(UEnhancedOnlineRequest_FindSessionsPage* Request, const FString& Reason)
+{
+	UE_LOG(LogEnhancedSubsystem, Error, TEXT("%s"), *Reason);
+
+	Request->OnRequestFailedDelegate.Broadcast(Reason);
+	Request->CompleteRequest();
+}
+
+void UEnhancedOnlineSessionsSubsystem::PruneSearchSnapshots()
+{
+	const double Now = FPlatformTime::Seconds();
+
+	/* Snapshots with a running fetch are kept, their waiting requests still need them */
+	for (auto It = SearchSnapshots.CreateIterator(); It; ++It)
+	{
+		if (It.Value()->FetchingRows == 0 && Now - It.Value()->LastAccessTime > SearchSnapshotTimeToLive)
+		{
+			It.RemoveCurrent();
+		}
+	}
+
+	while (SearchSnapshots.Num() > FMath::Max(MaxSearchSnapshots, 1))
+	{
+		int32 LeastRecentlyUsedId = INDEX_NONE;
+		double LeastRecentAccessTime = TNumericLimits<double>::Max();
+
+		for (const TPair<int32, TSharedPtr<FEnhancedSessionSearchSnapshot>>& Pair : SearchSnapshots)
+		{
+			if (Pair.Value->FetchingRows == 0 && Pair.Value->LastAccessTime < LeastRecentAccessTime)
+			{
+				LeastRecentlyUsedId = Pair.Key;
+				LeastRecentAccessTime = Pair.Value->LastAccessTime;
+			}
+		}
+
+		if (LeastRecentlyUsedId == INDEX_NONE)
+		{
+			break;
+		}
+
+		SearchSnapshots.Remove(LeastRecentlyUsedId);
+	}
+}
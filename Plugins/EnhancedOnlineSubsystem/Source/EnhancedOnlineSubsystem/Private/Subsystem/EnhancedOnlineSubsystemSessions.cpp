@@ -3,9 +3,12 @@
 #include "EnhancedOnlineSessionsSubsystem.h"
 
 #include "EnhancedOnlineRequests.h"
+#include "EnhancedOnlineSettingsPublisher.h"
 #include "EnhancedOnlineSubsystem.h"
 #include "OnlineSessionSettings.h"
 #include "Interfaces/OnlineSessionInterface.h"
+#include "TimerManager.h"
+#include "Engine/GameInstance.h"
 #include "Kismet/GameplayStatics.h"
 #include "Online/OnlineSessionNames.h"
 
@@ -17,38 +20,57 @@ void UEnhancedOnlineSessionsSubsystem::HostOnlineSession(UEnhancedOnlineRequest_
 		return;
 	}
 
-	if (IsValid(PendingSessionRequest))
+	if (HostedSessions.Contains(Request->SessionName))
 	{
-		UE_LOG(LogEnhancedSubsystem, Error, TEXT("A session is already being hosted."));
-		Request->OnRequestFailedDelegate.Broadcast(TEXT("A session is already being hosted."));
+		UE_LOG(LogEnhancedSubsystem, Error, TEXT("A session named %s is already being hosted."), *Request->SessionName.ToString());
+		Request->OnRequestFailedDelegate.Broadcast(FString::Printf(TEXT("A session named %s is already being hosted."), *Request->SessionName.ToString()));
 		return;
 	}
 
-	APlayerController* PlayerController = UGameplayStatics::GetPlayerController(Request->GetWorld(), Request->LocalUserIndex);
-	if (PlayerController == nullptr)
+	/* Dedicated servers have no local player, their sessions are hosted without an owning user */
+	ULocalPlayer* LocalPlayer = nullptr;
+	if (GetWorld()->GetNetMode() != NM_DedicatedServer)
 	{
-		UE_LOG(LogEnhancedSubsystem, Error, TEXT("Host Online Session was called with a bad local user index."));
-		Request->OnRequestFailedDelegate.Broadcast(TEXT("Host Online Session was called with a bad local user index."));
-		return;
-	}
+		APlayerController* PlayerController = UGameplayStatics::GetPlayerController(Request->GetWorld(), Request->LocalUserIndex);
+		if (PlayerController == nullptr)
+		{
+			UE_LOG(LogEnhancedSubsystem, Error, TEXT("Host Online Session was called with a bad local user index."));
+			Request->OnRequestFailedDelegate.Broadcast(TEXT("Host Online Session was called with a bad local user index."));
+			return;
+		}
 
-	ULocalPlayer* LocalPlayer = PlayerController->GetLocalPlayer();
-	if (LocalPlayer == nullptr)
-	{
-		UE_LOG(LogEnhancedSubsystem, Error, TEXT("Host Online Session was called with a bad local user index: %d."), Request->LocalUserIndex);
-		Request->OnRequestFailedDelegate.Broadcast(FString::Printf(TEXT("Host Online Session was called with a bad local user index: %d."), Request->LocalUserIndex));
-		return;
+		LocalPlayer = PlayerController->GetLocalPlayer();
+		if (LocalPlayer == nullptr)
+		{
+			UE_LOG(LogEnhancedSubsystem, Error, TEXT("Host Online Session was called with a bad local user index: %d."), Request->LocalUserIndex);
+			Request->OnRequestFailedDelegate.Broadcast(FString::Printf(TEXT("Host Online Session was called with a bad local user index: %d."), Request->LocalUserIndex));
+			return;
+		}
 	}
 
 	if (Request->OnlineMode == EEnhancedSessionOnlineMode::Offline)
 	{
+		/* Offline sessions aren't registered with the online service, travelling to the map is all there is to host them */
 		if (GetWorld()->GetNetMode() == NM_Client)
 		{
 			Request->OnRequestFailedDelegate.Broadcast(TEXT("Cannot host an offline session on a client."));
-			return;
+		}
+		else if (Request->GetMapName().IsEmpty())
+		{
+			UE_LOG(LogEnhancedSubsystem, Error, TEXT("Host Online Session was called with a map that can't be found."));
+			Request->OnRequestFailedDelegate.Broadcast(TEXT("Host Online Session was called with a map that can't be found."));
+		}
+		else if (!GetWorld()->ServerTravel(Request->GetTravelURL().ToString()))
+		{
+			UE_LOG(LogEnhancedSubsystem, Error, TEXT("Failed to travel to the offline session %s."), *Request->SessionName.ToString());
+			Request->OnRequestFailedDelegate.Broadcast(FString::Printf(TEXT("Failed to travel to the offline session %s."), *Request->SessionName.ToString()));
+		}
+		else
+		{
+			Request->OnCreateSessionCompleted.Broadcast(Request->LocalUserIndex, Request->SessionName);
 		}
 
-		GetWorld()->ServerTravel(Request->GetTravelURL().ToString());
+		Request->CompleteRequest();
 	}
 	else
 	{
@@ -71,266 +93,485 @@ void UEnhancedOnlineSessionsSubsystem::HostOnlineSession(UEnhancedOnlineRequest_
 
 void UEnhancedOnlineSessionsSubsystem::HostOnlineLobbyInternal(ULocalPlayer* LocalPlayer, UEnhancedOnlineRequest_CreateLobby* Request)
 {
-	PendingTravelURL = Request->GetTravelURL();
-
 	check(Request->OnlineSub);
 	check(Request->Sessions);
 
-	FUniqueNetIdPtr UserId = LocalPlayer->GetPreferredUniqueNetId().GetUniqueNetId();
+	FUniqueNetIdPtr UserId = LocalPlayer ? LocalPlayer->GetPreferredUniqueNetId().GetUniqueNetId() : nullptr;
 
-	if (ensure(UserId.IsValid()))
+	if (LocalPlayer && !ensure(UserId.IsValid()))
 	{
-		HostLobbyDelegateHandle = Request->Sessions->AddOnCreateSessionCompleteDelegate_Handle(FOnCreateSessionCompleteDelegate::CreateUObject(this, &ThisClass::HandleHostOnlineLobbyComplete));
-		
-		SessionSettings = MakeShared<FEnhancedOnlineSessionSettings>(Request->OnlineMode == EEnhancedSessionOnlineMode::LAN, Request->bUsesPresence, Request->GetMaxPlayers(), Request->bAllowJoinInProgress);
-		SessionSettings->bUseLobbiesIfAvailable = true;
-		SessionSettings->bUseLobbiesVoiceChatIfAvailable = Request->bUseVoiceChatIfAvailable;
-		SessionSettings->Set(SETTING_GAMEMODE, Request->GameModeAdvertisementName, EOnlineDataAdvertisementType::ViaOnlineService);
-		SessionSettings->Set(SETTING_MAPNAME, Request->GetMapName(), EOnlineDataAdvertisementType::ViaOnlineService);
-		SessionSettings->Set(SEARCH_KEYWORDS, Request->SearchKeyword, EOnlineDataAdvertisementType::ViaOnlineService);
-		SessionSettings->Set(SETTING_MATCHING_TIMEOUT, 120.0f, EOnlineDataAdvertisementType::ViaOnlineService);
-		SessionSettings->Set(SETTING_SESSION_TEMPLATE_NAME, FString("GameSession"), EOnlineDataAdvertisementType::DontAdvertise);
-		SessionSettings->Set(SETTING_FRIENDLYNAME, Request->FriendlyName, EOnlineDataAdvertisementType::ViaOnlineService);
+		Request->OnRequestFailedDelegate.Broadcast(TEXT("Failed to create lobby, the local player is not logged in."));
+		return;
+	}
 
+	TSharedRef<FEnhancedOnlineSessionSettings> SessionSettings = MakeShared<FEnhancedOnlineSessionSettings>(Request->OnlineMode == EEnhancedSessionOnlineMode::LAN, Request->bUsesPresence, Request->GetMaxPlayers(), Request->bAllowJoinInProgress);
+	SessionSettings->bUseLobbiesIfAvailable = true;
+	SessionSettings->bUseLobbiesVoiceChatIfAvailable = Request->bUseVoiceChatIfAvailable;
+	SessionSettings->Set(SETTING_GAMEMODE, Request->GameModeAdvertisementName, EOnlineDataAdvertisementType::ViaOnlineService);
+	SessionSettings->Set(SETTING_MAPNAME, Request->GetMapName(), EOnlineDataAdvertisementType::ViaOnlineService);
+	SessionSettings->Set(SEARCH_KEYWORDS, Request->SearchKeyword, EOnlineDataAdvertisementType::ViaOnlineService);
+	SessionSettings->Set(SETTING_MATCHING_TIMEOUT, MatchingTimeout, EOnlineDataAdvertisementType::ViaOnlineService);
+	SessionSettings->Set(SETTING_SESSION_TEMPLATE_NAME, FString("GameSession"), EOnlineDataAdvertisementType::DontAdvertise);
+	SessionSettings->Set(SETTING_FRIENDLYNAME, Request->FriendlyName, EOnlineDataAdvertisementType::ViaOnlineService);
+	AdvertiseQosPort(*SessionSettings);
+	AdvertiseReservationPort(*SessionSettings);
+
+	if (UserId.IsValid())
+	{
 		FSessionSettings& UserSettings = SessionSettings->MemberSettings.Add(UserId.ToSharedRef(), FSessionSettings());
 		UserSettings.Add(SETTING_GAMEMODE, FOnlineSessionSetting(FString("GameSession"), EOnlineDataAdvertisementType::ViaOnlineService));
-		
-		PendingSessionRequest = Request;
+	}
 
-		UE_LOG(LogEnhancedSubsystem, Log, TEXT("Hosting lobby with %d players..."), Request->GetMaxPlayers());
+	AddHostedSession(Request, SessionSettings, true);
 
-		if (!Request->Sessions->CreateSession(0, NAME_GameSession, *SessionSettings))
-		{
-			UE_LOG(LogEnhancedSubsystem, Error, TEXT("Failed to create lobby."));
-			Request->OnRequestFailedDelegate.Broadcast(TEXT("Failed to create lobby."));
+	UE_LOG(LogEnhancedSubsystem, Log, TEXT("Hosting lobby %s with %d players..."), *Request->SessionName.ToString(), Request->GetMaxPlayers());
 
-			/* Clear the delegate handle */
-			Request->Sessions->ClearOnCreateSessionCompleteDelegate_Handle(HostLobbyDelegateHandle);
-			HostLobbyDelegateHandle.Reset();
-			PendingSessionRequest = nullptr;
-		}
-	}
+	CreateHostedSession(Request->SessionName);
 }
 
 void UEnhancedOnlineSessionsSubsystem::HandleHostOnlineLobbyComplete(FName SessionName, bool bWasSuccessful)
 {
-	IOnlineSubsystem* OnlineSub = Online::GetSubsystem(GetWorld());
-	IOnlineSessionPtr Sessions = OnlineSub->GetSessionInterface();
+	FEnhancedHostedSession* HostedSession = HostedSessions.Find(SessionName);
+	check(HostedSession);
+
+	UEnhancedOnlineRequest_Session* Request = HostedSession->Request;
+	FURL TravelURL = HostedSession->TravelURL;
+	HostedSession->Request = nullptr;
 
 	if (bWasSuccessful)
 	{
-		if (PendingSessionRequest)
-		{
-			PendingSessionRequest->OnCreateSessionCompleted.Broadcast(0, SessionName);
-		}
-		
-		UE_LOG(LogEnhancedSubsystem, Log, TEXT("Lobby created successfully."));
-		
-		if (!PendingTravelURL.ToString().IsEmpty())
+		UE_LOG(LogEnhancedSubsystem, Log, TEXT("Lobby %s created successfully."), *SessionName.ToString());
+		SetHostedSessionState(SessionName, EEnhancedHostedSessionState::Pending);
+		ScheduleHostedSessionUpdate(SessionName);
+
+		if (Request)
 		{
-			GetWorld()->Listen(PendingTravelURL);
+			Request->OnCreateSessionCompleted.Broadcast(Request->LocalUserIndex, SessionName);
 		}
-		else
+
+		/* Only the game session moves the host, other named sessions live next to it */
+		if (SessionName == NAME_GameSession)
 		{
-			UE_LOG(LogEnhancedSubsystem, Error, TEXT("No travel URL was set."));
+			if (!TravelURL.ToString().IsEmpty())
+			{
+				GetWorld()->Listen(TravelURL);
+			}
+			else
+			{
+				UE_LOG(LogEnhancedSubsystem, Error, TEXT("No travel URL was set."));
+			}
 		}
 	}
 	else
 	{
-		if (PendingSessionRequest)
+		UE_LOG(LogEnhancedSubsystem, Error, TEXT("Failed to create lobby."));
+		SetHostedSessionState(SessionName, EEnhancedHostedSessionState::Destroyed);
+
+		if (Request)
 		{
-			PendingSessionRequest->OnRequestFailedDelegate.Broadcast(TEXT("Failed to create lobby."));
+			Request->OnRequestFailedDelegate.Broadcast(TEXT("Failed to create lobby."));
 		}
-		UE_LOG(LogEnhancedSubsystem, Error, TEXT("Failed to create lobby."));
 	}
 
-	/* Clear the delegate handle */
-	Sessions->ClearOnCreateSessionCompleteDelegate_Handle(HostLobbyDelegateHandle);
-	HostLobbyDelegateHandle.Reset();
-
-	if (PendingSessionRequest)
+	if (Request)
 	{
-		PendingSessionRequest->CompleteRequest();	
+		Request->CompleteRequest();
 	}
-	PendingSessionRequest = nullptr;
 }
 
 void UEnhancedOnlineSessionsSubsystem::HostOnlineSessionInternal(ULocalPlayer* LocalPlayer, UEnhancedOnlineRequest_CreateSession* Request)
 {
-	PendingTravelURL = Request->GetTravelURL();
-
 	check(Request->OnlineSub);
 	check(Request->Sessions);
 
-	FUniqueNetIdPtr UserId = LocalPlayer->GetPreferredUniqueNetId().GetUniqueNetId();
+	FUniqueNetIdPtr UserId = LocalPlayer ? LocalPlayer->GetPreferredUniqueNetId().GetUniqueNetId() : nullptr;
 
-	if (ensure(UserId.IsValid()))
+	if (LocalPlayer && !ensure(UserId.IsValid()))
 	{
-		HostSessionDelegateHandle = Request->Sessions->AddOnCreateSessionCompleteDelegate_Handle(FOnCreateSessionCompleteDelegate::CreateUObject(this, &ThisClass::HandleHostOnlineSessionComplete));
+		Request->OnRequestFailedDelegate.Broadcast(TEXT("Failed to create session, the local player is not logged in."));
+		return;
+	}
 
-		SessionSettings = MakeShared<FEnhancedOnlineSessionSettings>(Request->OnlineMode == EEnhancedSessionOnlineMode::LAN, Request->bUsesPresence, Request->GetMaxPlayers(), Request->bAllowJoinInProgress);
-		SessionSettings->bUseLobbiesIfAvailable = Request->bUseLobbiesIfAvailable;
-		SessionSettings->bUseLobbiesVoiceChatIfAvailable = Request->bUseVoiceChatIfAvailable;
-		SessionSettings->Set(SETTING_GAMEMODE, Request->GameModeAdvertisementName, EOnlineDataAdvertisementType::ViaOnlineService);
-		SessionSettings->Set(SETTING_MAPNAME, Request->GetMapName(), EOnlineDataAdvertisementType::ViaOnlineService);
-		SessionSettings->Set(SEARCH_KEYWORDS, Request->SearchKeyword, EOnlineDataAdvertisementType::ViaOnlineService);
-		SessionSettings->Set(SETTING_MATCHING_TIMEOUT, 120.0f, EOnlineDataAdvertisementType::ViaOnlineService);
-		SessionSettings->Set(SETTING_SESSION_TEMPLATE_NAME, FString("GameSession"), EOnlineDataAdvertisementType::DontAdvertise);
-		SessionSettings->Set(SETTING_FRIENDLYNAME, Request->FriendlyName, EOnlineDataAdvertisementType::ViaOnlineService);
+	TSharedRef<FEnhancedOnlineSessionSettings> SessionSettings = MakeShared<FEnhancedOnlineSessionSettings>(Request->OnlineMode == EEnhancedSessionOnlineMode::LAN, Request->bUsesPresence, Request->GetMaxPlayers(), Request->bAllowJoinInProgress);
+	SessionSettings->bUseLobbiesIfAvailable = Request->bUseLobbiesIfAvailable;
+	SessionSettings->bUseLobbiesVoiceChatIfAvailable = Request->bUseVoiceChatIfAvailable;
+	SessionSettings->Set(SETTING_GAMEMODE, Request->GameModeAdvertisementName, EOnlineDataAdvertisementType::ViaOnlineService);
+	SessionSettings->Set(SETTING_MAPNAME, Request->GetMapName(), EOnlineDataAdvertisementType::ViaOnlineService);
+	SessionSettings->Set(SEARCH_KEYWORDS, Request->SearchKeyword, EOnlineDataAdvertisementType::ViaOnlineService);
+	SessionSettings->Set(SETTING_MATCHING_TIMEOUT, MatchingTimeout, EOnlineDataAdvertisementType::ViaOnlineService);
+	SessionSettings->Set(SETTING_SESSION_TEMPLATE_NAME, FString("GameSession"), EOnlineDataAdvertisementType::DontAdvertise);
+	SessionSettings->Set(SETTING_FRIENDLYNAME, Request->FriendlyName, EOnlineDataAdvertisementType::ViaOnlineService);
+	AdvertiseQosPort(*SessionSettings);
+	AdvertiseReservationPort(*SessionSettings);
 
+	if (UserId.IsValid())
+	{
 		FSessionSettings& UserSettings = SessionSettings->MemberSettings.Add(UserId.ToSharedRef(), FSessionSettings());
 		UserSettings.Add(SETTING_GAMEMODE, FOnlineSessionSetting(Request->GameModeAdvertisementName, EOnlineDataAdvertisementType::ViaOnlineService));
+	}
 
-		PendingSessionRequest = Request;
+	AddHostedSession(Request, SessionSettings, false);
 
-		UE_LOG(LogEnhancedSubsystem, Log, TEXT("Hosting session with %d players..."), Request->GetMaxPlayers());
+	UE_LOG(LogEnhancedSubsystem, Log, TEXT("Hosting session %s with %d players..."), *Request->SessionName.ToString(), Request->GetMaxPlayers());
 
-		if (!Request->Sessions->CreateSession(0, NAME_GameSession, *SessionSettings))
-		{
-			UE_LOG(LogEnhancedSubsystem, Error, TEXT("Failed to create session."));
-			Request->OnRequestFailedDelegate.Broadcast(TEXT("Failed to create session."));
+	Request->HostTimings = FEnhancedSessionHostTimings();
+	Request->CreateSessionStartTime = FPlatformTime::Seconds();
+	Request->bMapPreloadCompleted = false;
 
-			/* Clear the delegate handle */
-			Request->Sessions->ClearOnCreateSessionCompleteDelegate_Handle(HostSessionDelegateHandle);
-			HostSessionDelegateHandle.Reset();
-		}
+	/* Load the map while the online service creates the session, the travel then finds the package in memory */
+	if (Request->bPreloadMapDuringCreate)
+	{
+		const FName MapPackageName(*Request->GetMapPackageName());
+		PreloadMapPackage(MapPackageName, FOnEnhancedMapPreloaded::CreateUObject(this, &ThisClass::HandleCreateSessionMapPreloaded, TWeakObjectPtr<UEnhancedOnlineRequest_CreateSession>(Request), Request->RequestSerial));
 	}
+
+	CreateHostedSession(Request->SessionName);
 }
 
 void UEnhancedOnlineSessionsSubsystem::HandleHostOnlineSessionComplete(FName SessionName, bool bWasSuccessful)
 {
-	IOnlineSubsystem* OnlineSub = Online::GetSubsystem(GetWorld());
-	IOnlineSessionPtr Sessions = OnlineSub->GetSessionInterface();
+	FEnhancedHostedSession* HostedSession = HostedSessions.Find(SessionName);
+	check(HostedSession);
+
+	UEnhancedOnlineRequest_Session* Request = HostedSession->Request;
+	FURL TravelURL = HostedSession->TravelURL;
+	HostedSession->Request = nullptr;
+
+	UEnhancedOnlineRequest_CreateSession* CreateRequest = Cast<UEnhancedOnlineRequest_CreateSession>(Request);
+	if (CreateRequest)
+	{
+		FEnhancedSessionHostTimings& Timings = CreateRequest->HostTimings;
+		Timings.CreateSessionSeconds = FPlatformTime::Seconds() - CreateRequest->CreateSessionStartTime;
+
+		/* A load that is still running overlapped with the whole creation */
+		if (CreateRequest->bPreloadMapDuringCreate)
+		{
+			Timings.bMapPreloadedBeforeTravel = CreateRequest->bMapPreloadCompleted;
+			Timings.OverlapSavedSeconds = CreateRequest->bMapPreloadCompleted
+				? FMath::Min(Timings.CreateSessionSeconds, Timings.MapPreloadSeconds)
+				: Timings.CreateSessionSeconds;
+		}
+	}
 
 	if (bWasSuccessful)
 	{
-		UE_LOG(LogEnhancedSubsystem, Log, TEXT("Session created successfully."));
+		UE_LOG(LogEnhancedSubsystem, Log, TEXT("Session %s created successfully."), *SessionName.ToString());
+		SetHostedSessionState(SessionName, EEnhancedHostedSessionState::Pending);
+		ScheduleHostedSessionUpdate(SessionName);
 
-		if (!PendingTravelURL.ToString().IsEmpty())
+		if (CreateRequest && CreateRequest->bPreloadMapDuringCreate)
 		{
-			GetWorld()->ServerTravel(PendingTravelURL.ToString());	
+			UE_LOG(LogEnhancedSubsystem, Log, TEXT("Session created in %.2fs, map preloading saved %.2fs%s."),
+				CreateRequest->HostTimings.CreateSessionSeconds, CreateRequest->HostTimings.OverlapSavedSeconds,
+				CreateRequest->bMapPreloadCompleted ? TEXT("") : TEXT(" and is still running"));
+		}
+
+		if (Request)
+		{
+			Request->OnCreateSessionCompleted.Broadcast(Request->LocalUserIndex, SessionName);
+		}
+
+		/* Only the game session moves the host, other named sessions live next to it */
+		if (SessionName == NAME_GameSession && !TravelURL.ToString().IsEmpty())
+		{
+			GetWorld()->ServerTravel(TravelURL.ToString());
 		}
 	}
 	else
 	{
 		UE_LOG(LogEnhancedSubsystem, Error, TEXT("Failed to create session."));
+		SetHostedSessionState(SessionName, EEnhancedHostedSessionState::Destroyed);
 
-		if (PendingSessionRequest)
+		if (Request)
 		{
-			PendingSessionRequest->OnRequestFailedDelegate.Broadcast(TEXT("Failed to create session."));
+			Request->OnRequestFailedDelegate.Broadcast(TEXT("Failed to create session."));
+		}
+
+		if (CreateRequest && CreateRequest->bPreloadMapDuringCreate)
+		{
+			ReleasePreloadedMapPackage(FName(*CreateRequest->GetMapPackageName()));
 		}
 	}
 
-	/* Clear the delegate handle */
-	Sessions->ClearOnCreateSessionCompleteDelegate_Handle(HostSessionDelegateHandle);
-	HostSessionDelegateHandle.Reset();
+	if (Request)
+	{
+		Request->CompleteRequest();
+	}
+}
 
-	if (PendingSessionRequest)
+void UEnhancedOnlineSessionsSubsystem::HandleCreateSessionComplete(FName SessionName, bool bWasSuccessful)
+{
+	/* Sessions created outside of the subsystem share the delegate, only route the ones we are creating */
+	const FEnhancedHostedSession* HostedSession = HostedSessions.Find(SessionName);
+	if (HostedSession && HostedSession->State == EEnhancedHostedSessionState::Creating && !HostedSession->bIsAbandoningCreate)
 	{
-		PendingSessionRequest->CompleteRequest();
-		PendingSessionRequest = nullptr;
+		/* Transient failures are retried, the session stays reserved until the retry policy gives up */
+		if (!bWasSuccessful && ScheduleCreateSessionRetry(SessionName))
+		{
+			return;
+		}
+
+		if (HostedSession->bIsLobby)
+		{
+			HandleHostOnlineLobbyComplete(SessionName, bWasSuccessful);
+		}
+		else
+		{
+			HandleHostOnlineSessionComplete(SessionName, bWasSuccessful);
+		}
 	}
+
+	ClearCreateSessionDelegateIfIdle();
 }
 
-void UEnhancedOnlineSessionsSubsystem::FindOnlineSessions(UEnhancedOnlineRequest_FindSessions* Request)
+void UEnhancedOnlineSessionsSubsystem::AddHostedSession(UEnhancedOnlineRequest_Session* Request, const TSharedRef<FEnhancedOnlineSessionSettings>& InSessionSettings, bool bIsLobby)
 {
-	if (Request == nullptr)
+	FEnhancedHostedSession& HostedSession = HostedSessions.Add(Request->SessionName);
+	HostedSession.SessionName = Request->SessionName;
+	HostedSession.Request = Request;
+	HostedSession.TravelURL = Request->GetTravelURL();
+	HostedSession.bIsLobby = bIsLobby;
+	HostedSession.SessionSettings = InSessionSettings;
+	HostedSession.bBackfillEnabled = Request->bBackfillWhenInProgress;
+
+	Request->CreateAttempts = 0;
+	Request->FirstCreateAttemptTime = FPlatformTime::Seconds();
+
+	FEnhancedSettingsPublishRules PublishRules;
+	PublishRules.BatchWindow = FMath::Max(SessionUpdateBatchWindow, 0.f);
+	PublishRules.MinInterval = FMath::Max(SessionUpdateMinInterval, 0.f);
+	PublishRules.LowPriorityInterval = FMath::Max(SessionUpdateLowPriorityInterval, 0.f);
+	PublishRules.RetryPolicy = SessionUpdateRetryPolicy;
+
+	HostedSession.Publisher = MakeShared<FEnhancedSessionSettingsPublisher>(InSessionSettings, PublishRules);
+	HostedSession.Publisher->OnPublishTimeChanged.BindUObject(this, &ThisClass::ScheduleHostedSessionUpdate, Request->SessionName);
+}
+
+void UEnhancedOnlineSessionsSubsystem::CreateHostedSession(const FName SessionName)
+{
+	const FEnhancedHostedSession* HostedSession = HostedSessions.Find(SessionName);
+	check(HostedSession && HostedSession->Request && HostedSession->SessionSettings.IsValid());
+
+	IOnlineSessionPtr Sessions = HostedSession->Request->Sessions;
+	HostedSession->Request->CreateAttempts++;
+
+	/* One delegate serves every session, the completion is routed by the session name */
+	if (!CreateSessionDelegateHandle.IsValid())
 	{
-		UE_LOG(LogEnhancedSubsystem, Error, TEXT("Find Online Sessions was called with a bad request."));
-		return;
+		CreateSessionDelegateHandle = Sessions->AddOnCreateSessionCompleteDelegate_Handle(FOnCreateSessionCompleteDelegate::CreateUObject(this, &ThisClass::HandleCreateSessionComplete));
 	}
 
-	APlayerController* PlayerController = UGameplayStatics::GetPlayerController(Request->GetWorld(), Request->LocalUserIndex);
-	if (PlayerController == nullptr)
+	SetHostedSessionState(SessionName, EEnhancedHostedSessionState::Creating);
+	HostedSessions[SessionName].StateEnterTime = FPlatformTime::Seconds();
+
+	/* Keep the settings alive in case the session completes synchronously and removes the entry */
+	TSharedPtr<FEnhancedOnlineSessionSettings> SessionSettings = HostedSession->SessionSettings;
+	if (!Sessions->CreateSession(0, SessionName, *SessionSettings))
 	{
-		UE_LOG(LogEnhancedSubsystem, Error, TEXT("Find Online Sessions was called with a bad local user index."));
-		Request->OnRequestFailedDelegate.Broadcast(TEXT("Find Online Sessions was called with a bad local user index."));
-		return;
+		UE_LOG(LogEnhancedSubsystem, Warning, TEXT("The online service refused to create session %s."), *SessionName.ToString());
+		HandleCreateSessionComplete(SessionName, false);
 	}
+}
 
-	ULocalPlayer* LocalPlayer = PlayerController->GetLocalPlayer();
-	if (LocalPlayer == nullptr)
+bool UEnhancedOnlineSessionsSubsystem::ScheduleCreateSessionRetry(const FName SessionName)
+{
+	FEnhancedHostedSession* HostedSession = HostedSessions.Find(SessionName);
+	UGameInstance* GameInstance = GetGameInstance();
+	if (HostedSession == nullptr || HostedSession->Request == nullptr || GameInstance == nullptr)
 	{
-		UE_LOG(LogEnhancedSubsystem, Error, TEXT("Find Online Sessions was called with a bad local user index: %d."), Request->LocalUserIndex);
-		Request->OnRequestFailedDelegate.Broadcast(FString::Printf(TEXT("Find Online Sessions was called with a bad local user index: %d."), Request->LocalUserIndex));
-		return;
+		return false;
+	}
+
+	const UEnhancedOnlineRequest_Session* Request = HostedSession->Request;
+	const FEnhancedSessionRetryPolicy& RetryPolicy = Request->RetryPolicy;
+	if (Request->CreateAttempts >= RetryPolicy.MaxAttempts)
+	{
+		return false;
 	}
 
-	FindOnlineSessionsInternal(LocalPlayer, MakeShared<FEnhancedOnlineSearchSettings>(Request));
+	const float Delay = RetryPolicy.GetRetryDelay(Request->CreateAttempts);
+	const double RetryTime = FPlatformTime::Seconds() + Delay - Request->FirstCreateAttemptTime;
+	if (RetryPolicy.Deadline > 0.f && RetryTime > RetryPolicy.Deadline)
+	{
+		UE_LOG(LogEnhancedSubsystem, Warning, TEXT("Creating session %s failed, the next attempt would miss the %.1fs deadline."), *SessionName.ToString(), RetryPolicy.Deadline);
+		return false;
+	}
+
+	UE_LOG(LogEnhancedSubsystem, Warning, TEXT("Creating session %s failed, retrying in %.2fs (attempt %d of %d)."),
+		*SessionName.ToString(), Delay, Request->CreateAttempts + 1, RetryPolicy.MaxAttempts);
+
+	GameInstance->GetTimerManager().SetTimer(HostedSession->RetryTimerHandle,
+		FTimerDelegate::CreateUObject(this, &ThisClass::RetryCreateHostedSession, SessionName),
+		FMath::Max(Delay, KINDA_SMALL_NUMBER), false);
+
+	return true;
 }
 
-void UEnhancedOnlineSessionsSubsystem::FindOnlineSessionsInternal(ULocalPlayer* LocalPlayer, const TSharedRef<FEnhancedOnlineSearchSettings>& InSearchSettings)
+void UEnhancedOnlineSessionsSubsystem::RetryCreateHostedSession(const FName SessionName)
 {
-	if (SearchSettings.IsValid())
+	const FEnhancedHostedSession* HostedSession = HostedSessions.Find(SessionName);
+	if (HostedSession && HostedSession->Request && HostedSession->State == EEnhancedHostedSessionState::Creating)
+	{
+		CreateHostedSession(SessionName);
+	}
+}
+
+void UEnhancedOnlineSessionsSubsystem::SetHostedSessionState(const FName SessionName, EEnhancedHostedSessionState NewState)
+{
+	FEnhancedHostedSession* HostedSession = HostedSessions.Find(SessionName);
+	if (HostedSession == nullptr || HostedSession->State == NewState)
 	{
-		UE_LOG(LogEnhancedSubsystem, Error, TEXT("A search is already in progress."));
-		InSearchSettings->Request->OnRequestFailedDelegate.Broadcast(TEXT("A search is already in progress."));
 		return;
 	}
 
-	SearchSettings = InSearchSettings;
+	/* Destroyed sessions are forgotten, the name can be hosted again right away */
+	const bool bWasDraining = HostedSession->DrainPhase != EEnhancedSessionDrainPhase::None;
 
-	FindSessionsDelegateHandle = SearchSettings->Request->Sessions->AddOnFindSessionsCompleteDelegate_Handle(FOnFindSessionsCompleteDelegate::CreateUObject(this, &ThisClass::HandleFindOnlineSessionsComplete));
+	if (NewState == EEnhancedHostedSessionState::Destroyed)
+	{
+		TArray<TObjectPtr<UEnhancedOnlineRequest_RecycleSession>> RecycleRequests = MoveTemp(HostedSession->PendingRecycleRequests);
+		RecycleRequests.Append(HostedSession->UpdatingRecycleRequests);
+		if (UGameInstance* GameInstance = GetGameInstance())
+		{
+			GameInstance->GetTimerManager().ClearTimer(HostedSession->UpdateTimerHandle);
+			GameInstance->GetTimerManager().ClearTimer(HostedSession->RetryTimerHandle);
+		}
+		HostedSessions.Remove(SessionName);
 
-	if (!InSearchSettings->Request->Sessions->FindSessions(0, InSearchSettings))
+		for (UEnhancedOnlineRequest_RecycleSession* Request : RecycleRequests)
+		{
+			if (Request)
+			{
+				Request->OnRequestFailedDelegate.Broadcast(FString::Printf(TEXT("Session %s was destroyed."), *SessionName.ToString()));
+			}
+		}
+	}
+	else
 	{
-		UE_LOG(LogEnhancedSubsystem, Error, TEXT("Failed to find sessions. :("));
-		InSearchSettings->Request->OnRequestFailedDelegate.Broadcast(TEXT("Failed to find sessions. :("));
+		HostedSession->State = NewState;
+		HostedSession->StateEnterTime = FPlatformTime::Seconds();
+
+		if (GetHostedSessionStateTimeout(NewState) > 0.f)
+		{
+			StartHostedSessionWatchdog();
+		}
 
-		InSearchSettings->Request->Sessions->ClearOnFindSessionsCompleteDelegate_Handle(FindSessionsDelegateHandle);
-		FindSessionsDelegateHandle.Reset();
+		if (NewState == EEnhancedHostedSessionState::InProgress && HostedSession->bBackfillEnabled)
+		{
+			StartBackfillWatch();
+		}
+	}
+
+	OnHostedSessionStateChanged.Broadcast(SessionName, NewState);
+
+	if (bWasDraining && NewState == EEnhancedHostedSessionState::Destroyed)
+	{
+		UE_LOG(LogEnhancedSubsystem, Log, TEXT("Session %s was drained."), *SessionName.ToString());
+		OnHostedSessionDrainProgress.Broadcast(SessionName, EEnhancedSessionDrainPhase::Drained);
 	}
 }
 
-void UEnhancedOnlineSessionsSubsystem::HandleFindOnlineSessionsComplete(bool bWasSuccessful)
+void UEnhancedOnlineSessionsSubsystem::ClearCreateSessionDelegateIfIdle()
 {
-	if (bWasSuccessful)
+	for (const TPair<FName, FEnhancedHostedSession>& Pair : HostedSessions)
 	{
-		UE_LOG(LogEnhancedSubsystem, Log, TEXT("Found sessions successfully."));
-
-		if (SearchSettings.IsValid())
+		if (Pair.Value.State == EEnhancedHostedSessionState::Creating)
 		{
-			TArray<UEnhancedSessionSearchResult*> Results;
-			for (auto& SearchResult : SearchSettings->SearchResults)
-			{
-				UEnhancedSessionSearchResult* NewResult = NewObject<UEnhancedSessionSearchResult>(SearchSettings->Request);
-				NewResult->StoredSearchResult = SearchResult;
-				Results.Add(NewResult);
-
-				FString OwningUserId = TEXT("Uknown");
-				if (SearchResult.Session.OwningUserId.IsValid())
-				{
-					OwningUserId = SearchResult.Session.OwningUserId->ToString();
-				}
-				
-				UE_LOG(LogEnhancedSubsystem, Log, TEXT("\tFound session (UserId: %s, UserName: %s, NumOpenPrivConns: %d, NumOpenPubConns: %d, Ping: %d ms"),
-				*OwningUserId,
-				*SearchResult.Session.OwningUserName,
-				SearchResult.Session.NumOpenPrivateConnections,
-				SearchResult.Session.NumOpenPublicConnections,
-				SearchResult.PingInMs);
-			}
+			return;
+		}
+	}
+
+	if (IOnlineSessionPtr Sessions = Online::GetSessionInterface(GetWorld()))
+	{
+		Sessions->ClearOnCreateSessionCompleteDelegate_Handle(CreateSessionDelegateHandle);
+	}
+	CreateSessionDelegateHandle.Reset();
+}
 
-			SearchSettings->Request->OnFindOnlineSessionsCompleted.Broadcast(Results);
+void UEnhancedOnlineSessionsSubsystem::ClearStartSessionDelegateIfIdle()
+{
+	if (!StartSessionDelegateHandle.IsValid() || (RequestScheduler.IsValid() && RequestScheduler->GetNumRunning(EEnhancedRequestCategory::StartSession) > 0))
+	{
+		return;
+	}
+
+	for (const TPair<FName, FEnhancedHostedSession>& Pair : HostedSessions)
+	{
+		if (Pair.Value.bIsAwaitingLateStart)
+		{
+			return;
 		}
 	}
-	else
+
+	if (IOnlineSessionPtr Sessions = Online::GetSessionInterface(GetWorld()))
 	{
-		UE_LOG(LogEnhancedSubsystem, Error, TEXT("Failed to find sessions. :("));
+		Sessions->ClearOnStartSessionCompleteDelegate_Handle(StartSessionDelegateHandle);
 	}
+	StartSessionDelegateHandle.Reset();
+}
 
-	if (SearchSettings.IsValid())
+bool UEnhancedOnlineSessionsSubsystem::DestroyHostedSession(FName SessionName)
+{
+	const FEnhancedHostedSession* HostedSession = HostedSessions.Find(SessionName);
+	if (HostedSession == nullptr)
 	{
-		SearchSettings->Request->Sessions->ClearOnFindSessionsCompleteDelegate_Handle(FindSessionsDelegateHandle);
-		FindSessionsDelegateHandle.Reset();
-		
-		SearchSettings->Request->CompleteRequest();
-		SearchSettings = nullptr;
+		UE_LOG(LogEnhancedSubsystem, Error, TEXT("Destroy Hosted Session was called with an unknown session: %s."), *SessionName.ToString());
+		return false;
 	}
-	else
+
+	if (HostedSession->State == EEnhancedHostedSessionState::Creating || HostedSession->State == EEnhancedHostedSessionState::Destroying)
+	{
+		UE_LOG(LogEnhancedSubsystem, Warning, TEXT("Session %s cannot be destroyed while it is being created or destroyed."), *SessionName.ToString());
+		return false;
+	}
+
+	IOnlineSessionPtr Sessions = Online::GetSessionInterface(GetWorld());
+	if (Sessions == nullptr)
+	{
+		UE_LOG(LogEnhancedSubsystem, Error, TEXT("Destroy Hosted Session was called without a session interface."));
+		return false;
+	}
+
+	/* A refused destroy leaves the session as it was, e.g. a running match stays in progress */
+	const EEnhancedHostedSessionState PreviousState = HostedSession->State;
+	const double PreviousStateEnterTime = HostedSession->StateEnterTime;
+	SetHostedSessionState(SessionName, EEnhancedHostedSessionState::Destroying);
+
+	if (!Sessions->DestroySession(SessionName, FOnDestroySessionCompleteDelegate::CreateUObject(this, &ThisClass::HandleDestroyHostedSessionComplete)))
+	{
+		UE_LOG(LogEnhancedSubsystem, Error, TEXT("Failed to destroy session %s."), *SessionName.ToString());
+		SetHostedSessionState(SessionName, PreviousState);
+		if (FEnhancedHostedSession* RestoredSession = HostedSessions.Find(SessionName))
+		{
+			RestoredSession->StateEnterTime = PreviousStateEnterTime;
+		}
+		return false;
+	}
+
+	return true;
+}
+
+void UEnhancedOnlineSessionsSubsystem::HandleDestroyHostedSessionComplete(FName SessionName, bool bWasSuccessful)
+{
+	if (!bWasSuccessful)
 	{
-		UE_LOG(LogEnhancedSubsystem, Error, TEXT("Invalid search settings. Did we lose a reference? :("));
+		UE_LOG(LogEnhancedSubsystem, Warning, TEXT("The online service failed to destroy session %s, forgetting it anyway."), *SessionName.ToString());
 	}
+
+	SetHostedSessionState(SessionName, EEnhancedHostedSessionState::Destroyed);
+}
+
+EEnhancedHostedSessionState UEnhancedOnlineSessionsSubsystem::GetHostedSessionState(FName SessionName) const
+{
+	const FEnhancedHostedSession* HostedSession = HostedSessions.Find(SessionName);
+	return HostedSession ? HostedSession->State : EEnhancedHostedSessionState::None;
+}
+
+TArray<FName> UEnhancedOnlineSessionsSubsystem::GetHostedSessionNames() const
+{
+	TArray<FName> SessionNames;
+	HostedSessions.GetKeys(SessionNames);
+	return SessionNames;
 }
 
 void UEnhancedOnlineSessionsSubsystem::JoinOnlineSession(UEnhancedOnlineRequest_JoinSession* Request)
@@ -341,48 +582,170 @@ void UEnhancedOnlineSessionsSubsystem::JoinOnlineSession(UEnhancedOnlineRequest_
 		return;
 	}
 
-	IOnlineSubsystem* OnlineSub = Online::GetSubsystem(GetWorld());
-	IOnlineSessionPtr Sessions = OnlineSub->GetSessionInterface();
+	if (Request->Sessions == nullptr)
+	{
+		UE_LOG(LogEnhancedSubsystem, Error, TEXT("Join Online Session was called with a bad session interface."));
+		Request->OnRequestFailedDelegate.Broadcast(TEXT("Join Online Session was called with a bad session interface."));
+		return;
+	}
+
+	/* Every join travels the game session, a join made while another one runs waits for it */
+	ScheduleRequest(Request, EEnhancedRequestCategory::Join, NAME_GameSession,
+		FOnEnhancedScheduledRequestStart::CreateUObject(this, &ThisClass::RunJoinRequest));
+}
 
-	JoinSessionDelegateHandle = Sessions->AddOnJoinSessionCompleteDelegate_Handle(FOnJoinSessionCompleteDelegate::CreateUObject(this, &ThisClass::HandleJoinSessionCompleted));
+void UEnhancedOnlineSessionsSubsystem::RunJoinRequest(uint64 CorrelationId)
+{
+	UEnhancedOnlineRequest_JoinSession* Request = GetScheduledRequest<UEnhancedOnlineRequest_JoinSession>(CorrelationId);
+	if (!IsValid(Request))
+	{
+		CompleteScheduledRequest(CorrelationId);
+		return;
+	}
 
-	Sessions->GetResolvedConnectString(Request->SessionToJoin->StoredSearchResult, NAME_GamePort, PendingClientTravelURL);
+	StartJoinSessionRequest(Request);
+}
 
-	if (!Sessions->JoinSession(0, NAME_GameSession, Request->SessionToJoin->StoredSearchResult))
+void UEnhancedOnlineSessionsSubsystem::StartJoinSessionRequest(UEnhancedOnlineRequest_JoinSession* Request)
+{
+	if (PendingJoinRequest)
 	{
-		UE_LOG(LogEnhancedSubsystem, Error, TEXT("Failed to join session."));
-		Request->OnRequestFailedDelegate.Broadcast(TEXT("Failed to join session."));
+		UE_LOG(LogEnhancedSubsystem, Error, TEXT("A session is already being joined."));
+		Request->OnRequestFailedDelegate.Broadcast(TEXT("A session is already being joined."));
+		CompleteScheduledRequest(Request->CorrelationId);
+		return;
+	}
 
-		Sessions->ClearOnJoinSessionCompleteDelegate_Handle(JoinSessionDelegateHandle);
-		JoinSessionDelegateHandle.Reset();
+	Request->JoinCandidates.Reset();
+	if (Request->SessionToJoin)
+	{
+		Request->JoinCandidates.Add(Request->SessionToJoin);
+	}
+
+	for (UEnhancedSessionSearchResult* FallbackSession : Request->FallbackSessions)
+	{
+		if (FallbackSession)
+		{
+			Request->JoinCandidates.AddUnique(FallbackSession);
+		}
+	}
+
+	if (Request->JoinCandidates.IsEmpty())
+	{
+		UE_LOG(LogEnhancedSubsystem, Error, TEXT("Join Online Session was called with a bad search result."));
+		Request->OnRequestFailedDelegate.Broadcast(TEXT("Join Online Session was called with a bad search result."));
+		CompleteScheduledRequest(Request->CorrelationId);
+		return;
+	}
+
+	Request->CandidateIndex = 0;
+	Request->ReservationToken = 0;
+	Request->JoinedSession = nullptr;
+	Request->JoinTimings = FEnhancedSessionJoinTimings();
+	Request->JoinStartTime = FPlatformTime::Seconds();
+	Request->PreloadMapPackageName = NAME_None;
+	Request->bMapPreloadCompleted = false;
+	PendingJoinRequest = Request;
+
+	TryNextJoinCandidate();
+}
+
+void UEnhancedOnlineSessionsSubsystem::JoinCandidateSession(UEnhancedSessionSearchResult* Candidate)
+{
+	UEnhancedOnlineRequest_JoinSession* Request = PendingJoinRequest;
+	check(Request && Candidate);
+
+	/* The online service knows the joining user by its controller, the player may have left while the join was queued */
+	const APlayerController* PlayerController = UGameplayStatics::GetPlayerController(Request->GetWorld(), Request->LocalUserIndex);
+	const ULocalPlayer* LocalPlayer = PlayerController ? PlayerController->GetLocalPlayer() : nullptr;
+	if (LocalPlayer == nullptr)
+	{
+		FailJoinRequest(FString::Printf(TEXT("Join Online Session was called with a bad local user index: %d."), Request->LocalUserIndex));
+		return;
+	}
+
+	IOnlineSessionPtr Sessions = Request->Sessions;
+
+	if (!JoinSessionDelegateHandle.IsValid())
+	{
+		JoinSessionDelegateHandle = Sessions->AddOnJoinSessionCompleteDelegate_Handle(FOnJoinSessionCompleteDelegate::CreateUObject(this, &ThisClass::HandleJoinSessionCompleted));
+	}
+
+	Sessions->GetResolvedConnectString(Candidate->StoredSearchResult, NAME_GamePort, PendingClientTravelURL);
+	Request->JoinSessionStartTime = FPlatformTime::Seconds();
+
+	/* The host frees the reserved slot once the client logs in with the token */
+	if (Request->ReservationToken != 0)
+	{
+		PendingClientTravelURL += FString::Printf(TEXT("?ReservationToken=%llu"), Request->ReservationToken);
+	}
+
+	if (!Sessions->JoinSession(LocalPlayer->GetControllerId(), NAME_GameSession, Candidate->StoredSearchResult))
+	{
+		FailJoinRequest(TEXT("Failed to join session."));
 	}
 }
 
 void UEnhancedOnlineSessionsSubsystem::HandleJoinSessionCompleted(FName SessionName, EOnJoinSessionCompleteResult::Type Result)
 {
-	IOnlineSubsystem* OnlineSub = Online::GetSubsystem(GetWorld());
-	IOnlineSessionPtr Sessions = OnlineSub->GetSessionInterface();
-	
+	UEnhancedOnlineRequest_JoinSession* Request = PendingJoinRequest;
+	if (Request == nullptr)
+	{
+		UE_LOG(LogEnhancedSubsystem, Verbose, TEXT("Session %s was joined without a join request."), *SessionName.ToString());
+		return;
+	}
+
+	const double Now = FPlatformTime::Seconds();
+	Request->JoinTimings.JoinSessionSeconds += Now - Request->JoinSessionStartTime;
+
 	if (Result == EOnJoinSessionCompleteResult::Success)
 	{
 		UE_LOG(LogEnhancedSubsystem, Log, TEXT("Joined session successfully."));
 
-		APlayerController* PlayerController = UGameplayStatics::GetPlayerController(GetWorld(), 0);
+		APlayerController* PlayerController = UGameplayStatics::GetPlayerController(Request->GetWorld(), Request->LocalUserIndex);
 		if (PlayerController == nullptr)
 		{
-			UE_LOG(LogEnhancedSubsystem, Error, TEXT("Failed to get player controller."));
+			FailJoinRequest(TEXT("Failed to get player controller."));
 			return;
 		}
 
+		Request->JoinedSession = Request->JoinCandidates[Request->CandidateIndex];
+		PendingJoinRequest = nullptr;
+
+		Request->Sessions->ClearOnJoinSessionCompleteDelegate_Handle(JoinSessionDelegateHandle);
+		JoinSessionDelegateHandle.Reset();
+
+		/* The preloaded package stays in memory until the travel loads the map, a load that is still running overlapped with the whole join */
+		FEnhancedSessionJoinTimings& Timings = Request->JoinTimings;
+		Timings.TimeToTravelSeconds = Now - Request->JoinStartTime;
+		if (!Request->PreloadMapPackageName.IsNone())
+		{
+			Timings.bMapPreloadedBeforeTravel = Request->bMapPreloadCompleted;
+			Timings.OverlapSavedSeconds = Request->bMapPreloadCompleted ? Timings.MapPreloadSeconds : Now - Request->MapPreloadStartTime;
+
+			UE_LOG(LogEnhancedSubsystem, Log, TEXT("Session joined in %.2fs, map preloading saved %.2fs%s."),
+				Timings.TimeToTravelSeconds, Timings.OverlapSavedSeconds, Request->bMapPreloadCompleted ? TEXT("") : TEXT(" and is still running"));
+		}
+
 		PlayerController->ClientTravel(PendingClientTravelURL, TRAVEL_Absolute);
+
+		const uint64 CorrelationId = Request->CorrelationId;
+		Request->OnJoinSessionCompleted.Broadcast(SessionName);
+		Request->CompleteRequest();
+		CompleteScheduledRequest(CorrelationId);
+	}
+	else if (Result == EOnJoinSessionCompleteResult::SessionIsFull && Request->CandidateIndex + 1 < Request->JoinCandidates.Num())
+	{
+		/* Hosts without reservations only tell once the join failed */
+		UE_LOG(LogEnhancedSubsystem, Warning, TEXT("Session is full, trying the next one."));
+
+		Request->CandidateIndex++;
+		TryNextJoinCandidate();
 	}
 	else
 	{
-		UE_LOG(LogEnhancedSubsystem, Error, TEXT("Failed to join session."));
+		FailJoinRequest(TEXT("Failed to join session."));
 	}
-
-	Sessions->ClearOnJoinSessionCompleteDelegate_Handle(JoinSessionDelegateHandle);
-	JoinSessionDelegateHandle.Reset();
 }
 
 void UEnhancedOnlineSessionsSubsystem::StartOnlineSession(UEnhancedOnlineRequest_StartSession* Request)
@@ -402,36 +765,105 @@ void UEnhancedOnlineSessionsSubsystem::StartOnlineSession(UEnhancedOnlineRequest
 		return;
 	}
 
-	StartSessionDelegateHandle = Sessions->AddOnStartSessionCompleteDelegate_Handle(FOnStartSessionCompleteDelegate::CreateUObject(this, &ThisClass::HandleStartOnlineSessionComplete));
-	PendingStartSessionRequest = Request;
+	/* A second start of the same session waits for the first one, other sessions start alongside */
+	ScheduleRequest(Request, EEnhancedRequestCategory::StartSession, Request->SessionName,
+		FOnEnhancedScheduledRequestStart::CreateUObject(this, &ThisClass::RunStartSessionRequest));
+}
+
+void UEnhancedOnlineSessionsSubsystem::RunStartSessionRequest(uint64 CorrelationId)
+{
+	UEnhancedOnlineRequest_StartSession* Request = GetScheduledRequest<UEnhancedOnlineRequest_StartSession>(CorrelationId);
+	if (!IsValid(Request))
+	{
+		CompleteScheduledRequest(CorrelationId);
+		return;
+	}
+
+	/* Only a hosted session that waits for its match can be started, sessions the subsystem doesn't host are left to the online service */
+	const EEnhancedHostedSessionState State = GetHostedSessionState(Request->SessionName);
+	if (State != EEnhancedHostedSessionState::None && State != EEnhancedHostedSessionState::Pending)
+	{
+		UE_LOG(LogEnhancedSubsystem, Error, TEXT("Can't start session %s in state %s."), *Request->SessionName.ToString(), *UEnum::GetValueAsString(State));
+		Request->OnRequestFailedDelegate.Broadcast(FString::Printf(TEXT("Can't start session %s in state %s."), *Request->SessionName.ToString(), *UEnum::GetValueAsString(State)));
+		Request->CompleteRequest();
+		CompleteScheduledRequest(CorrelationId);
+		return;
+	}
+
+	IOnlineSessionPtr Sessions = Request->Sessions;
+
+	if (!StartSessionDelegateHandle.IsValid())
+	{
+		StartSessionDelegateHandle = Sessions->AddOnStartSessionCompleteDelegate_Handle(FOnStartSessionCompleteDelegate::CreateUObject(this, &ThisClass::HandleStartOnlineSessionComplete));
+	}
+
+	SetHostedSessionState(Request->SessionName, EEnhancedHostedSessionState::Starting);
 
-	if (!Sessions->StartSession(NAME_GameSession))
+	if (!Sessions->StartSession(Request->SessionName))
 	{
 		UE_LOG(LogEnhancedSubsystem, Error, TEXT("Failed to start session."));
 		Request->OnRequestFailedDelegate.Broadcast(TEXT("Failed to start session."));
 
-		Sessions->ClearOnStartSessionCompleteDelegate_Handle(StartSessionDelegateHandle);
-		StartSessionDelegateHandle.Reset();
+		SetHostedSessionState(Request->SessionName, EEnhancedHostedSessionState::Pending);
+		Request->CompleteRequest();
+		CompleteScheduledRequest(CorrelationId);
+		ClearStartSessionDelegateIfIdle();
 	}
 }
 
 void UEnhancedOnlineSessionsSubsystem::HandleStartOnlineSessionComplete(FName SessionName, bool bWasSuccessful)
 {
-	if (PendingStartSessionRequest == nullptr)
+	/* The session lane maps the backend completion back to the request that started it */
+	UEnhancedOnlineRequest_StartSession* Request = FindRunningRequest<UEnhancedOnlineRequest_StartSession>(EEnhancedRequestCategory::StartSession, SessionName);
+	if (Request == nullptr)
 	{
-		UE_LOG(LogEnhancedSubsystem, Error, TEXT("Start Online Session was called with a bad request."));
+		HandleLateStartSessionComplete(SessionName, bWasSuccessful);
 		return;
 	}
 
+	const uint64 CorrelationId = Request->CorrelationId;
+
+	if (FEnhancedHostedSession* HostedSession = HostedSessions.Find(SessionName))
+	{
+		HostedSession->bIsAwaitingLateStart = false;
+	}
+	SetHostedSessionState(SessionName, bWasSuccessful ? EEnhancedHostedSessionState::InProgress : EEnhancedHostedSessionState::Pending);
+
 	if (bWasSuccessful)
 	{
-		PendingStartSessionRequest->OnStartSessionCompleted.Broadcast(SessionName, true);
+		Request->OnStartSessionCompleted.Broadcast(SessionName, true);
 	}
 	else
 	{
-		PendingStartSessionRequest->OnRequestFailedDelegate.Broadcast(TEXT("Failed to start session."));
+		Request->OnRequestFailedDelegate.Broadcast(TEXT("Failed to start session."));
 	}
 
-	PendingStartSessionRequest->Sessions->ClearOnStartSessionCompleteDelegate_Handle(StartSessionDelegateHandle);
-	StartSessionDelegateHandle.Reset();
-}
\ No newline at end of file
+	/* Queued starts of the session may begin right away and need the delegate */
+	Request->CompleteRequest();
+	CompleteScheduledRequest(CorrelationId);
+	ClearStartSessionDelegateIfIdle();
+}
+
+void UEnhancedOnlineSessionsSubsystem::HandleLateStartSessionComplete(FName SessionName, bool bWasSuccessful)
+{
+	FEnhancedHostedSession* HostedSession = HostedSessions.Find(SessionName);
+	if (HostedSession == nullptr || !HostedSession->bIsAwaitingLateStart)
+	{
+		UE_LOG(LogEnhancedSubsystem, Verbose, TEXT("Session %s was started without a start request."), *SessionName.ToString());
+		return;
+	}
+
+	HostedSession->bIsAwaitingLateStart = false;
+
+	ClearStartSessionDelegateIfIdle();
+
+	/* The caller was told the start timed out, end the match the online service started after all so both sides wait for the next one */
+	IOnlineSessionPtr Sessions = Online::GetSessionInterface(GetWorld());
+	const FNamedOnlineSession* NamedSession = Sessions ? Sessions->GetNamedSession(SessionName) : nullptr;
+	if (bWasSuccessful && NamedSession && NamedSession->SessionState == EOnlineSessionState::InProgress && HostedSession->State == EEnhancedHostedSessionState::Pending)
+	{
+		UE_LOG(LogEnhancedSubsystem, Warning, TEXT("Session %s started after its start timed out, ending it again."), *SessionName.ToString());
+		SetHostedSessionState(SessionName, EEnhancedHostedSessionState::InProgress);
+		EndHostedSession(SessionName);
+	}
+}
@@ -0,0 +1,266 @@
+// Copyright © 2024 MajorT. All rights reserved.
+
+#include "EnhancedOnlineSessionsSubsystem.h"
+
+#include "EnhancedOnlineRequests.h"
+#include "EnhancedOnlineSettingsPublisher.h"
+#include "EnhancedOnlineSubsystem.h"
+#include "OnlineSessionSettings.h"
+#include "TimerManager.h"
+#include "Engine/GameInstance.h"
+#include "Interfaces/OnlineSessionInterface.h"
+#include "Online/OnlineSessionNames.h"
+
+void UEnhancedOnlineSessionsSubsystem::RecycleOnlineSession(UEnhancedOnlineRequest_RecycleSession* Request)
+{
+	if (Request == nullptr)
+	{
+		UE_LOG(LogEnhancedSubsystem, Error, TEXT("Recycle Online Session was called with a bad request."));
+		return;
+	}
+
+	if (Request->Sessions == nullptr)
+	{
+		UE_LOG(LogEnhancedSubsystem, Error, TEXT("Recycle Online Session was called with a bad session interface."));
+		Request->OnRequestFailedDelegate.Broadcast(TEXT("Recycle Online Session was called with a bad session interface."));
+		return;
+	}
+
+	FEnhancedHostedSession* HostedSession = HostedSessions.Find(Request->SessionName);
+	if (HostedSession == nullptr || !HostedSession->SessionSettings.IsValid())
+	{
+		UE_LOG(LogEnhancedSubsystem, Error, TEXT("Recycle Online Session was called with a session that isn't hosted: %s."), *Request->SessionName.ToString());
+		Request->OnRequestFailedDelegate.Broadcast(FString::Printf(TEXT("Recycle Online Session was called with a session that isn't hosted: %s."), *Request->SessionName.ToString()));
+		return;
+	}
+
+	if (HostedSession->State == EEnhancedHostedSessionState::Creating || HostedSession->State == EEnhancedHostedSessionState::Destroying)
+	{
+		UE_LOG(LogEnhancedSubsystem, Error, TEXT("Session %s cannot be recycled while it is being created or destroyed."), *Request->SessionName.ToString());
+		Request->OnRequestFailedDelegate.Broadcast(FString::Printf(TEXT("Session %s cannot be recycled while it is being created or destroyed."), *Request->SessionName.ToString()));
+		return;
+	}
+
+	FString MapName;
+	if (Request->MapId.IsValid())
+	{
+		MapName = Request->GetMapName();
+		if (MapName.IsEmpty())
+		{
+			UE_LOG(LogEnhancedSubsystem, Error, TEXT("Can't find the asset data for MapId %s."), *Request->MapId.ToString());
+			Request->OnRequestFailedDelegate.Broadcast(FString::Printf(TEXT("Can't find the asset data for MapId %s."), *Request->MapId.ToString()));
+			return;
+		}
+	}
+
+	/* A recycle is waited on by the caller, it skips the minimum interval of live setting changes */
+	FEnhancedSessionSettingsPublisher& Publisher = *HostedSession->Publisher;
+	if (!MapName.IsEmpty())
+	{
+		Publisher.Set(SETTING_MAPNAME, MapName, EOnlineDataAdvertisementType::ViaOnlineService, EEnhancedSettingPublishPriority::High);
+		HostedSession->TravelURL.Map = MapName;
+	}
+
+	if (!Request->GameModeAdvertisementName.IsEmpty())
+	{
+		Publisher.Set(SETTING_GAMEMODE, Request->GameModeAdvertisementName, EOnlineDataAdvertisementType::ViaOnlineService, EEnhancedSettingPublishPriority::High);
+	}
+
+	if (!Request->FriendlyName.IsEmpty())
+	{
+		Publisher.Set(SETTING_FRIENDLYNAME, Request->FriendlyName, EOnlineDataAdvertisementType::ViaOnlineService, EEnhancedSettingPublishPriority::High);
+	}
+
+	if (Request->bOverrideAllowJoinInProgress)
+	{
+		Publisher.SetAllowJoinInProgress(Request->bAllowJoinInProgress, EEnhancedSettingPublishPriority::High);
+	}
+
+	HostedSession->PendingRecycleRequests.Add(Request);
+	ScheduleHostedSessionUpdate(Request->SessionName);
+}
+
+bool UEnhancedOnlineSessionsSubsystem::SetHostedSessionIntSetting(FName SessionName, FName Key, int32 Value, EEnhancedSettingPublishPriority Priority)
+{
+	if (TSharedPtr<FEnhancedSessionSettingsPublisher> Publisher = GetHostedSessionPublisher(SessionName))
+	{
+		Publisher->Set(Key, Value, EOnlineDataAdvertisementType::ViaOnlineService, Priority);
+		return true;
+	}
+	return false;
+}
+
+bool UEnhancedOnlineSessionsSubsystem::SetHostedSessionFloatSetting(FName SessionName, FName Key, float Value, EEnhancedSettingPublishPriority Priority)
+{
+	if (TSharedPtr<FEnhancedSessionSettingsPublisher> Publisher = GetHostedSessionPublisher(SessionName))
+	{
+		Publisher->Set(Key, Value, EOnlineDataAdvertisementType::ViaOnlineService, Priority);
+		return true;
+	}
+	return false;
+}
+
+bool UEnhancedOnlineSessionsSubsystem::SetHostedSessionStringSetting(FName SessionName, FName Key, const FString& Value, EEnhancedSettingPublishPriority Priority)
+{
+	if (TSharedPtr<FEnhancedSessionSettingsPublisher> Publisher = GetHostedSessionPublisher(SessionName))
+	{
+		Publisher->Set(Key, Value, EOnlineDataAdvertisementType::ViaOnlineService, Priority);
+		return true;
+	}
+	return false;
+}
+
+FEnhancedSessionPublishStats UEnhancedOnlineSessionsSubsystem::GetHostedSessionPublishStats(FName SessionName) const
+{
+	const TSharedPtr<FEnhancedSessionSettingsPublisher> Publisher = GetHostedSessionPublisher(SessionName);
+	return Publisher.IsValid() ? Publisher->GetStats() : FEnhancedSessionPublishStats();
+}
+
+TSharedPtr<FEnhancedSessionSettingsPublisher> UEnhancedOnlineSessionsSubsystem::GetHostedSessionPublisher(const FName SessionName) const
+{
+	const FEnhancedHostedSession* HostedSession = HostedSessions.Find(SessionName);
+	return HostedSession ? HostedSession->Publisher : nullptr;
+}
+
+void UEnhancedOnlineSessionsSubsystem::ScheduleHostedSessionUpdate(const FName SessionName)
+{
+	FEnhancedHostedSession* HostedSession = HostedSessions.Find(SessionName);
+	UGameInstance* GameInstance = GetGameInstance();
+	if (HostedSession == nullptr || GameInstance == nullptr || !HostedSession->Publisher.IsValid())
+	{
+		return;
+	}
+
+	/* Changes made while the session is created, destroyed or updated are scheduled once that completed */
+	if (HostedSession->bIsUpdating
+		|| HostedSession->State == EEnhancedHostedSessionState::Creating
+		|| HostedSession->State == EEnhancedHostedSessionState::Destroying)
+	{
+		return;
+	}
+
+	const double Now = FPlatformTime::Seconds();
+	double PublishTime = HostedSession->Publisher->GetPublishTime();
+
+	/* Recycles that changed nothing are still answered */
+	if (PublishTime <= 0.0 && !HostedSession->PendingRecycleRequests.IsEmpty())
+	{
+		PublishTime = Now;
+	}
+
+	FTimerManager& TimerManager = GameInstance->GetTimerManager();
+	if (PublishTime <= 0.0)
+	{
+		TimerManager.ClearTimer(HostedSession->UpdateTimerHandle);
+		return;
+	}
+
+	const float Delay = FMath::Max(static_cast<float>(PublishTime - Now), KINDA_SMALL_NUMBER);
+	if (TimerManager.IsTimerActive(HostedSession->UpdateTimerHandle) && TimerManager.GetTimerRemaining(HostedSession->UpdateTimerHandle) <= Delay)
+	{
+		return;
+	}
+
+	TimerManager.SetTimer(HostedSession->UpdateTimerHandle,
+		FTimerDelegate::CreateUObject(this, &ThisClass::FlushHostedSessionUpdate, SessionName),
+		Delay, false);
+}
+
+void UEnhancedOnlineSessionsSubsystem::FlushHostedSessionUpdate(const FName SessionName)
+{
+	FEnhancedHostedSession* HostedSession = HostedSessions.Find(SessionName);
+	IOnlineSessionPtr Sessions = Online::GetSessionInterface(GetWorld());
+	if (HostedSession == nullptr || HostedSession->bIsUpdating || Sessions == nullptr)
+	{
+		return;
+	}
+
+	HostedSession->UpdateTimerHandle.Invalidate();
+	HostedSession->UpdatingRecycleRequests = MoveTemp(HostedSession->PendingRecycleRequests);
+	HostedSession->PendingRecycleRequests.Reset();
+	HostedSession->bIsUpdating = true;
+	HostedSession->UpdateStartTime = FPlatformTime::Seconds();
+
+	FOnlineSessionSettings* CurrentSettings = Sessions->GetSessionSettings(SessionName);
+	if (CurrentSettings == nullptr)
+	{
+		UE_LOG(LogEnhancedSubsystem, Error, TEXT("The online service doesn't know session %s anymore."), *SessionName.ToString());
+		SetHostedSessionState(SessionName, EEnhancedHostedSessionState::Destroyed);
+		return;
+	}
+
+	FOnlineSessionSettings UpdatedSettings;
+	const int32 NumChanges = HostedSession->Publisher->BeginPublish(*CurrentSettings, UpdatedSettings);
+
+	/* Nothing differs, skip the round trip */
+	if (NumChanges == 0)
+	{
+		UE_LOG(LogEnhancedSubsystem, Verbose, TEXT("Session %s is already up to date."), *SessionName.ToString());
+		HandleUpdateSessionComplete(SessionName, true);
+		return;
+	}
+
+	if (!UpdateSessionDelegateHandle.IsValid())
+	{
+		UpdateSessionDelegateHandle = Sessions->AddOnUpdateSessionCompleteDelegate_Handle(FOnUpdateSessionCompleteDelegate::CreateUObject(this, &ThisClass::HandleUpdateSessionComplete));
+	}
+
+	UE_LOG(LogEnhancedSubsystem, Log, TEXT("Updating %d settings of session %s for %d requests..."), NumChanges, *SessionName.ToString(), HostedSession->UpdatingRecycleRequests.Num());
+
+	StartHostedSessionWatchdog();
+
+	if (!Sessions->UpdateSession(SessionName, UpdatedSettings, true))
+	{
+		UE_LOG(LogEnhancedSubsystem, Error, TEXT("Failed to update session %s."), *SessionName.ToString());
+		HandleUpdateSessionComplete(SessionName, false);
+	}
+}
+
+void UEnhancedOnlineSessionsSubsystem::HandleUpdateSessionComplete(FName SessionName, bool bWasSuccessful)
+{
+	FEnhancedHostedSession* HostedSession = HostedSessions.Find(SessionName);
+	if (HostedSession == nullptr || !HostedSession->bIsUpdating)
+	{
+		return;
+	}
+
+	HostedSession->Publisher->EndPublish(bWasSuccessful);
+
+	TArray<TObjectPtr<UEnhancedOnlineRequest_RecycleSession>> Requests = MoveTemp(HostedSession->UpdatingRecycleRequests);
+	HostedSession->UpdatingRecycleRequests.Reset();
+	HostedSession->bIsUpdating = false;
+
+	const FURL TravelURL = HostedSession->TravelURL;
+
+	ClearStaleHostedSessionDelegates();
+
+	bool bShouldTravel = false;
+	for (UEnhancedOnlineRequest_RecycleSession* Request : Requests)
+	{
+		if (Request == nullptr)
+		{
+			continue;
+		}
+
+		if (bWasSuccessful)
+		{
+			bShouldTravel |= Request->bTravelToMap && Request->MapId.IsValid();
+			Request->OnRecycleSessionCompleted.Broadcast(SessionName);
+		}
+		else
+		{
+			Request->OnRequestFailedDelegate.Broadcast(FString::Printf(TEXT("Failed to update session %s."), *SessionName.ToString()));
+		}
+
+		Request->CompleteRequest();
+	}
+
+	/* Only the game session moves the host, the session itself stays advertised during the travel */
+	if (bShouldTravel && SessionName == NAME_GameSession && !TravelURL.Map.IsEmpty())
+	{
+		GetWorld()->ServerTravel(TravelURL.ToString());
+	}
+
+	/* Changes made during the update, or the ones that failed, go out with the next one */
+	ScheduleHostedSessionUpdate(SessionName);
+}
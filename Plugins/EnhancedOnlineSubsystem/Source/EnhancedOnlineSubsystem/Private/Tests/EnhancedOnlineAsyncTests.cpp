@@ -0,0 +1,124 @@
+// Copyright © 2024 MajorT. All rights reserved.
+
+#include "EnhancedOnlineAsync.h"
+#include "EnhancedOnlineMapRegistry.h"
+#include "EnhancedOnlineRequests.h"
+#include "EnhancedOnlineSessionsSubsystem.h"
+#include "OnlineSubsystemUtils.h"
+#include "Engine/Engine.h"
+#include "Engine/GameInstance.h"
+#include "Engine/World.h"
+#include "Misc/AutomationTest.h"
+#include "UObject/StrongObjectPtr.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace
+{
+	/** Map the offline session travels to, skipped if the project doesn't have it */
+	const FPrimaryAssetId OfflineMapId(TEXT("Map"), TEXT("SessionMap"));
+
+	struct FOfflineHostingTestState
+	{
+		TStrongObjectPtr<UGameInstance> GameInstance;
+		TOptional<TFuture<FEnhancedOnlineResult>> MissingMapFuture;
+		TOptional<TFuture<FEnhancedOnlineResult>> OfflineFuture;
+		int32 RecycledRequests = 0;
+	};
+
+	TFuture<FEnhancedOnlineResult> HostOfflineSession(UEnhancedOnlineSessionsSubsystem* Subsystem, const FPrimaryAssetId& MapId)
+	{
+		UEnhancedOnlineRequest_CreateSession* Request = UEnhancedOnlineSessionsSubsystem::AcquireRequest<UEnhancedOnlineRequest_CreateSession>(Subsystem);
+		Request->ConstructRequest();
+		Request->SessionName = NAME_GameSession;
+		Request->OnlineMode = EEnhancedSessionOnlineMode::Offline;
+		Request->MapId = MapId;
+		Request->MaxPlayerCount = 1;
+		Request->bInvalidateOnCompletion = true;
+
+		return Subsystem->HostOnlineSessionAsync(Request);
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FEnhancedOnlineOfflineHostingTest, "EnhancedOnline.Async.HostOfflineSession",
+	EAutomationTestFlags::ServerContext | EAutomationTestFlags::ProductFilter)
+
+bool FEnhancedOnlineOfflineHostingTest::RunTest(const FString& Parameters)
+{
+	TSharedRef<FOfflineHostingTestState> State = MakeShared<FOfflineHostingTestState>();
+	State->GameInstance.Reset(NewObject<UGameInstance>(GEngine));
+	State->GameInstance->InitializeStandalone();
+
+	UWorld* World = State->GameInstance->GetWorld();
+	if (Online::GetSubsystem(World) == nullptr || World->GetNetMode() != NM_DedicatedServer)
+	{
+		AddInfo(TEXT("Skipped, the test hosts without a local player and needs a dedicated server running an online subsystem."));
+		State->GameInstance->Shutdown();
+		return true;
+	}
+
+	UEnhancedOnlineSessionsSubsystem* Subsystem = State->GameInstance->GetSubsystem<UEnhancedOnlineSessionsSubsystem>();
+	if (!TestNotNull(TEXT("The game instance runs the sessions subsystem"), Subsystem))
+	{
+		State->GameInstance->Shutdown();
+		return false;
+	}
+
+	State->RecycledRequests = Subsystem->GetRequestPoolStats().Recycled;
+	State->MissingMapFuture = HostOfflineSession(Subsystem, FPrimaryAssetId(TEXT("Map"), TEXT("EnhancedOnlineMissingMap")));
+
+	ADD_LATENT_AUTOMATION_COMMAND(FFunctionLatentCommand([State]()
+	{
+		return State->MissingMapFuture->IsReady();
+	}));
+
+	ADD_LATENT_AUTOMATION_COMMAND(FFunctionLatentCommand([this, State]()
+	{
+		UEnhancedOnlineSessionsSubsystem* Subsystem = State->GameInstance->GetSubsystem<UEnhancedOnlineSessionsSubsystem>();
+
+		const FEnhancedOnlineResult& Result = State->MissingMapFuture->Get();
+		TestFalse(TEXT("Hosting on a missing map fails"), Result.bWasSuccessful);
+		TestFalse(TEXT("The failure has a reason"), Result.Error.IsEmpty());
+		TestEqual(TEXT("The failed request is completed and returns to the pool"), Subsystem->GetRequestPoolStats().Recycled, State->RecycledRequests + 1);
+
+		FEnhancedMapRegistryEntry MapEntry;
+		if (!FEnhancedMapRegistry::ResolveMap(Subsystem, OfflineMapId, MapEntry))
+		{
+			AddInfo(FString::Printf(TEXT("Skipped hosting on a map, the project has no map %s."), *OfflineMapId.ToString()));
+			return true;
+		}
+
+		State->RecycledRequests = Subsystem->GetRequestPoolStats().Recycled;
+		State->OfflineFuture = HostOfflineSession(Subsystem, OfflineMapId);
+
+		/* The future is set as soon as the travel is under way, cancel it so the test world stays where it is */
+		State->GameInstance->GetWorld()->NextURL.Empty();
+		return true;
+	}));
+
+	ADD_LATENT_AUTOMATION_COMMAND(FFunctionLatentCommand([State]()
+	{
+		return !State->OfflineFuture.IsSet() || State->OfflineFuture->IsReady();
+	}));
+
+	ADD_LATENT_AUTOMATION_COMMAND(FFunctionLatentCommand([this, State]()
+	{
+		if (State->OfflineFuture.IsSet())
+		{
+			const UEnhancedOnlineSessionsSubsystem* Subsystem = State->GameInstance->GetSubsystem<UEnhancedOnlineSessionsSubsystem>();
+
+			const FEnhancedOnlineResult& Result = State->OfflineFuture->Get();
+			TestTrue(TEXT("Hosting an offline session succeeds"), Result.bWasSuccessful);
+			TestEqual(TEXT("The hosted session is reported"), Result.SessionName, FName(NAME_GameSession));
+			TestEqual(TEXT("The request is completed and returns to the pool"), Subsystem->GetRequestPoolStats().Recycled, State->RecycledRequests + 1);
+		}
+
+		State->GameInstance->Shutdown();
+		State->GameInstance.Reset();
+		return true;
+	}));
+
+	return true;
+}
+
+#endif
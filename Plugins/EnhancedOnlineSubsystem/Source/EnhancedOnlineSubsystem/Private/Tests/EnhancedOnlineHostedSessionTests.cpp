@@ -0,0 +1,133 @@
+// Copyright © 2024 MajorT. All rights reserved.
+
+#include "EnhancedOnlineRequests.h"
+#include "EnhancedOnlineSessionsSubsystem.h"
+#include "OnlineSubsystemNames.h"
+#include "OnlineSubsystemUtils.h"
+#include "Engine/Engine.h"
+#include "Engine/GameInstance.h"
+#include "Engine/World.h"
+#include "Misc/AutomationTest.h"
+#include "UObject/StrongObjectPtr.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace
+{
+	/** Names of the sessions the test hosts next to each other, none of them is the game session so the host never travels */
+	const FName FirstSessionName(TEXT("EnhancedOnlineTestSessionA"));
+	const FName SecondSessionName(TEXT("EnhancedOnlineTestSessionB"));
+
+	struct FHostedSessionTestState
+	{
+		TStrongObjectPtr<UGameInstance> GameInstance;
+		TArray<FName> CreatedSessions;
+		TArray<FString> Failures;
+	};
+
+	void HostTestSession(UEnhancedOnlineSessionsSubsystem* Subsystem, const TSharedRef<FHostedSessionTestState>& State, const FName SessionName)
+	{
+		UEnhancedOnlineRequest_CreateSession* Request = UEnhancedOnlineSessionsSubsystem::AcquireRequest<UEnhancedOnlineRequest_CreateSession>(Subsystem);
+		Request->ConstructRequest();
+		Request->SessionName = SessionName;
+		Request->OnlineMode = EEnhancedSessionOnlineMode::LAN;
+		Request->MaxPlayerCount = 4;
+		Request->FriendlyName = SessionName.ToString();
+		Request->bIsDedicated = true;
+		Request->bInvalidateOnCompletion = true;
+
+		Request->OnCreateSessionCompleted.AddLambda([State](int32 LocalUserIndex, const FName CreatedSession)
+		{
+			State->CreatedSessions.Add(CreatedSession);
+		});
+		Request->OnRequestFailedDelegate.AddLambda([State](const FString& Reason)
+		{
+			State->Failures.Add(Reason);
+		});
+
+		Subsystem->HostOnlineSession(Request);
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FEnhancedOnlineHostedSessionsTest, "EnhancedOnline.Sessions.MultipleHostedSessions",
+	EAutomationTestFlags::ServerContext | EAutomationTestFlags::ProductFilter)
+
+bool FEnhancedOnlineHostedSessionsTest::RunTest(const FString& Parameters)
+{
+	TSharedRef<FHostedSessionTestState> State = MakeShared<FHostedSessionTestState>();
+	State->GameInstance.Reset(NewObject<UGameInstance>(GEngine));
+	State->GameInstance->InitializeStandalone();
+
+	UWorld* World = State->GameInstance->GetWorld();
+	const IOnlineSubsystem* OnlineSub = Online::GetSubsystem(World);
+	if (OnlineSub == nullptr || OnlineSub->GetSubsystemName() != NULL_SUBSYSTEM || World->GetNetMode() != NM_DedicatedServer)
+	{
+		AddInfo(TEXT("Skipped, the test hosts without a local player and needs a dedicated server running the Null online subsystem."));
+		State->GameInstance->Shutdown();
+		return true;
+	}
+
+	UEnhancedOnlineSessionsSubsystem* Subsystem = State->GameInstance->GetSubsystem<UEnhancedOnlineSessionsSubsystem>();
+	if (!TestNotNull(TEXT("The game instance runs the sessions subsystem"), Subsystem))
+	{
+		State->GameInstance->Shutdown();
+		return false;
+	}
+
+	HostTestSession(Subsystem, State, FirstSessionName);
+	HostTestSession(Subsystem, State, SecondSessionName);
+
+	ADD_LATENT_AUTOMATION_COMMAND(FFunctionLatentCommand([State]()
+	{
+		return State->CreatedSessions.Num() + State->Failures.Num() >= 2;
+	}));
+
+	ADD_LATENT_AUTOMATION_COMMAND(FFunctionLatentCommand([this, State]()
+	{
+		UEnhancedOnlineSessionsSubsystem* Subsystem = State->GameInstance->GetSubsystem<UEnhancedOnlineSessionsSubsystem>();
+
+		TestEqual(TEXT("No session failed to be created"), State->Failures.Num(), 0);
+		TestTrue(TEXT("The first session was created"), State->CreatedSessions.Contains(FirstSessionName));
+		TestTrue(TEXT("The second session was created"), State->CreatedSessions.Contains(SecondSessionName));
+		TestEqual(TEXT("Both sessions are hosted"), Subsystem->GetHostedSessionNames().Num(), 2);
+		TestEqual(TEXT("The first session waits for its match"), Subsystem->GetHostedSessionState(FirstSessionName), EEnhancedHostedSessionState::Pending);
+		TestEqual(TEXT("The second session waits for its match"), Subsystem->GetHostedSessionState(SecondSessionName), EEnhancedHostedSessionState::Pending);
+
+		TestTrue(TEXT("The first session is being destroyed"), Subsystem->DestroyHostedSession(FirstSessionName));
+		return true;
+	}));
+
+	ADD_LATENT_AUTOMATION_COMMAND(FFunctionLatentCommand([State]()
+	{
+		const UEnhancedOnlineSessionsSubsystem* Subsystem = State->GameInstance->GetSubsystem<UEnhancedOnlineSessionsSubsystem>();
+		return Subsystem->GetHostedSessionState(FirstSessionName) == EEnhancedHostedSessionState::None;
+	}));
+
+	ADD_LATENT_AUTOMATION_COMMAND(FFunctionLatentCommand([this, State]()
+	{
+		UEnhancedOnlineSessionsSubsystem* Subsystem = State->GameInstance->GetSubsystem<UEnhancedOnlineSessionsSubsystem>();
+
+		TestEqual(TEXT("Destroying one session leaves the other alone"), Subsystem->GetHostedSessionState(SecondSessionName), EEnhancedHostedSessionState::Pending);
+		TestTrue(TEXT("The name of the destroyed session can be hosted again"), !Subsystem->GetHostedSessionNames().Contains(FirstSessionName));
+
+		Subsystem->DestroyHostedSession(SecondSessionName);
+		return true;
+	}));
+
+	ADD_LATENT_AUTOMATION_COMMAND(FFunctionLatentCommand([State]()
+	{
+		const UEnhancedOnlineSessionsSubsystem* Subsystem = State->GameInstance->GetSubsystem<UEnhancedOnlineSessionsSubsystem>();
+		if (Subsystem->GetHostedSessionNames().Num() > 0)
+		{
+			return false;
+		}
+
+		State->GameInstance->Shutdown();
+		State->GameInstance.Reset();
+		return true;
+	}));
+
+	return true;
+}
+
+#endif
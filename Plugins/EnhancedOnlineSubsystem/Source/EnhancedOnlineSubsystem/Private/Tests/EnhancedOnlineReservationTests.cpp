@@ -0,0 +1,122 @@
+// Copyright © 2024 MajorT. All rights reserved.
+
+#include "EnhancedOnlineReservation.h"
+#include "IPAddress.h"
+#include "SocketSubsystem.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace
+{
+	/** Port the test host listens on, away from the default reservation port so a running game doesn't interfere */
+	constexpr int32 TestReservationPort = 17788;
+
+	/** State shared by the steps of the test, the host and two clients talking over the loopback */
+	struct FReservationTestState
+	{
+		TSharedPtr<FEnhancedSessionReservationHost> Host;
+		TSharedPtr<FEnhancedSessionReservationClient> FirstClient;
+		TSharedPtr<FEnhancedSessionReservationClient> SecondClient;
+
+		/** Slots the session has left, the players that logged in already took theirs */
+		int32 OpenSlots = 1;
+
+		TOptional<EEnhancedReservationResult> FirstResult;
+		TOptional<EEnhancedReservationResult> SecondResult;
+		TOptional<EEnhancedReservationResult> RetryResult;
+	};
+
+	TSharedPtr<FInternetAddr> MakeHostAddress()
+	{
+		ISocketSubsystem* SocketSubsystem = ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM);
+		TSharedPtr<FInternetAddr> Address = SocketSubsystem ? SocketSubsystem->GetAddressFromString(TEXT("127.0.0.1")) : nullptr;
+		if (Address.IsValid())
+		{
+			Address->SetPort(TestReservationPort);
+		}
+		return Address;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FEnhancedOnlineReservationTest, "EnhancedOnline.Reservations.HostAndClients",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FEnhancedOnlineReservationTest::RunTest(const FString& Parameters)
+{
+	const uint32 SessionKey = FEnhancedSessionReservationHost::MakeSessionKey(TEXT("EnhancedOnlineReservationTest"));
+	const uint64 FirstToken = 1001;
+	const uint64 SecondToken = 1002;
+
+	TSharedRef<FReservationTestState> State = MakeShared<FReservationTestState>();
+	TSharedPtr<FInternetAddr> HostAddress = MakeHostAddress();
+	if (!TestTrue(TEXT("The loopback address resolves"), HostAddress.IsValid()))
+	{
+		return false;
+	}
+
+	State->Host = MakeShared<FEnhancedSessionReservationHost>();
+	State->Host->OnQueryOpenSlots.BindLambda([State, SessionKey](uint32 InSessionKey)
+	{
+		return InSessionKey == SessionKey ? State->OpenSlots : INDEX_NONE;
+	});
+
+	if (!TestTrue(TEXT("The host binds its port"), State->Host->Start(TestReservationPort, 30.f)))
+	{
+		return false;
+	}
+
+	/* Both clients race for the last slot, only one of them gets it */
+	State->FirstClient = MakeShared<FEnhancedSessionReservationClient>(0.5f, 3);
+	State->SecondClient = MakeShared<FEnhancedSessionReservationClient>(0.5f, 3);
+
+	TestTrue(TEXT("The first client sends its request"), State->FirstClient->Start(HostAddress.ToSharedRef(), SessionKey, FirstToken,
+		FOnEnhancedReservationCompleted::CreateLambda([State](EEnhancedReservationResult Result) { State->FirstResult = Result; })));
+
+	ADD_LATENT_AUTOMATION_COMMAND(FFunctionLatentCommand([State]() { return State->FirstResult.IsSet(); }));
+
+	ADD_LATENT_AUTOMATION_COMMAND(FFunctionLatentCommand([this, State, HostAddress, SessionKey, SecondToken]()
+	{
+		TestEqual(TEXT("The first client reserves the slot"), State->FirstResult.GetValue(), EEnhancedReservationResult::Accepted);
+
+		TestTrue(TEXT("The second client sends its request"), State->SecondClient->Start(HostAddress.ToSharedRef(), SessionKey, SecondToken,
+			FOnEnhancedReservationCompleted::CreateLambda([State](EEnhancedReservationResult Result) { State->SecondResult = Result; })));
+		return true;
+	}));
+
+	ADD_LATENT_AUTOMATION_COMMAND(FFunctionLatentCommand([State]() { return State->SecondResult.IsSet(); }));
+
+	ADD_LATENT_AUTOMATION_COMMAND(FFunctionLatentCommand([this, State, HostAddress, SessionKey, FirstToken, SecondToken]()
+	{
+		TestEqual(TEXT("The reserved slot isn't handed out twice"), State->SecondResult.GetValue(), EEnhancedReservationResult::SessionFull);
+
+		/* The first client logs in, its reservation turns into a player of the session */
+		State->OpenSlots = 0;
+		TestTrue(TEXT("The arriving client's reservation is consumed"), State->Host->ConsumeReservation(FirstToken));
+		TestFalse(TEXT("A reservation is consumed only once"), State->Host->ConsumeReservation(FirstToken));
+		TestEqual(TEXT("No reservation is left"), State->Host->GetNumReservations(SessionKey), 0);
+
+		/* The player leaves again, the slot opens up for the client that was turned away */
+		State->OpenSlots = 1;
+		TestTrue(TEXT("The second client asks again"), State->SecondClient->Start(HostAddress.ToSharedRef(), SessionKey, SecondToken,
+			FOnEnhancedReservationCompleted::CreateLambda([State](EEnhancedReservationResult Result) { State->RetryResult = Result; })));
+		return true;
+	}));
+
+	ADD_LATENT_AUTOMATION_COMMAND(FFunctionLatentCommand([State]() { return State->RetryResult.IsSet(); }));
+
+	ADD_LATENT_AUTOMATION_COMMAND(FFunctionLatentCommand([this, State]()
+	{
+		TestEqual(TEXT("The freed slot is reserved by the second client"), State->RetryResult.GetValue(), EEnhancedReservationResult::Accepted);
+
+		State->FirstClient.Reset();
+		State->SecondClient.Reset();
+		State->Host->Stop();
+		State->Host.Reset();
+		return true;
+	}));
+
+	return true;
+}
+
+#endif
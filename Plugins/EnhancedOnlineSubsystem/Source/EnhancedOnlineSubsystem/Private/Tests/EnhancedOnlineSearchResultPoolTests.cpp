@@ -0,0 +1,134 @@
+// Copyright © 2024 MajorT. All rights reserved.
+
+#include "EnhancedOnlineBrowser.h"
+#include "EnhancedOnlineRequests.h"
+#include "EnhancedOnlineSessionsSubsystem.h"
+#include "OnlineSessionSettings.h"
+#include "OnlineSubsystemTypes.h"
+#include "Misc/AutomationTest.h"
+#include "UObject/StrongObjectPtr.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace
+{
+	/** Session info that only carries an id, enough for the browser to tell sessions apart */
+	class FTestSessionInfo : public FOnlineSessionInfo
+	{
+	public:
+		explicit FTestSessionInfo(const FString& InSessionId)
+			: SessionId(FUniqueNetIdString::Create(InSessionId, TEXT("EnhancedOnlineTest")))
+		{}
+
+		virtual const uint8* GetBytes() const override { return nullptr; }
+		virtual int32 GetSize() const override { return 0; }
+		virtual bool IsValid() const override { return true; }
+		virtual FString ToString() const override { return SessionId->ToString(); }
+		virtual FString ToDebugString() const override { return SessionId->ToString(); }
+		virtual const FUniqueNetId& GetSessionId() const override { return *SessionId; }
+
+	private:
+		FUniqueNetIdRef SessionId;
+	};
+
+	/** Returns raw search results for the given session ids, as a refresh of the online service would */
+	TArray<FOnlineSessionSearchResult> MakeSearchResults(const TArray<FString>& SessionIds)
+	{
+		TArray<FOnlineSessionSearchResult> SearchResults;
+		for (const FString& SessionId : SessionIds)
+		{
+			FOnlineSessionSearchResult& SearchResult = SearchResults.AddDefaulted_GetRef();
+			SearchResult.Session.SessionInfo = MakeShared<FTestSessionInfo>(SessionId);
+		}
+		return SearchResults;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FEnhancedOnlineSearchResultPoolTest, "EnhancedOnline.Sessions.SearchResultPool",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FEnhancedOnlineSearchResultPoolTest::RunTest(const FString& Parameters)
+{
+	TStrongObjectPtr<UEnhancedOnlineSessionsSubsystem> Subsystem(NewObject<UEnhancedOnlineSessionsSubsystem>());
+	TStrongObjectPtr<UEnhancedOnlineRequest_FindSessions> Request(NewObject<UEnhancedOnlineRequest_FindSessions>(Subsystem.Get()));
+
+	/* Runs a search the way a completed backend search does, the search releases its results once the request retained them */
+	auto RefreshSearch = [&Subsystem, &Request](const int32 NumSessions)
+	{
+		TArray<UEnhancedSessionSearchResult*> Results;
+		for (int32 Index = 0; Index < NumSessions; ++Index)
+		{
+			Results.Add(Subsystem->AcquireSearchResult(FOnlineSessionSearchResult()));
+		}
+
+		Subsystem->DeliverSessionSearchResults(Request.Get(), Results);
+
+		for (UEnhancedSessionSearchResult* Result : Results)
+		{
+			Subsystem->ReleaseSearchResult(Result);
+		}
+	};
+
+	RefreshSearch(2);
+
+	const FEnhancedSearchResultPoolStats FirstStats = Subsystem->GetSearchResultPoolStats();
+	TestEqual(TEXT("The first results are allocated"), FirstStats.Misses, 2);
+	TestEqual(TEXT("The first results are kept by the request"), FirstStats.Recycled, 0);
+	TestEqual(TEXT("The request holds the results it received"), Request->SearchResults.Num(), 2);
+
+	/* The refresh replaces the results the request held, those return to the pool */
+	RefreshSearch(2);
+
+	const FEnhancedSearchResultPoolStats SecondStats = Subsystem->GetSearchResultPoolStats();
+	TestEqual(TEXT("The replaced results return to the pool"), SecondStats.Recycled, 2);
+	TestEqual(TEXT("The replaced results wait in the pool"), SecondStats.Pooled, 2);
+
+	/* The next refresh takes the objects of the replaced results */
+	RefreshSearch(2);
+
+	const FEnhancedSearchResultPoolStats ThirdStats = Subsystem->GetSearchResultPoolStats();
+	TestTrue(TEXT("Refreshing reuses pooled results"), ThirdStats.Hits > 0);
+	TestEqual(TEXT("No result is allocated while the pool has one"), ThirdStats.Misses, SecondStats.Misses);
+
+	/* Without a game instance the browser doesn't schedule refreshes, the test drives them */
+	TStrongObjectPtr<UEnhancedOnlineSessionsSubsystem> BrowserSubsystem(NewObject<UEnhancedOnlineSessionsSubsystem>());
+	TStrongObjectPtr<UEnhancedSessionBrowserSubscription> Subscription(NewObject<UEnhancedSessionBrowserSubscription>());
+	Subscription->bIsSubscribed = true;
+
+	TArray<FEnhancedSessionBrowserDelta> Deltas;
+	Subscription->OnBrowserUpdated.AddLambda([&Deltas](const FEnhancedSessionBrowserDelta& Delta)
+	{
+		Deltas.Add(Delta);
+	});
+
+	const TWeakObjectPtr<UEnhancedSessionBrowserSubscription> WeakSubscription = Subscription.Get();
+	BrowserSubsystem->HandleSessionBrowserRefreshed(MakeSearchResults({ TEXT("A"), TEXT("B") }), true, WeakSubscription);
+
+	const FEnhancedSearchResultPoolStats FirstBrowserStats = BrowserSubsystem->GetSearchResultPoolStats();
+	TestEqual(TEXT("The first sessions are allocated"), FirstBrowserStats.Misses, 2);
+	TestEqual(TEXT("The first sessions are kept by the subscription"), FirstBrowserStats.Recycled, 0);
+
+	/* Both sessions close and two others open, the closed ones are released once the delta was handled */
+	BrowserSubsystem->HandleSessionBrowserRefreshed(MakeSearchResults({ TEXT("C"), TEXT("D") }), true, WeakSubscription);
+
+	const FEnhancedSearchResultPoolStats SecondBrowserStats = BrowserSubsystem->GetSearchResultPoolStats();
+	TestEqual(TEXT("The removed sessions are reported"), Deltas.Num() == 2 ? Deltas[1].Removed.Num() : 0, 2);
+	TestEqual(TEXT("The removed sessions return to the pool"), SecondBrowserStats.Recycled, 2);
+	TestEqual(TEXT("The removed sessions wait in the pool"), SecondBrowserStats.Pooled, 2);
+
+	/* The next sessions that show up take the objects of the removed ones */
+	BrowserSubsystem->HandleSessionBrowserRefreshed(MakeSearchResults({ TEXT("C"), TEXT("D"), TEXT("E") }), true, WeakSubscription);
+
+	const FEnhancedSearchResultPoolStats ThirdBrowserStats = BrowserSubsystem->GetSearchResultPoolStats();
+	TestTrue(TEXT("New sessions reuse pooled results"), ThirdBrowserStats.Hits > 0);
+	TestEqual(TEXT("No session is allocated while the pool has one"), ThirdBrowserStats.Misses, SecondBrowserStats.Misses);
+	TestEqual(TEXT("The live set holds the current sessions"), Subscription->GetSessions().Num(), 3);
+
+	/* Unsubscribing hands the live set back to the pool */
+	BrowserSubsystem->UnsubscribeFromSessionBrowser(Subscription.Get());
+	TestEqual(TEXT("Every session is back in the pool"), BrowserSubsystem->GetSearchResultPoolStats().Pooled, 4);
+
+	return true;
+}
+
+#endif
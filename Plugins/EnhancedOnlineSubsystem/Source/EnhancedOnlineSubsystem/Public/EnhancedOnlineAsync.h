@@ -0,0 +1,60 @@
+// Copyright © 2024 MajorT. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Async/Future.h"
+
+class UEnhancedSessionSearchResult;
+
+/**
+ * Outcome of a request awaited through a future
+ * Only the fields filled by the kind of request are set, the rest keep their defaults
+ */
+struct ENHANCEDONLINESUBSYSTEM_API FEnhancedOnlineResult
+{
+	/** Whether the request succeeded */
+	bool bWasSuccessful = false;
+
+	/** The reason the request failed, empty if it succeeded */
+	FString Error;
+
+	/** The local user a login was made for */
+	int32 LocalUserIndex = INDEX_NONE;
+
+	/** The session that was hosted, joined or started */
+	FName SessionName;
+
+	/** The long package name of a preloaded map */
+	FName PackageName;
+
+	/** The sessions a search found, not kept alive by the result, they stay valid until the request searches again or is reused */
+	TArray<UEnhancedSessionSearchResult*> SearchResults;
+
+	static FEnhancedOnlineResult Failure(const FString& InError)
+	{
+		FEnhancedOnlineResult Result;
+		Result.Error = InError;
+		return Result;
+	}
+};
+
+/**
+ * Combinators for the futures returned by the async functions of the sessions subsystem
+ * Requests complete on the game thread, so the combined futures do too
+ */
+class ENHANCEDONLINESUBSYSTEM_API FEnhancedOnlineAsync
+{
+public:
+	/** Returns a future that is set once every future is set, with their results in the order of the futures */
+	static TFuture<TArray<FEnhancedOnlineResult>> WhenAll(TArray<TFuture<FEnhancedOnlineResult>>&& Futures);
+
+	/** Returns a future that is set by the first future that is set, with its index and result */
+	static TFuture<TPair<int32, FEnhancedOnlineResult>> WhenAny(TArray<TFuture<FEnhancedOnlineResult>>&& Futures);
+
+	/** Returns a future that is set by the first successful future, or by the last failure if none succeeds */
+	static TFuture<TPair<int32, FEnhancedOnlineResult>> WhenAnySucceeded(TArray<TFuture<FEnhancedOnlineResult>>&& Futures);
+
+	/** Returns a future that is set already */
+	static TFuture<FEnhancedOnlineResult> MakeReady(FEnhancedOnlineResult&& Result);
+};
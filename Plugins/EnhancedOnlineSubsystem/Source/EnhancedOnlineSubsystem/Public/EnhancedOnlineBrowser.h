@@ -0,0 +1,186 @@
+// Copyright © 2024 MajorT. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "EnhancedOnlineTypes.h"
+#include "Engine/EngineTypes.h"
+#include "EnhancedOnlineBrowser.generated.h"
+
+class UEnhancedSessionSearchResult;
+class UEnhancedOnlineSessionsSubsystem;
+
+/**
+ * Specifies which fields of a session changed between two refreshes
+ */
+UENUM(BlueprintType, meta = (Bitflags, UseEnumValuesAsMaskValuesInEditor = "true"))
+enum class EEnhancedSessionChangedFields : uint8
+{
+	None = 0 UMETA(Hidden),
+	Ping = 1 << 0,
+	Players = 1 << 1,
+	MaxPlayers = 1 << 2,
+	FriendlyName = 1 << 3,
+	GameMode = 1 << 4,
+	MapName = 1 << 5,
+};
+ENUM_CLASS_FLAGS(EEnhancedSessionChangedFields);
+
+/**
+ * Blueprint exposed struct for a session that changed between two refreshes
+ */
+USTRUCT(BlueprintType)
+struct FEnhancedSessionBrowserChange
+{
+	GENERATED_BODY()
+
+public:
+	FEnhancedSessionBrowserChange() {}
+
+	FEnhancedSessionBrowserChange(UEnhancedSessionSearchResult* InSearchResult, const EEnhancedSessionChangedFields InChangedFields)
+		: SearchResult(InSearchResult)
+		, ChangedFields(static_cast<int32>(InChangedFields))
+	{}
+
+	/** Returns true if the given field changed */
+	bool HasChanged(const EEnhancedSessionChangedFields Field) const
+	{
+		return EnumHasAnyFlags(static_cast<EEnhancedSessionChangedFields>(ChangedFields), Field);
+	}
+
+	/** The session, it is the same object the session was added with */
+	UPROPERTY(BlueprintReadOnly, Category = "Session Browser")
+	TObjectPtr<UEnhancedSessionSearchResult> SearchResult;
+
+	/** The fields that changed */
+	UPROPERTY(BlueprintReadOnly, Category = "Session Browser", meta = (Bitmask, BitmaskEnum = "/Script/EnhancedOnlineSubsystem.EEnhancedSessionChangedFields"))
+	int32 ChangedFields = 0;
+};
+
+/**
+ * Blueprint exposed struct for the differences between two refreshes of a session browser
+ */
+USTRUCT(BlueprintType)
+struct FEnhancedSessionBrowserDelta
+{
+	GENERATED_BODY()
+
+public:
+	/** Returns true if nothing changed */
+	bool IsEmpty() const
+	{
+		return Added.IsEmpty() && Removed.IsEmpty() && Changed.IsEmpty();
+	}
+
+	/** Sessions that showed up since the last refresh */
+	UPROPERTY(BlueprintReadOnly, Category = "Session Browser")
+	TArray<TObjectPtr<UEnhancedSessionSearchResult>> Added;
+
+	/** Sessions that disappeared since the last refresh, only valid while the delta is handled */
+	UPROPERTY(BlueprintReadOnly, Category = "Session Browser")
+	TArray<TObjectPtr<UEnhancedSessionSearchResult>> Removed;
+
+	/** Sessions whose settings changed since the last refresh */
+	UPROPERTY(BlueprintReadOnly, Category = "Session Browser")
+	TArray<FEnhancedSessionBrowserChange> Changed;
+};
+
+/**
+ * Delegate for when a session browser refresh found differences
+ * @param Delta	The sessions that were added, removed or changed
+ */
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnEnhancedSessionBrowserUpdated, const FEnhancedSessionBrowserDelta& /* Delta */);
+
+/**
+ * Live set of sessions kept up to date by the subsystem
+ * Refreshes back off while nothing changes and speed up again as soon as something does
+ */
+UCLASS(BlueprintType)
+class ENHANCEDONLINESUBSYSTEM_API UEnhancedSessionBrowserSubscription : public UObject
+{
+	GENERATED_BODY()
+
+public:
+	/** Specifies the online mode of the sessions */
+	UPROPERTY(BlueprintReadWrite, Category = "Session Browser")
+	EEnhancedSessionOnlineMode OnlineMode = EEnhancedSessionOnlineMode::Online;
+
+	/** Whether to search for player-hosted lobbies */
+	UPROPERTY(BlueprintReadWrite, Category = "Session Browser")
+	bool bFindLobbies = true;
+
+	/** A keyword that will be used to search and filter the sessions */
+	UPROPERTY(BlueprintReadWrite, Category = "Session Browser")
+	FString SearchKeyword;
+
+	/** Maximum number of sessions in the live set, 0 means unlimited */
+	UPROPERTY(BlueprintReadWrite, Category = "Session Browser")
+	int32 MaxSearchResults = 0;
+
+	/** Seconds between two refreshes while sessions keep changing */
+	UPROPERTY(BlueprintReadWrite, Category = "Session Browser")
+	float MinRefreshInterval = 5.f;
+
+	/** Seconds between two refreshes once nothing changed for a while */
+	UPROPERTY(BlueprintReadWrite, Category = "Session Browser")
+	float MaxRefreshInterval = 60.f;
+
+	/** Factor the refresh interval grows by after every refresh without changes */
+	UPROPERTY(BlueprintReadWrite, Category = "Session Browser")
+	float BackoffMultiplier = 2.f;
+
+	/** Ping differences in milliseconds below this aren't reported as changes */
+	UPROPERTY(BlueprintReadWrite, Category = "Session Browser")
+	int32 PingChangeThreshold = 10;
+
+	/** Native delegate for when a refresh found differences */
+	FOnEnhancedSessionBrowserUpdated OnBrowserUpdated;
+
+public:
+	/** Returns the sessions currently in the live set */
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Session Browser")
+	TArray<UEnhancedSessionSearchResult*> GetSessions() const
+	{
+		TArray<UEnhancedSessionSearchResult*> Sessions;
+		Sessions.Reserve(LiveSessions.Num());
+		for (const TPair<FString, TObjectPtr<UEnhancedSessionSearchResult>>& Pair : LiveSessions)
+		{
+			Sessions.Add(Pair.Value);
+		}
+		return Sessions;
+	}
+
+	/** Returns true while the subsystem keeps the live set up to date */
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Session Browser")
+	bool IsSubscribed() const
+	{
+		return bIsSubscribed;
+	}
+
+	/** Returns the seconds until the refresh after the next one, grows while nothing changes */
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Session Browser")
+	float GetRefreshInterval() const
+	{
+		return CurrentRefreshInterval;
+	}
+
+protected:
+	friend UEnhancedOnlineSessionsSubsystem;
+	friend class FEnhancedOnlineSearchResultPoolTest;
+
+	/** The live set, keyed by session id */
+	UPROPERTY()
+	TMap<FString, TObjectPtr<UEnhancedSessionSearchResult>> LiveSessions;
+
+	/** Seconds until the next refresh */
+	float CurrentRefreshInterval = 0.f;
+
+	/** Timer of the next refresh */
+	FTimerHandle RefreshTimerHandle;
+
+	/** Whether a refresh is waiting for the online service */
+	bool bIsRefreshing = false;
+
+	/** Whether the subsystem keeps the live set up to date */
+	bool bIsSubscribed = false;
+};
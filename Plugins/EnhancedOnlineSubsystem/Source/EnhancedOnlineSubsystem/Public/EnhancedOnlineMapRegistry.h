@@ -0,0 +1,84 @@
+// Copyright © 2024 MajorT. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/PrimaryAssetId.h"
+
+struct FAssetData;
+
+/**
+ * Names of a map primary asset
+ */
+struct FEnhancedMapRegistryEntry
+{
+	/** The primary asset id of the map */
+	FPrimaryAssetId MapId;
+
+	/** The short name of the map, used in travel URLs and advertised with sessions */
+	FName AssetName;
+
+	/** The long package name of the map, used to load it */
+	FName PackageName;
+};
+
+/**
+ * Table of the map primary assets, resolved once from the asset manager and rebuilt when World assets change
+ * Lookups never touch the asset manager unless the map isn't in the table
+ */
+class ENHANCEDONLINESUBSYSTEM_API FEnhancedMapRegistry : public TSharedFromThis<FEnhancedMapRegistry>
+{
+public:
+	FEnhancedMapRegistry() {}
+	~FEnhancedMapRegistry();
+
+	/** Listens to asset registry changes and builds the table once the asset manager finished scanning */
+	void Initialize();
+
+	/** Finds a map by its primary asset id */
+	bool FindMap(const FPrimaryAssetId& MapId, FEnhancedMapRegistryEntry& OutEntry);
+
+	/** Finds a map by its short name */
+	bool FindMapByName(const FName AssetName, FEnhancedMapRegistryEntry& OutEntry);
+
+	/** Marks the table as outdated, it is rebuilt by the next lookup */
+	void Invalidate();
+
+	/** Returns the number of maps in the table */
+	int32 GetNumMaps() const { return MapsById.Num(); }
+
+	/**
+	 * Resolves a map through the registry of the world's sessions subsystem, or the asset manager if there is none
+	 * @param WorldContextObject	Object used to find the game instance
+	 * @param MapId					The primary asset id of the map
+	 * @param OutEntry				The names of the map
+	 * @return True if the map was found
+	 */
+	static bool ResolveMap(const UObject* WorldContextObject, const FPrimaryAssetId& MapId, FEnhancedMapRegistryEntry& OutEntry);
+
+private:
+	void Rebuild();
+	void AddEntry(const FPrimaryAssetId& MapId, const FAssetData& AssetData);
+
+	static bool IsMapAsset(const FAssetData& AssetData);
+	void HandleAssetAdded(const FAssetData& AssetData);
+	void HandleAssetRemoved(const FAssetData& AssetData);
+	void HandleAssetRenamed(const FAssetData& AssetData, const FString& OldObjectPath);
+
+private:
+	/** Maps keyed by their primary asset id */
+	TMap<FPrimaryAssetId, FEnhancedMapRegistryEntry> MapsById;
+
+	/** Primary asset ids keyed by the short map name */
+	TMap<FName, FPrimaryAssetId> MapIdsByName;
+
+	/** Ids that the asset manager couldn't resolve either, so repeated lookups stay cheap */
+	TSet<FPrimaryAssetId> UnknownMapIds;
+
+	/** Whether the table has to be rebuilt before the next lookup */
+	bool bIsDirty = true;
+
+	FDelegateHandle AssetAddedDelegateHandle;
+	FDelegateHandle AssetRemovedDelegateHandle;
+	FDelegateHandle AssetRenamedDelegateHandle;
+};
@@ -0,0 +1,103 @@
+// Copyright © 2024 MajorT. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/Ticker.h"
+
+class FSocket;
+class FInternetAddr;
+class UEnhancedSessionSearchResult;
+
+/**
+ * Delegate for when every QoS probe received a reply or timed out
+ */
+DECLARE_DELEGATE(FOnEnhancedQosProbesCompleted);
+
+/**
+ * Measures the round trip time to session hosts by sending small UDP packets to their QoS responder
+ * Probes are sent in parallel, capped by the maximum number of probes in flight
+ */
+class ENHANCEDONLINESUBSYSTEM_API FEnhancedSessionQosProber : public TSharedFromThis<FEnhancedSessionQosProber>
+{
+public:
+	FEnhancedSessionQosProber(int32 InMaxConcurrentProbes, float InTimeoutSeconds, int32 InMaxAttempts);
+	~FEnhancedSessionQosProber();
+
+	/** Adds a search result to measure, the address has to point to the host's QoS responder */
+	void AddProbe(UEnhancedSessionSearchResult* Result, const TSharedRef<FInternetAddr>& Address);
+
+	/** Starts sending probes, returns false if no probe could be started */
+	bool Start(FOnEnhancedQosProbesCompleted InOnCompleted);
+
+	/** Stops all probes without calling the completion delegate */
+	void Cancel();
+
+	/** Returns the number of probes that were added */
+	int32 GetNumProbes() const { return Probes.Num(); }
+
+	/** Magic number every QoS packet starts with */
+	static constexpr uint32 PacketMagic = 0x534F5145;
+
+	/** Size of a QoS packet, the magic number followed by the probe nonce */
+	static constexpr int32 PacketSize = 8;
+
+private:
+	struct FProbe
+	{
+		TWeakObjectPtr<UEnhancedSessionSearchResult> Result;
+		TSharedPtr<FInternetAddr> Address;
+		double SendTime = 0.0;
+		int32 Attempts = 0;
+		bool bInFlight = false;
+		bool bCompleted = false;
+	};
+
+	bool Tick(float DeltaTime);
+	void SendProbe(int32 ProbeIndex, double Now);
+	void CompleteProbe(int32 ProbeIndex, int32 PingInMs);
+	void ReceiveReplies(double Now);
+	void Finish();
+
+	TArray<FProbe> Probes;
+	int32 NextProbeIndex = 0;
+	int32 NumInFlight = 0;
+	int32 NumCompleted = 0;
+
+	int32 MaxConcurrentProbes;
+	float TimeoutSeconds;
+	int32 MaxAttempts;
+
+	FSocket* Socket = nullptr;
+	FTSTicker::FDelegateHandle TickerHandle;
+	FOnEnhancedQosProbesCompleted OnCompleted;
+};
+
+/**
+ * Echoes QoS probes back to their sender
+ * Runs on hosts so clients can measure their ping, also usable as a stand-in responder for local testing
+ */
+class ENHANCEDONLINESUBSYSTEM_API FEnhancedSessionQosResponder : public TSharedFromThis<FEnhancedSessionQosResponder>
+{
+public:
+	~FEnhancedSessionQosResponder();
+
+	/** Binds the responder to the given port, returns false if the port couldn't be bound */
+	bool Start(int32 InPort);
+
+	/** Closes the socket */
+	void Stop();
+
+	/** Returns true if the responder is listening */
+	bool IsRunning() const { return Socket != nullptr; }
+
+	/** Returns the port the responder listens on */
+	int32 GetPort() const { return Port; }
+
+private:
+	bool Tick(float DeltaTime);
+
+	FSocket* Socket = nullptr;
+	int32 Port = 0;
+	FTSTicker::FDelegateHandle TickerHandle;
+};
@@ -0,0 +1,87 @@
+// Copyright © 2024 MajorT. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "EnhancedOnlineTypes.h"
+
+/**
+ * Delegate for when a scheduled request may talk to the backend
+ * @param CorrelationId	The id the request was scheduled with
+ */
+DECLARE_DELEGATE_OneParam(FOnEnhancedScheduledRequestStart, uint64 /* Correlation Id */);
+
+/**
+ * Queues requests until their backend can take them, instead of failing them while another request is running
+ * Every lane of a category runs one request at a time, a category runs up to its limit of lanes at once
+ */
+class ENHANCEDONLINESUBSYSTEM_API FEnhancedRequestScheduler
+{
+public:
+	/** Changes how many requests of a category run at once and how many may wait */
+	void SetCategoryLimits(const EEnhancedRequestCategory Category, const int32 MaxRunning, const int32 MaxQueued);
+
+	/**
+	 * Queues a request, it is started by the next dispatch that finds its lane and category free
+	 * @param Category	The backend the request waits for
+	 * @param Lane		Requests of the same lane never run at the same time, usually the local user or the session
+	 * @param Priority	Where the request is queued
+	 * @param OnStart	Called once the request may run
+	 * @return The correlation id of the request, 0 if the queue of the category is full
+	 */
+	uint64 Schedule(const EEnhancedRequestCategory Category, const FName Lane, const EEnhancedRequestPriority Priority, const FOnEnhancedScheduledRequestStart& OnStart);
+
+	/** Starts every queued request that can run now, calls made while starting one are merged into the running dispatch */
+	void Dispatch();
+
+	/** Frees the lane of a running request, or drops a queued one, and starts the requests waiting for it */
+	void Complete(const uint64 CorrelationId);
+
+	/** Returns the correlation id of the request running in a lane, 0 if the lane is idle */
+	uint64 FindRunning(const EEnhancedRequestCategory Category, const FName Lane) const;
+
+	/** Returns true if the request was started and hasn't completed yet */
+	bool IsRunning(const uint64 CorrelationId) const;
+
+	int32 GetNumRunning(const EEnhancedRequestCategory Category) const { return GetCategory(Category).Running.Num(); }
+	int32 GetNumQueued(const EEnhancedRequestCategory Category) const { return GetCategory(Category).Queue.Num(); }
+
+	/** Returns the lane used for the requests of a local user, keyed by the controller id the online service reports the user with */
+	static FName MakeUserLane(const int32 ControllerId) { return FName(TEXT("LocalUser"), NAME_EXTERNAL_TO_INTERNAL(ControllerId)); }
+
+	/** Drops every queued and running request without starting them */
+	void Reset();
+
+private:
+	struct FScheduledRequest
+	{
+		uint64 CorrelationId = 0;
+		FName Lane;
+		EEnhancedRequestPriority Priority = EEnhancedRequestPriority::Normal;
+		FOnEnhancedScheduledRequestStart OnStart;
+	};
+
+	struct FRequestCategory
+	{
+		int32 MaxRunning = 1;
+		int32 MaxQueued = 32;
+
+		/** Waiting requests, highest priority first and in the order they were made within a priority */
+		TArray<FScheduledRequest> Queue;
+		TArray<FScheduledRequest> Running;
+	};
+
+	FRequestCategory& GetCategory(const EEnhancedRequestCategory Category) { return Categories[static_cast<int32>(Category)]; }
+	const FRequestCategory& GetCategory(const EEnhancedRequestCategory Category) const { return Categories[static_cast<int32>(Category)]; }
+
+	/** Moves the first queued request that can run into the running list, returns false if none can */
+	bool StartNext(FRequestCategory& Category, FScheduledRequest& OutStarted);
+
+private:
+	FRequestCategory Categories[static_cast<int32>(EEnhancedRequestCategory::MAX)];
+
+	uint64 NextCorrelationId = 1;
+
+	bool bIsDispatching = false;
+	bool bNeedsDispatch = false;
+};
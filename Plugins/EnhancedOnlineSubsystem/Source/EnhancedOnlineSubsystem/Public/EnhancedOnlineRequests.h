@@ -4,6 +4,8 @@
 
 #include "CoreMinimal.h"
 #include "EnhancedOnlineTypes.h"
+#include "EnhancedOnlineMapRegistry.h"
+#include "EnhancedOnlineSearchFilter.h"
 #include "OnlineSessionSettings.h"
 #include "Interfaces/OnlineSessionInterface.h"
 #include "OnlineSubsystemUtils.h"
@@ -16,6 +18,7 @@
 
 enum class EEnhancedSessionOnlineMode : uint8;
 class UEnhancedOnlineSessionsSubsystem;
+class UEnhancedSessionSearchResult;
 
 /**
  * Delegate for when a request failed
@@ -41,15 +44,43 @@ public:
 	
 	virtual void InvalidateRequest()
 	{
+		/* A request may be invalidated by its completion and by its owner, only the first one hands it back */
+		if (bIsInvalidated)
+		{
+			return;
+		}
+		bIsInvalidated = true;
+
 		if (OnRequestFailedDelegate.IsBound())
 		{
 			OnRequestFailedDelegate.RemoveAll(this);
 			OnRequestFailedDelegate.Clear();
+		}
 
+		if (OwningPool.IsValid())
+		{
+			ReleaseToPool();
+		}
+		else
+		{
 			MarkAsGarbage();
 		}
 	}
 
+	/** Puts the request back into the state it was constructed in, called before a pooled request is reused */
+	virtual void ResetRequest()
+	{
+		const UObject* Defaults = GetClass()->GetDefaultObject();
+		for (TFieldIterator<FProperty> It(GetClass()); It; ++It)
+		{
+			It->CopyCompleteValue_InContainer(this, Defaults);
+		}
+
+		CorrelationId = 0;
+		bIsInvalidated = false;
+		RequestSerial++;
+	}
+
 	virtual void CompleteRequest()
 	{
 		if (bInvalidateOnCompletion)
@@ -59,6 +90,9 @@ public:
 	}
 	//~ End UEnhancedOnlineRequestBase Interface
 
+	/** Returns the serial of the current use of the request, it changes once a pooled request is reused */
+	uint32 GetRequestSerial() const { return RequestSerial; }
+
 	/** Should the request be garbage collected when it's completed */
 	UPROPERTY(BlueprintReadWrite, Category = "Online|Request")
 	bool bInvalidateOnCompletion;
@@ -67,6 +101,10 @@ public:
 	UPROPERTY(BlueprintReadWrite, Category = "Online|Request")
 	int32 LocalUserIndex;
 
+	/** Where the request is queued if the backend is busy, ignored by requests that run right away */
+	UPROPERTY(BlueprintReadWrite, Category = "Online|Request")
+	EEnhancedRequestPriority Priority = EEnhancedRequestPriority::Normal;
+
 	/** Native delegate for when the request fails */
 	FOnEnhancedRequestFailedWithLog OnRequestFailedDelegate;
 
@@ -75,6 +113,28 @@ protected:
 
 	/** Online subsystem pointer */
 	IOnlineSubsystem* OnlineSub;
+
+	/** Id the request scheduler knows the request by, 0 if it isn't scheduled */
+	uint64 CorrelationId = 0;
+
+	/** The subsystem the request is returned to once it is invalidated, requests made outside the pool are garbage collected */
+	TWeakObjectPtr<UEnhancedOnlineSessionsSubsystem> OwningPool;
+
+	/** Frame in which the request was returned to the pool */
+	uint64 PoolReleaseFrame = 0;
+
+	/** Bumped every time the request is reused, deferred callbacks compare it to tell the use they were made for apart from a later one */
+	uint32 RequestSerial = 0;
+
+	/** Whether the current use of the request was invalidated already */
+	bool bIsInvalidated = false;
+
+	/** Hands search results held by the request back to its owning pool and empties the array */
+	void ReleaseSearchResults(TArray<TObjectPtr<UEnhancedSessionSearchResult>>& Results);
+
+private:
+	/** Hands the request back to its owning pool */
+	void ReleaseToPool();
 };
 
 /**
@@ -134,6 +194,14 @@ public:
 		
 		Super::InvalidateRequest();
 	}
+
+	virtual void ResetRequest() override
+	{
+		Super::ResetRequest();
+
+		CreateAttempts = 0;
+		FirstCreateAttemptTime = 0.0;
+	}
 	//~ End UEnhancedOnlineRequestBase Interface
 
 
@@ -141,6 +209,10 @@ public:
 	UPROPERTY(BlueprintReadWrite, Category = "Online|Request")
 	EEnhancedSessionOnlineMode OnlineMode;
 
+	/** The name the session is registered under, only the game session moves the host to its map */
+	UPROPERTY(BlueprintReadWrite, Category = "Online|Request")
+	FName SessionName = NAME_GameSession;
+
 	/** The maximum number of players that can join the session */
 	UPROPERTY(BlueprintReadWrite, Category = "Online|Request")
 	int32 MaxPlayerCount;
@@ -173,9 +245,17 @@ public:
 	UPROPERTY(BlueprintReadWrite, Category = "Online|Request")
 	bool bAllowJoinInProgress;
 
+	/** Whether seats that open up while the session is in progress are advertised for backfill, opens the session to joins until they are filled */
+	UPROPERTY(BlueprintReadWrite, Category = "Online|Request")
+	bool bBackfillWhenInProgress = false;
+
 	/** Additional travel URL operators that will be appended to the travel URL */
 	UPROPERTY(BlueprintReadWrite, Category = "Online|Request")
 	TArray<FString> TravelURLOperators;
+
+	/** How the subsystem retries when the online service fails to create the session */
+	UPROPERTY(BlueprintReadWrite, Category = "Online|Request")
+	FEnhancedSessionRetryPolicy RetryPolicy;
 	
 	/** Native delegate for when the session is created */
 	FOnEnhancedCreateSessionCompleted OnCreateSessionCompleted;
@@ -224,6 +304,15 @@ public:
 		return false;
 #endif
 	}
+
+protected:
+	friend UEnhancedOnlineSessionsSubsystem;
+
+	/** Number of times the session creation was attempted */
+	int32 CreateAttempts = 0;
+
+	/** Time in seconds at which the first attempt was made */
+	double FirstCreateAttemptTime = 0.0;
 };
 
 /**
@@ -235,6 +324,16 @@ class UEnhancedOnlineRequest_CreateSession : public UEnhancedOnlineRequest_Sessi
 	GENERATED_BODY()
 
 public:
+	//~ Begin UEnhancedOnlineRequestBase Interface
+	virtual void ResetRequest() override
+	{
+		Super::ResetRequest();
+
+		CreateSessionStartTime = 0.0;
+		bMapPreloadCompleted = false;
+	}
+	//~ End UEnhancedOnlineRequestBase Interface
+
 	/** The map of the session which will be loaded when the session is created */
 	UPROPERTY(BlueprintReadWrite, Category = "Online|Request", meta = (AllowedTypes = "World"))
 	FPrimaryAssetId MapId;
@@ -243,6 +342,14 @@ public:
 	UPROPERTY(BlueprintReadWrite, Category = "Online|Request")
 	bool bIsDedicated;
 
+	/** Whether to load the map in the background while the session is created, so the travel doesn't wait for the full load */
+	UPROPERTY(BlueprintReadWrite, Category = "Online|Request")
+	bool bPreloadMapDuringCreate = false;
+
+	/** How long creating the session and loading the map took, will be valid after the request is completed */
+	UPROPERTY(BlueprintReadOnly, Category = "Online|Request")
+	FEnhancedSessionHostTimings HostTimings;
+
 public:
 	/** Returns the maximum number of players that can join the session */
 	virtual int32 GetMaxPlayers() const override
@@ -253,10 +360,21 @@ public:
 	/** Returns the full map name that will be loaded when the session is created */
 	virtual FString GetMapName() const override
 	{
-		FAssetData MapAssetData;
-		if (UAssetManager::Get().GetPrimaryAssetData(MapId, MapAssetData))
+		FEnhancedMapRegistryEntry MapEntry;
+		if (FEnhancedMapRegistry::ResolveMap(this, MapId, MapEntry))
 		{
-			return MapAssetData.AssetName.ToString();
+			return MapEntry.AssetName.ToString();
+		}
+		return FString();
+	}
+
+	/** Returns the long package name of the map, used to load it ahead of the travel */
+	virtual FString GetMapPackageName() const
+	{
+		FEnhancedMapRegistryEntry MapEntry;
+		if (FEnhancedMapRegistry::ResolveMap(this, MapId, MapEntry))
+		{
+			return MapEntry.PackageName.ToString();
 		}
 		return FString();
 	}
@@ -269,6 +387,15 @@ public:
 
 		return TravelURL;
 	}
+
+protected:
+	friend UEnhancedOnlineSessionsSubsystem;
+
+	/** Time in seconds at which the session creation was issued */
+	double CreateSessionStartTime = 0.0;
+
+	/** Whether the background map load finished */
+	bool bMapPreloadCompleted = false;
 };
 
 /**
@@ -292,10 +419,86 @@ public:
 		Super::InvalidateRequest();
 	}
 	//~ End UEnhancedOnlineRequestBase Interface
+
+	/** The name of the session to start */
+	UPROPERTY(BlueprintReadWrite, Category = "Online|Request")
+	FName SessionName = NAME_GameSession;
 	
 	FOnStartSessionComplete OnStartSessionCompleted;
 };
 
+/**
+ * Delegate for when a hosted session was recycled
+ * @param SessionName	The name of the session
+ */
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnEnhancedRecycleSessionCompleted, const FName /* Session Name */);
+
+/**
+ * Request class used to reuse a hosted session for the next match, only the settings that differ are sent to the online service
+ */
+UCLASS()
+class UEnhancedOnlineRequest_RecycleSession : public UEnhancedOnlineSessionRequestBase
+{
+	GENERATED_BODY()
+
+public:
+	//~ Begin UEnhancedOnlineRequestBase Interface
+	virtual void InvalidateRequest() override
+	{
+		if (OnRecycleSessionCompleted.IsBound())
+		{
+			OnRecycleSessionCompleted.RemoveAll(this);
+			OnRecycleSessionCompleted.Clear();
+		}
+
+		Super::InvalidateRequest();
+	}
+	//~ End UEnhancedOnlineRequestBase Interface
+
+	/** The name of the hosted session to recycle */
+	UPROPERTY(BlueprintReadWrite, Category = "Online|Request")
+	FName SessionName = NAME_GameSession;
+
+	/** The map of the next match, an invalid id keeps the current map */
+	UPROPERTY(BlueprintReadWrite, Category = "Online|Request", meta = (AllowedTypes = "World"))
+	FPrimaryAssetId MapId;
+
+	/** The game mode of the next match, empty keeps the current game mode */
+	UPROPERTY(BlueprintReadWrite, Category = "Online|Request")
+	FString GameModeAdvertisementName;
+
+	/** The friendly name of the next match, empty keeps the current name */
+	UPROPERTY(BlueprintReadWrite, Category = "Online|Request")
+	FString FriendlyName;
+
+	/** Whether to change if players can join while the session is in progress */
+	UPROPERTY(BlueprintReadWrite, Category = "Online|Request", meta = (InlineEditConditionToggle))
+	bool bOverrideAllowJoinInProgress = false;
+
+	/** Whether players can join while the session is in progress */
+	UPROPERTY(BlueprintReadWrite, Category = "Online|Request", meta = (EditCondition = "bOverrideAllowJoinInProgress"))
+	bool bAllowJoinInProgress = true;
+
+	/** Whether the host travels to the new map once the session is updated, only used by the game session */
+	UPROPERTY(BlueprintReadWrite, Category = "Online|Request")
+	bool bTravelToMap = true;
+
+	/** Native delegate for when the session was updated */
+	FOnEnhancedRecycleSessionCompleted OnRecycleSessionCompleted;
+
+public:
+	/** Returns the full map name of the next match, empty if the map is kept */
+	virtual FString GetMapName() const
+	{
+		FEnhancedMapRegistryEntry MapEntry;
+		if (FEnhancedMapRegistry::ResolveMap(this, MapId, MapEntry))
+		{
+			return MapEntry.AssetName.ToString();
+		}
+		return FString();
+	}
+};
+
 /**
  * Request class used to create an online lobby
  */
@@ -421,6 +624,7 @@ protected:
 
 /**
  * A search result object that represents a session found online
+ * Results are pooled, they stay valid while the request or browser subscription that delivered them holds on to them
  */
 UCLASS(BlueprintType)
 class UEnhancedSessionSearchResult : public UObject
@@ -428,49 +632,170 @@ class UEnhancedSessionSearchResult : public UObject
 	GENERATED_BODY()
 
 public:
+	/** Stores the search result and decodes the settings the getters read from */
+	void InitializeSearchResult(const FOnlineSessionSearchResult& InSearchResult)
+	{
+		StoredSearchResult = InSearchResult;
+		DecodeAttributes();
+	}
+
+	/** Decodes the settings of the stored search result, needs to be called again if the stored search result was modified */
+	void DecodeAttributes()
+	{
+		DecodeAttributes(StoredSearchResult, Attributes);
+	}
+
+	/** Decodes the settings of a raw search result, without needing a result object */
+	static void DecodeAttributes(const FOnlineSessionSearchResult& InSearchResult, FEnhancedSessionSearchResultAttributes& OutAttributes)
+	{
+		const FOnlineSession& Session = InSearchResult.Session;
+		const FSessionSettings& Settings = Session.SessionSettings.Settings;
+
+		DecodeStringSetting(Settings, SETTING_FRIENDLYNAME, OutAttributes.FriendlyName);
+		DecodeStringSetting(Settings, SETTING_GAMEMODE, OutAttributes.GameMode);
+		DecodeStringSetting(Settings, SETTING_MAPNAME, OutAttributes.MapName);
+		DecodeStringSetting(Settings, SEARCH_KEYWORDS, OutAttributes.SearchKeyword);
+
+		OutAttributes.GameModeHash = GetTypeHash(OutAttributes.GameMode);
+		OutAttributes.MapNameHash = GetTypeHash(OutAttributes.MapName);
+
+		if (OutAttributes.FriendlyName.IsEmpty())
+		{
+			OutAttributes.FriendlyName = Session.OwningUserId.IsValid() ? Session.OwningUserName : TEXT("Unknown");
+		}
+
+		OutAttributes.SessionId = GetSessionId(InSearchResult);
+		OutAttributes.MaxPlayers = Session.SessionSettings.NumPublicConnections;
+		OutAttributes.OpenPublicConnections = Session.NumOpenPublicConnections;
+		OutAttributes.CurrentPlayers = OutAttributes.MaxPlayers - OutAttributes.OpenPublicConnections;
+		OutAttributes.PingInMs = InSearchResult.PingInMs;
+
+		OutAttributes.QosPort = 0;
+		if (const FOnlineSessionSetting* QosPortSetting = Settings.Find(SETTING_QOSPORT))
+		{
+			QosPortSetting->Data.GetValue(OutAttributes.QosPort);
+		}
+
+		OutAttributes.ReservationPort = 0;
+		if (const FOnlineSessionSetting* ReservationPortSetting = Settings.Find(SETTING_RESERVATIONPORT))
+		{
+			ReservationPortSetting->Data.GetValue(OutAttributes.ReservationPort);
+		}
+
+		OutAttributes.BackfillSlots = 0;
+		if (const FOnlineSessionSetting* BackfillSetting = Settings.Find(SETTING_BACKFILL))
+		{
+			BackfillSetting->Data.GetValue(OutAttributes.BackfillSlots);
+		}
+	}
+
+	/** Identifies a raw search result across searches, falls back to the owning user id, empty if neither is known */
+	static FString GetSessionId(const FOnlineSessionSearchResult& InSearchResult)
+	{
+		return GetSessionId(InSearchResult.Session);
+	}
+
+	/** Identifies a session, hosts use it to find the id their sessions are known by */
+	static FString GetSessionId(const FOnlineSession& Session)
+	{
+		if (Session.SessionInfo.IsValid() && Session.SessionInfo->GetSessionId().IsValid())
+		{
+			return Session.SessionInfo->GetSessionId().ToString();
+		}
+
+		if (Session.OwningUserId.IsValid())
+		{
+			return Session.OwningUserId->ToString();
+		}
+
+		return FString();
+	}
+
+	/** Overrides the ping reported by the online service with a measured round trip time */
+	void SetMeasuredPing(const int32 InPingInMs)
+	{
+		StoredSearchResult.PingInMs = InPingInMs;
+		Attributes.PingInMs = InPingInMs;
+	}
+
+	/** Returns all the decoded settings of the session */
+	const FEnhancedSessionSearchResultAttributes& GetAttributes() const
+	{
+		return Attributes;
+	}
+
 	/** Pings the session to get the current ping in milliseconds */
 	int32 GetPingInMs() const
 	{
-		return StoredSearchResult.PingInMs;
+		return Attributes.PingInMs;
 	}
 
 	/** Returns the maximum number of players that can join the session */
 	int32 GetMaxPlayers() const
 	{
-		return StoredSearchResult.Session.SessionSettings.NumPublicConnections;
+		return Attributes.MaxPlayers;
 	}
 
 	/** Returns the number of players currently in the session */
 	int32 GetCurrentPlayers() const
 	{
-		return StoredSearchResult.Session.SessionSettings.NumPublicConnections - StoredSearchResult.Session.NumOpenPublicConnections;
+		return Attributes.CurrentPlayers;
 	}
 
 	/** Returns the session name */
-	FString GetSessionFriendlyName() const
+	const FString& GetSessionFriendlyName() const
 	{
-		if (StoredSearchResult.Session.SessionSettings.Settings.Array().Num() > 0)
+		return Attributes.FriendlyName;
+	}
+
+	/** Returns the advertised game mode */
+	const FString& GetGameMode() const
+	{
+		return Attributes.GameMode;
+	}
+
+	/** Returns the advertised map name */
+	const FString& GetMapName() const
+	{
+		return Attributes.MapName;
+	}
+
+	/** Returns the keyword the session can be found with */
+	const FString& GetSearchKeyword() const
+	{
+		return Attributes.SearchKeyword;
+	}
+
+private:
+	static void DecodeStringSetting(const FSessionSettings& Settings, const FName Key, FString& OutValue)
+	{
+		OutValue.Reset();
+
+		if (const FOnlineSessionSetting* Setting = Settings.Find(Key))
 		{
-			for (auto& Setting : StoredSearchResult.Session.SessionSettings.Settings)
+			if (Setting->Data.GetType() == EOnlineKeyValuePairDataType::String)
 			{
-				if (Setting.Key == SETTING_FRIENDLYNAME)
-				{
-					return Setting.Value.Data.ToString();
-				}
+				Setting->Data.GetValue(OutValue);
+			}
+			else
+			{
+				OutValue = Setting->Data.ToString();
 			}
 		}
-
-		if (StoredSearchResult.Session.OwningUserId.IsValid())
-		{
-			return StoredSearchResult.Session.OwningUserName;
-		}
-
-		return TEXT("Unknown");
 	}
 
 public:
 	/** The search result which uniquely identifies the session */
 	FOnlineSessionSearchResult StoredSearchResult;
+
+protected:
+	friend UEnhancedOnlineSessionsSubsystem;
+
+	/** Number of owners holding on to this result, it returns to the subsystem's pool when this drops to zero */
+	int32 PoolReferenceCount = 0;
+
+	/** Settings decoded from the stored search result */
+	FEnhancedSessionSearchResultAttributes Attributes;
 };
 
 /**
@@ -479,6 +804,12 @@ public:
  */
 DECLARE_MULTICAST_DELEGATE_OneParam(FOnEnhancedFindOnlineSessionsCompleted, const TArray<UEnhancedSessionSearchResult*> /* Search Results */);
 
+/**
+ * Delegate for when a streaming find online sessions request received new results
+ * @param SearchResults	The search results that arrived since the last batch
+ */
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnEnhancedFindOnlineSessionsBatchReceived, const TArray<UEnhancedSessionSearchResult*>& /* Search Results */);
+
 /**
  * Request class used to find online sessions
  */
@@ -504,27 +835,168 @@ public:
 	UPROPERTY(BlueprintReadWrite, Category = "Online|Request")
 	FString SearchKeyword;
 
-	/** List of all the search results found online, will be valid after the request is completed */
+	/** Whether the request may be served from the search result cache */
+	UPROPERTY(BlueprintReadWrite, Category = "Online|Request")
+	bool bAllowCachedResults = true;
+
+	/** Whether results should be delivered in batches while the search is still running */
+	UPROPERTY(BlueprintReadWrite, Category = "Online|Request")
+	bool bStreamResults = false;
+
+	/**
+	 * Whether to search LAN and online at the same time and merge the results, the online mode is ignored
+	 * Sessions found by both searches are delivered once, streamed batches are not deduplicated
+	 */
+	UPROPERTY(BlueprintReadWrite, Category = "Online|Request")
+	bool bFederatedSearch = false;
+
+	/** Whether to measure the ping to every found session before the results are delivered */
+	UPROPERTY(BlueprintReadWrite, Category = "Online|Request")
+	bool bMeasurePing = false;
+
+	/** Filter and sort order applied to the results before they are delivered, streamed batches are not filtered */
+	UPROPERTY(BlueprintReadWrite, Category = "Online|Request")
+	FEnhancedSessionSearchFilter ResultFilter;
+
+	/** List of all the search results found online, will be valid after the request is completed and until the request searches again or is reused */
 	UPROPERTY(BlueprintReadOnly, Category = "Online|Request")
 	TArray<TObjectPtr<UEnhancedSessionSearchResult>> SearchResults;
 
 	/** Native delegate for when the request is completed */
 	FOnEnhancedFindOnlineSessionsCompleted OnFindOnlineSessionsCompleted;
 
+	/** Native delegate for when new results arrived, only called if results are streamed, the batches stay valid as long as the search results */
+	FOnEnhancedFindOnlineSessionsBatchReceived OnSearchResultsBatchReceived;
+
+protected:
+	friend UEnhancedOnlineSessionsSubsystem;
+
+	/** Number of federated queries that haven't completed yet */
+	int32 PendingFederatedQueries = 0;
+
+	/** Whether any of the federated queries succeeded */
+	bool bFederatedQuerySucceeded = false;
+
+	/** Results of the completed federated queries, merged once the last one completes */
+	UPROPERTY()
+	TArray<TObjectPtr<UEnhancedSessionSearchResult>> FederatedResults;
+
+	/** Results streamed to the request, retained so the batches stay valid until the request searches again */
+	UPROPERTY()
+	TArray<TObjectPtr<UEnhancedSessionSearchResult>> StreamedResults;
+
 public:
 	virtual void InvalidateRequest() override
 	{
 		Super::InvalidateRequest();
 
+		if (OnSearchResultsBatchReceived.IsBound())
+		{
+			OnSearchResultsBatchReceived.RemoveAll(this);
+			OnSearchResultsBatchReceived.Clear();
+		}
+
 		if (OnFindOnlineSessionsCompleted.IsBound())
 		{
 			OnFindOnlineSessionsCompleted.RemoveAll(this);
 			OnFindOnlineSessionsCompleted.Clear();
 		}
 	}
+
+	virtual void ResetRequest() override
+	{
+		/* The results are retained by the pool, copying the defaults over them would leak the references */
+		ReleaseSearchResults(SearchResults);
+		ReleaseSearchResults(FederatedResults);
+		ReleaseSearchResults(StreamedResults);
+
+		Super::ResetRequest();
+
+		PendingFederatedQueries = 0;
+		bFederatedQuerySucceeded = false;
+	}
 };
 
 
+/**
+ * Request class used to find one page of online sessions
+ * Pass the next cursor of a completed request to fetch the following page
+ */
+UCLASS()
+class UEnhancedOnlineRequest_FindSessionsPage : public UEnhancedOnlineSessionRequestBase
+{
+	GENERATED_BODY()
+
+public:
+	/** Specifies the online mode of the session */
+	UPROPERTY(BlueprintReadWrite, Category = "Online|Request")
+	EEnhancedSessionOnlineMode OnlineMode;
+
+	/** Whether to search for player-hosted lobbies */
+	UPROPERTY(BlueprintReadWrite, Category = "Online|Request")
+	bool bFindLobbies;
+
+	/** A keyword that will be used to search and filter the sessions */
+	UPROPERTY(BlueprintReadWrite, Category = "Online|Request")
+	FString SearchKeyword;
+
+	/** Maximum number of sessions on a page */
+	UPROPERTY(BlueprintReadWrite, Category = "Online|Request")
+	int32 PageSize = 20;
+
+	/** The page to fetch, a default cursor starts a new search at the first page */
+	UPROPERTY(BlueprintReadWrite, Category = "Online|Request")
+	FEnhancedSessionSearchCursor Cursor;
+
+	/** The sessions on the page, will be valid after the request is completed and until the next page is fetched or the request is reused */
+	UPROPERTY(BlueprintReadOnly, Category = "Online|Request")
+	TArray<TObjectPtr<UEnhancedSessionSearchResult>> SearchResults;
+
+	/** Cursor of the following page, will be valid after the request is completed */
+	UPROPERTY(BlueprintReadOnly, Category = "Online|Request")
+	FEnhancedSessionSearchCursor NextCursor;
+
+	/** Whether the following page may contain sessions */
+	UPROPERTY(BlueprintReadOnly, Category = "Online|Request")
+	bool bHasMorePages = false;
+
+	/** Native delegate for when the request is completed */
+	FOnEnhancedFindOnlineSessionsCompleted OnFindOnlineSessionsCompleted;
+
+public:
+	virtual void InvalidateRequest() override
+	{
+		Super::InvalidateRequest();
+
+		if (OnFindOnlineSessionsCompleted.IsBound())
+		{
+			OnFindOnlineSessionsCompleted.RemoveAll(this);
+			OnFindOnlineSessionsCompleted.Clear();
+		}
+	}
+
+	virtual void ResetRequest() override
+	{
+		ReleaseSearchResults(SearchResults);
+
+		Super::ResetRequest();
+
+		PageCursor = FEnhancedSessionSearchCursor();
+	}
+
+protected:
+	friend UEnhancedOnlineSessionsSubsystem;
+
+	/** The page being fetched, resolved from the cursor when the request was made */
+	FEnhancedSessionSearchCursor PageCursor;
+};
+
+/**
+ * Delegate for when a session was joined
+ * @param SessionName	The name of the joined session
+ */
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnEnhancedJoinSessionCompleted, const FName /* Session Name */);
+
 /**
  * Request class used to join an online session
  */
@@ -534,9 +1006,229 @@ class UEnhancedOnlineRequest_JoinSession : public UEnhancedOnlineSessionRequestB
 	GENERATED_BODY()
 
 public:
+	//~ Begin UEnhancedOnlineRequestBase Interface
+	virtual void InvalidateRequest() override
+	{
+		if (OnJoinSessionCompleted.IsBound())
+		{
+			OnJoinSessionCompleted.RemoveAll(this);
+			OnJoinSessionCompleted.Clear();
+		}
+
+		Super::InvalidateRequest();
+	}
+
+	virtual void ResetRequest() override
+	{
+		Super::ResetRequest();
+
+		CandidateIndex = 0;
+		ReservationToken = 0;
+		JoinStartTime = 0.0;
+		ReservationStartTime = 0.0;
+		JoinSessionStartTime = 0.0;
+		PreloadMapPackageName = NAME_None;
+		MapPreloadStartTime = 0.0;
+		bMapPreloadCompleted = false;
+	}
+	//~ End UEnhancedOnlineRequestBase Interface
+
 	/** The session to join */
 	UPROPERTY(BlueprintReadWrite, Category = "Online|Request")
 	TObjectPtr<UEnhancedSessionSearchResult> SessionToJoin;
+
+	/** Sessions tried in order if the host of the session to join has no free slot */
+	UPROPERTY(BlueprintReadWrite, Category = "Online|Request")
+	TArray<TObjectPtr<UEnhancedSessionSearchResult>> FallbackSessions;
+
+	/** Whether to reserve a slot with the host before travelling, hosts that take no reservations are joined directly */
+	UPROPERTY(BlueprintReadWrite, Category = "Online|Request")
+	bool bReserveSlot = true;
+
+	/** Whether to load the advertised map of the session in the background while it is being joined */
+	UPROPERTY(BlueprintReadWrite, Category = "Online|Request")
+	bool bPreloadMapDuringJoin = true;
+
+	/** The session that was joined, one of the session to join and the fallback sessions */
+	UPROPERTY(BlueprintReadOnly, Category = "Online|Request")
+	TObjectPtr<UEnhancedSessionSearchResult> JoinedSession;
+
+	/** How long the phases of the join took, valid after the request succeeded */
+	UPROPERTY(BlueprintReadOnly, Category = "Online|Request")
+	FEnhancedSessionJoinTimings JoinTimings;
+
+	/** Native delegate for when the session was joined and the client is travelling to it */
+	FOnEnhancedJoinSessionCompleted OnJoinSessionCompleted;
+
+protected:
+	friend UEnhancedOnlineSessionsSubsystem;
+
+	/** The session to join followed by the valid fallback sessions */
+	UPROPERTY()
+	TArray<TObjectPtr<UEnhancedSessionSearchResult>> JoinCandidates;
+
+	/** Index of the candidate currently being reserved or joined */
+	int32 CandidateIndex = 0;
+
+	/** Token the host knows the reservation of this client by, 0 if no slot was reserved */
+	uint64 ReservationToken = 0;
+
+	/** Time in seconds at which the request, the current reservation and the current join were issued */
+	double JoinStartTime = 0.0;
+	double ReservationStartTime = 0.0;
+	double JoinSessionStartTime = 0.0;
+
+	/** Map package loading for the current candidate, none if nothing is preloaded */
+	FName PreloadMapPackageName;
+	double MapPreloadStartTime = 0.0;
+
+	/** Whether the background map load finished */
+	bool bMapPreloadCompleted = false;
+};
+
+/**
+ * Delegate for when a quick join found and joined a session
+ * @param SessionName	The name of the joined session
+ * @param JoinedSession	The search result of the joined session
+ */
+DECLARE_MULTICAST_DELEGATE_TwoParams(FOnEnhancedQuickJoinCompleted, const FName /* Session Name */, UEnhancedSessionSearchResult* /* Joined Session */);
+
+/**
+ * Delegate used to replace the score of a quick join candidate
+ * @param Result	The candidate
+ * @return The score of the candidate, negative if it must not be joined
+ */
+DECLARE_DELEGATE_RetVal_OneParam(float, FOnEnhancedQuickJoinScore, const UEnhancedSessionSearchResult* /* Result */);
+
+/**
+ * Request class used to search, rank and join a session in one go
+ * The best candidate is joined as soon as it is good enough, the next best is tried if the join fails
+ */
+UCLASS()
+class UEnhancedOnlineRequest_QuickJoin : public UEnhancedOnlineSessionRequestBase
+{
+	GENERATED_BODY()
+
+public:
+	//~ Begin UEnhancedOnlineRequestBase Interface
+	virtual void InvalidateRequest() override
+	{
+		if (OnQuickJoinCompleted.IsBound())
+		{
+			OnQuickJoinCompleted.RemoveAll(this);
+			OnQuickJoinCompleted.Clear();
+		}
+
+		ScoreOverride.Unbind();
+
+		Super::InvalidateRequest();
+	}
+
+	virtual void ResetRequest() override
+	{
+		Super::ResetRequest();
+
+		CandidateScores.Reset();
+		SeenSessionIds.Reset();
+		SearchWaitTimerHandle.Invalidate();
+		StartTime = 0.0;
+		bSearchCompleted = false;
+		bSearchWaitExpired = false;
+	}
+	//~ End UEnhancedOnlineRequestBase Interface
+
+	/** Specifies the online mode of the session */
+	UPROPERTY(BlueprintReadWrite, Category = "Online|Request")
+	EEnhancedSessionOnlineMode OnlineMode;
+
+	/** Whether to search for player-hosted lobbies */
+	UPROPERTY(BlueprintReadWrite, Category = "Online|Request")
+	bool bFindLobbies;
+
+	/** Maximum number of sessions to search for */
+	UPROPERTY(BlueprintReadWrite, Category = "Online|Request")
+	int32 MaxSearchResults;
+
+	/** A keyword that will be used to search and filter the sessions */
+	UPROPERTY(BlueprintReadWrite, Category = "Online|Request")
+	FString SearchKeyword;
+
+	/** Whether the search may be served from the search result cache */
+	UPROPERTY(BlueprintReadWrite, Category = "Online|Request")
+	bool bAllowCachedResults = true;
+
+	/** How the candidates are ranked, ignored if the score override is bound */
+	UPROPERTY(BlueprintReadWrite, Category = "Online|Request")
+	FEnhancedQuickJoinScoring Scoring;
+
+	/** Score a candidate needs to be joined before the search completed */
+	UPROPERTY(BlueprintReadWrite, Category = "Online|Request")
+	float GoodEnoughScore = 0.75f;
+
+	/** Seconds after which the best candidate is joined even if it isn't good enough, 0 waits for the search */
+	UPROPERTY(BlueprintReadWrite, Category = "Online|Request")
+	float MaxSearchWait = 2.f;
+
+	/** Maximum number of sessions to try before the request fails */
+	UPROPERTY(BlueprintReadWrite, Category = "Online|Request")
+	int32 MaxJoinAttempts = 3;
+
+	/** Whether to reserve a slot with the host before travelling */
+	UPROPERTY(BlueprintReadWrite, Category = "Online|Request")
+	bool bReserveSlot = true;
+
+	/** The session that was joined, valid after the request succeeded */
+	UPROPERTY(BlueprintReadOnly, Category = "Online|Request")
+	TObjectPtr<UEnhancedSessionSearchResult> JoinedSession;
+
+	/** How long the quick join took, valid after the request succeeded */
+	UPROPERTY(BlueprintReadOnly, Category = "Online|Request")
+	FEnhancedQuickJoinTimings Timings;
+
+	/** Replaces the scoring of the candidates if bound */
+	FOnEnhancedQuickJoinScore ScoreOverride;
+
+	/** Native delegate for when a session was joined */
+	FOnEnhancedQuickJoinCompleted OnQuickJoinCompleted;
+
+	/** Returns the score of a candidate, negative if it must not be joined */
+	float ScoreCandidate(const UEnhancedSessionSearchResult* Result) const
+	{
+		if (ScoreOverride.IsBound())
+		{
+			return ScoreOverride.Execute(Result);
+		}
+
+		return Scoring.Score(Result->GetAttributes());
+	}
+
+protected:
+	friend UEnhancedOnlineSessionsSubsystem;
+
+	/** The streaming search feeding the candidates */
+	UPROPERTY()
+	TObjectPtr<UEnhancedOnlineRequest_FindSessions> FindRequest;
+
+	/** The join of the current candidate */
+	UPROPERTY()
+	TObjectPtr<UEnhancedOnlineRequest_JoinSession> JoinRequest;
+
+	/** Joinable sessions that weren't tried yet, the best one first */
+	UPROPERTY()
+	TArray<TObjectPtr<UEnhancedSessionSearchResult>> Candidates;
+
+	/** Scores of the candidates, in the same order */
+	TArray<float> CandidateScores;
+
+	/** Ids of the sessions that were scored already */
+	TSet<FString> SeenSessionIds;
+
+	/** Timer after which the best candidate is joined anyway */
+	FTimerHandle SearchWaitTimerHandle;
+
+	double StartTime = 0.0;
+	bool bSearchCompleted = false;
+	bool bSearchWaitExpired = false;
 };
 
 /**
@@ -546,16 +1238,14 @@ public:
 class FEnhancedOnlineSearchSettingsBase : public FGCObject
 {
 public:
-	FEnhancedOnlineSearchSettingsBase(UEnhancedOnlineRequest_FindSessions* InRequest)
-	{
-		Request = InRequest;
-	}
+	FEnhancedOnlineSearchSettingsBase() {}
 
 	virtual ~FEnhancedOnlineSearchSettingsBase() {}
 
 	virtual void AddReferencedObjects(FReferenceCollector& Collector) override
 	{
-		Collector.AddReferencedObject(Request);
+		Collector.AddReferencedObjects(Requests);
+		Collector.AddReferencedObjects(MaterializedResults);
 	}
 
 	virtual FString GetReferencerName() const override
@@ -565,7 +1255,20 @@ public:
 	}
 
 public:
-	TObjectPtr<UEnhancedOnlineRequest_FindSessions> Request = nullptr;
+	/** All requests waiting for this search, identical queries are merged into the same search */
+	TArray<TObjectPtr<UEnhancedOnlineRequest_FindSessions>> Requests;
+
+	/** Result objects of the sessions in the latest raw search results, in the same order */
+	TArray<TObjectPtr<UEnhancedSessionSearchResult>> MaterializedResults;
+
+	/** Session ids of the materialized results, rows without an id are keyed by their position */
+	TArray<FString> MaterializedSessionIds;
+
+	/** Native listeners for the raw results, they don't need result objects */
+	FOnEnhancedRawSessionSearchCompleted OnRawSearchCompleted;
+
+	/** Whether the search was only started for raw listeners, result objects are skipped unless a request joins it */
+	bool bRawResultsOnly = false;
 };
 
 /**
@@ -574,25 +1277,136 @@ public:
 class FEnhancedOnlineSearchSettings : public FOnlineSessionSearch, public FEnhancedOnlineSearchSettingsBase
 {
 public:
-	FEnhancedOnlineSearchSettings(UEnhancedOnlineRequest_FindSessions* InRequest)
-		: FEnhancedOnlineSearchSettingsBase(InRequest)
+	FEnhancedOnlineSearchSettings(const FEnhancedSessionSearchQuery& InQuery)
+		: Query(InQuery)
 	{
-		bIsLanQuery = (InRequest->OnlineMode == EEnhancedSessionOnlineMode::LAN);
-		MaxSearchResults = InRequest->MaxSearchResults <= 0 ? UINT_MAX : InRequest->MaxSearchResults;
+		bIsLanQuery = (InQuery.OnlineMode == EEnhancedSessionOnlineMode::LAN);
+		MaxSearchResults = InQuery.MaxSearchResults <= 0 ? UINT_MAX : InQuery.MaxSearchResults;
 		PingBucketSize = 100;
 
-		if (InRequest->bFindLobbies)
+		if (InQuery.bFindLobbies)
 		{
 			QuerySettings.Set(SEARCH_LOBBIES, true, EOnlineComparisonOp::Equals);
 			QuerySettings.Set(SEARCH_PRESENCE, true, EOnlineComparisonOp::Equals);
 		}
 
-		if (!InRequest->SearchKeyword.IsEmpty())
+		if (!InQuery.SearchKeyword.IsEmpty())
 		{
-			QuerySettings.Set(SEARCH_KEYWORDS, InRequest->SearchKeyword, EOnlineComparisonOp::Equals);
+			QuerySettings.Set(SEARCH_KEYWORDS, InQuery.SearchKeyword, EOnlineComparisonOp::Equals);
 		}
 	}
 
+	FEnhancedOnlineSearchSettings(UEnhancedOnlineRequest_FindSessions* InRequest)
+		: FEnhancedOnlineSearchSettings(MakeQuery(InRequest))
+	{
+		Requests.Add(InRequest);
+	}
+
 	virtual ~FEnhancedOnlineSearchSettings() {}
+
+	/** Returns true if any of the requests wants the ping of the results measured */
+	bool HasPingMeasuringRequests() const
+	{
+		for (const UEnhancedOnlineRequest_FindSessions* Request : Requests)
+		{
+			if (Request && Request->bMeasurePing)
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	/** Returns true if any of the requests wants its results streamed */
+	bool HasStreamingRequests() const
+	{
+		for (const UEnhancedOnlineRequest_FindSessions* Request : Requests)
+		{
+			if (Request && Request->bStreamResults)
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	/** Builds the search query of a find sessions request */
+	static FEnhancedSessionSearchQuery MakeQuery(const UEnhancedOnlineRequest_FindSessions* InRequest)
+	{
+		return MakeQuery(InRequest, InRequest->OnlineMode);
+	}
+
+	/** Builds the search query of a find sessions request for a specific online mode */
+	static FEnhancedSessionSearchQuery MakeQuery(const UEnhancedOnlineRequest_FindSessions* InRequest, const EEnhancedSessionOnlineMode InOnlineMode)
+	{
+		return FEnhancedSessionSearchQuery(InOnlineMode, InRequest->bFindLobbies, InRequest->SearchKeyword, InRequest->MaxSearchResults);
+	}
+
+public:
+	/** The query this search was built from */
+	const FEnhancedSessionSearchQuery Query;
+};
+
+/**
+ * Cached results of a session search query
+ */
+struct FEnhancedSessionSearchCacheEntry
+{
+	/** The results the search returned */
+	TArray<TObjectPtr<UEnhancedSessionSearchResult>> Results;
+
+	/** Time in seconds at which the results were received */
+	double Timestamp = 0.0;
+};
+
+/**
+ * Raw rows of a paginated session search, result objects are only created for the pages that are fetched
+ */
+struct FEnhancedSessionSearchSnapshot
+{
+	/** The query the rows are fetched with, the maximum number of results grows with every fetch */
+	FEnhancedSessionSearchQuery Query;
+
+	/** The raw search results, rows keep their position across fetches so pages stay stable */
+	TArray<FOnlineSessionSearchResult> Rows;
+
+	/** Number of rows the running fetch asked for, 0 if no fetch is running */
+	int32 FetchingRows = 0;
+
+	/** Number of fetches that completed */
+	int32 NumFetches = 0;
+
+	/** Whether the online service returned fewer rows than asked for or no new rows, there is nothing more to fetch */
+	bool bIsExhausted = false;
+
+	/** Time in seconds at which a page of the snapshot was last requested */
+	double LastAccessTime = 0.0;
 };
 
+/**
+ * Helper class for caching session search results by their query
+ * Manages garbage collection
+ */
+class FEnhancedSessionSearchCache : public FGCObject
+{
+public:
+	virtual ~FEnhancedSessionSearchCache() {}
+
+	virtual void AddReferencedObjects(FReferenceCollector& Collector) override
+	{
+		for (TPair<FEnhancedSessionSearchQuery, FEnhancedSessionSearchCacheEntry>& Pair : Entries)
+		{
+			Collector.AddReferencedObjects(Pair.Value.Results);
+		}
+	}
+
+	virtual FString GetReferencerName() const override
+	{
+		static const FString NameString = TEXT("FEnhancedSessionSearchCache");
+		return NameString;
+	}
+
+public:
+	/** Cached results keyed by the query that produced them */
+	TMap<FEnhancedSessionSearchQuery, FEnhancedSessionSearchCacheEntry> Entries;
+};
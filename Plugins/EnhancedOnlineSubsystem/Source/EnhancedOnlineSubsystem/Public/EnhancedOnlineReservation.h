@@ -0,0 +1,122 @@
+// Copyright © 2024 MajorT. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "EnhancedOnlineTypes.h"
+#include "Containers/Ticker.h"
+
+class FSocket;
+class FInternetAddr;
+
+/**
+ * Delegate used by the reservation host to ask how many players a session can still take
+ * @param SessionKey	The key of the session, see FEnhancedSessionReservationHost::MakeSessionKey
+ * @return The number of open slots, INDEX_NONE if the session isn't hosted here
+ */
+DECLARE_DELEGATE_RetVal_OneParam(int32, FOnEnhancedReservationQueryOpenSlots, uint32 /* Session Key */);
+
+/**
+ * Delegate for when a slot reservation was answered or timed out
+ * @param Result	Whether the host reserved a slot
+ */
+DECLARE_DELEGATE_OneParam(FOnEnhancedReservationCompleted, EEnhancedReservationResult /* Result */);
+
+/**
+ * Answers slot reservations of clients that are about to travel to a hosted session
+ * Reservations count against the open slots of the session until the client arrives or the reservation expires
+ */
+class ENHANCEDONLINESUBSYSTEM_API FEnhancedSessionReservationHost : public TSharedFromThis<FEnhancedSessionReservationHost>
+{
+public:
+	~FEnhancedSessionReservationHost();
+
+	/** Binds the host to the given port, returns false if the port couldn't be bound */
+	bool Start(int32 InPort, float InReservationTimeToLive);
+
+	/** Closes the socket and drops every reservation */
+	void Stop();
+
+	/** Returns true if the host is listening */
+	bool IsRunning() const { return Socket != nullptr; }
+
+	/** Returns the port the host listens on */
+	int32 GetPort() const { return Port; }
+
+	/** Removes the reservation of a client that arrived, returns false if it had none */
+	bool ConsumeReservation(const uint64 ClientToken);
+
+	/** Returns the number of unexpired reservations of a session */
+	int32 GetNumReservations(const uint32 SessionKey) const;
+
+	/** Returns the key a session is reserved under, hosts and clients derive it from the session id */
+	static uint32 MakeSessionKey(const FString& SessionId) { return GetTypeHash(SessionId); }
+
+	/** Asked for the open slots of a session whenever a client wants to reserve one */
+	FOnEnhancedReservationQueryOpenSlots OnQueryOpenSlots;
+
+	/** Magic numbers reservation packets start with */
+	static constexpr uint32 RequestMagic = 0x56535245;
+	static constexpr uint32 ReplyMagic = 0x52535245;
+
+	/** Size of a request, the magic number, the nonce, the session key and the client token */
+	static constexpr int32 RequestSize = 20;
+
+	/** Size of a reply, the magic number, the nonce and the result */
+	static constexpr int32 ReplySize = 9;
+
+private:
+	struct FReservation
+	{
+		uint64 ClientToken = 0;
+		uint32 SessionKey = 0;
+		double ExpiryTime = 0.0;
+	};
+
+	bool Tick(float DeltaTime);
+	EEnhancedReservationResult Reserve(const uint32 SessionKey, const uint64 ClientToken, const double Now);
+
+	/** Unexpired reservations, small enough to be searched linearly */
+	TArray<FReservation> Reservations;
+
+	float ReservationTimeToLive = 30.f;
+
+	FSocket* Socket = nullptr;
+	int32 Port = 0;
+	FTSTicker::FDelegateHandle TickerHandle;
+};
+
+/**
+ * Asks a host to reserve a slot before the client travels to it
+ * Requests are sent again until the host answers or the attempts run out
+ */
+class ENHANCEDONLINESUBSYSTEM_API FEnhancedSessionReservationClient : public TSharedFromThis<FEnhancedSessionReservationClient>
+{
+public:
+	FEnhancedSessionReservationClient(float InTimeoutSeconds, int32 InMaxAttempts);
+	~FEnhancedSessionReservationClient();
+
+	/** Starts asking the host at the given address, returns false if the request couldn't be sent */
+	bool Start(const TSharedRef<FInternetAddr>& InAddress, const uint32 InSessionKey, const uint64 InClientToken, FOnEnhancedReservationCompleted InOnCompleted);
+
+	/** Stops asking without calling the completion delegate */
+	void Cancel();
+
+private:
+	bool Tick(float DeltaTime);
+	void SendRequest(const double Now);
+	void Finish(const EEnhancedReservationResult Result);
+
+	TSharedPtr<FInternetAddr> Address;
+	uint32 SessionKey = 0;
+	uint64 ClientToken = 0;
+
+	float TimeoutSeconds;
+	int32 MaxAttempts;
+	int32 Attempts = 0;
+	double SendTime = 0.0;
+
+	FSocket* Socket = nullptr;
+	FTSTicker::FDelegateHandle TickerHandle;
+	FOnEnhancedReservationCompleted OnCompleted;
+};
@@ -0,0 +1,163 @@
+// Copyright © 2024 MajorT. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "EnhancedOnlineSearchFilter.generated.h"
+
+class UEnhancedSessionSearchResult;
+struct FEnhancedSessionSearchResultAttributes;
+
+/**
+ * Specifies the column session search results are sorted by
+ */
+UENUM(BlueprintType)
+enum class EEnhancedSessionSortKey : uint8
+{
+	None,
+	Ping,
+	OpenSlots,
+	CurrentPlayers,
+	MaxPlayers,
+};
+
+/**
+ * Blueprint exposed struct for filtering and sorting session search results on the client
+ */
+USTRUCT(BlueprintType)
+struct FEnhancedSessionSearchFilter
+{
+	GENERATED_BODY()
+
+public:
+	/** Minimum number of free public slots, 0 accepts any session */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Search Filter")
+	int32 MinOpenSlots = 0;
+
+	/** Maximum ping in milliseconds, 0 accepts any ping */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Search Filter")
+	int32 MaxPingInMs = 0;
+
+	/** Whether to drop sessions without free public slots */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Search Filter")
+	bool bExcludeFull = false;
+
+	/** The game mode the session has to advertise, empty accepts any game mode */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Search Filter")
+	FString GameMode;
+
+	/** The map the session has to advertise, empty accepts any map */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Search Filter")
+	FString MapName;
+
+	/** The column the results are sorted by */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Search Filter")
+	EEnhancedSessionSortKey SortKey = EEnhancedSessionSortKey::None;
+
+	/** Whether to sort from the highest to the lowest value */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Search Filter")
+	bool bSortDescending = false;
+
+	/** Maximum number of results to keep after sorting, 0 keeps all of them */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Search Filter")
+	int32 MaxResults = 0;
+
+public:
+	/** Returns true if the filter would drop or reorder any result */
+	bool IsActive() const
+	{
+		return MinOpenSlots > 0 || MaxPingInMs > 0 || bExcludeFull || !GameMode.IsEmpty() || !MapName.IsEmpty()
+			|| SortKey != EEnhancedSessionSortKey::None || MaxResults > 0;
+	}
+};
+
+/**
+ * Blueprint exposed struct for ranking the candidates of a quick join
+ * Sessions that fail the hard limits are never joined, the others are scored between 0 and 1
+ */
+USTRUCT(BlueprintType)
+struct ENHANCEDONLINESUBSYSTEM_API FEnhancedQuickJoinScoring
+{
+	GENERATED_BODY()
+
+public:
+	/** Minimum number of free public slots */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Quick Join", meta = (ClampMin = "1"))
+	int32 MinOpenSlots = 1;
+
+	/** Maximum ping in milliseconds, 0 accepts any ping */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Quick Join", meta = (ClampMin = "0"))
+	int32 MaxPingInMs = 0;
+
+	/** The preferred game mode, empty prefers none */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Quick Join")
+	FString GameMode;
+
+	/** Whether sessions of other game modes are never joined */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Quick Join")
+	bool bRequireGameMode = false;
+
+	/** Ping at which the ping score drops to 0 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Quick Join", meta = (ClampMin = "1"))
+	int32 ReferencePingInMs = 200;
+
+	/** Weight of a low ping */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Quick Join", meta = (ClampMin = "0"))
+	float PingWeight = 1.f;
+
+	/** Weight of taken slots, fuller sessions start their match sooner */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Quick Join", meta = (ClampMin = "0"))
+	float FillWeight = 0.5f;
+
+	/** Weight of advertising the preferred game mode */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Quick Join", meta = (ClampMin = "0"))
+	float GameModeWeight = 1.f;
+
+	/** Weight of sessions that are refilling seats of a running match */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Quick Join", meta = (ClampMin = "0"))
+	float BackfillWeight = 0.5f;
+
+public:
+	/** Returns the score of a session between 0 and 1, negative if the session must not be joined */
+	float Score(const FEnhancedSessionSearchResultAttributes& Attributes) const;
+};
+
+/**
+ * Structure of arrays view over session search results
+ * Each column is a contiguous array so the filter kernels are simple loops the compiler can vectorize
+ */
+class ENHANCEDONLINESUBSYSTEM_API FEnhancedSessionSearchColumns
+{
+public:
+	/** Copies the filterable attributes of the results into the columns */
+	void Build(TConstArrayView<UEnhancedSessionSearchResult*> Results);
+
+	/** Writes the indices of the rows that pass the filter into OutRows, in their original order */
+	void Filter(const FEnhancedSessionSearchFilter& InFilter, TArray<int32>& OutRows) const;
+
+	/** Sorts the rows by the column of the filter, rows with the same value keep their order */
+	void Sort(const FEnhancedSessionSearchFilter& InFilter, TArray<int32>& InOutRows) const;
+
+	/** Returns the number of rows */
+	int32 Num() const { return Ping.Num(); }
+
+	/** Filters and sorts the results in one go */
+	static void FilterAndSort(TConstArrayView<UEnhancedSessionSearchResult*> Results, const FEnhancedSessionSearchFilter& InFilter, TArray<UEnhancedSessionSearchResult*>& OutResults);
+
+private:
+	const TArray<int32>& GetSortColumn(EEnhancedSessionSortKey SortKey) const;
+
+	TArray<int32> Ping;
+	TArray<int32> OpenPublicConnections;
+	TArray<int32> CurrentPlayers;
+	TArray<int32> MaxPlayers;
+	TArray<uint32> GameModeHash;
+	TArray<uint32> MapNameHash;
+
+	/** Attributes of every row, used to confirm hash matches */
+	TArray<const FEnhancedSessionSearchResultAttributes*> Attributes;
+
+	/** Scratch buffers of the filter and sort passes, reused by later passes over the same columns */
+	mutable TArray<uint8> Mask;
+	mutable TArray<uint64> SortKeys;
+};
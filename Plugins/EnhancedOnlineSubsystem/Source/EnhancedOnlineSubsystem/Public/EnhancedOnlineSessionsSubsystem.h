@@ -3,6 +3,11 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "EnhancedOnlineTypes.h"
+#include "EnhancedOnlineAsync.h"
+#include "EnhancedOnlineRequestScheduler.h"
+#include "EnhancedOnlineSettingsPublisher.h"
+#include "Containers/Ticker.h"
 #include "Interfaces/OnlineSessionInterface.h"
 #include "Subsystems/GameInstanceSubsystem.h"
 #include "EnhancedOnlineSessionsSubsystem.generated.h"
@@ -10,23 +15,60 @@
 class UEnhancedOnlineRequest_FindFriendSession;
 class UEnhancedOnlineRequest_GetFriendsList;
 class UEnhancedOnlineRequest_StartSession;
+class UEnhancedOnlineRequest_RecycleSession;
 class UEnhancedOnlineRequest_LogoutUser;
+class UEnhancedOnlineRequestBase;
 class UEnhancedOnlineRequest_JoinSession;
+class UEnhancedOnlineRequest_QuickJoin;
 class UEnhancedSessionSearchResult;
 class FEnhancedOnlineSearchSettings;
 class UEnhancedOnlineRequest_FindSessions;
+class UEnhancedOnlineRequest_FindSessionsPage;
+struct FEnhancedSessionSearchSnapshot;
+class UEnhancedSessionBrowserSubscription;
+class UPackage;
+class FEnhancedMapRegistry;
 class UEnhancedOnlineRequest_LoginUser;
 class FEnhancedOnlineSessionSettings;
 class UEnhancedOnlineRequest_CreateLobby;
 class UEnhancedOnlineRequest_CreateSession;
 class UEnhancedOnlineRequest_Session;
 class FOnlineSessionSearch;
+class FEnhancedSessionSearchCache;
+class FEnhancedSessionQosProber;
+class FEnhancedSessionQosResponder;
+class FEnhancedSessionReservationHost;
+class FEnhancedSessionReservationClient;
+class FEnhancedOnlineSearchResultPoolTest;
+class AGameModeBase;
+class APlayerController;
 
 
+/**
+ * Delegate for when a map package finished loading in the background
+ * @param PackageName		The long package name of the map
+ * @param bWasSuccessful	Whether the package was loaded
+ */
+DECLARE_DELEGATE_TwoParams(FOnEnhancedMapPreloaded, const FName /* Package Name */, bool /* bWasSuccessful */);
+
+/**
+ * Delegate for when a hosted session changed its lifecycle state
+ * @param SessionName	The name of the session
+ * @param NewState		The state the session is in now
+ */
+DECLARE_MULTICAST_DELEGATE_TwoParams(FOnEnhancedHostedSessionStateChanged, const FName /* Session Name */, EEnhancedHostedSessionState /* New State */);
+
+/**
+ * Delegate for when a drained session moved on to its next phase
+ * @param SessionName	The name of the session
+ * @param Phase			The phase the drain is in now
+ */
+DECLARE_MULTICAST_DELEGATE_TwoParams(FOnEnhancedHostedSessionDrainProgress, const FName /* Session Name */, EEnhancedSessionDrainPhase /* Phase */);
+
 /**
  * Subsystem for managing online sessions and communication with the online service.
  */
-UCLASS(DisplayName = "Enhanced Online Subsystem", meta = (DisplayName = "Enhanced Online Subsystem"))
+UCLASS(Config = Game, DisplayName = "Enhanced Online Subsystem", meta = (DisplayName = "Enhanced Online Subsystem"))
 class ENHANCEDONLINESUBSYSTEM_API UEnhancedOnlineSessionsSubsystem : public UGameInstanceSubsystem
 {
 	GENERATED_BODY()
@@ -42,14 +84,14 @@ public:
 
 #pragma region online_identity
 	/**
-	 * Logs in the online user.
+	 * Logs in the online user, queued while another login or logout of the same user is running.
 	 * @param Request	The request object that contains the login settings.
 	 */
 	UFUNCTION(BlueprintCallable, Category = "Online|EnhancedSessions|Identity")
 	virtual void LoginOnlineUser(UEnhancedOnlineRequest_LoginUser* Request);
 
 	/**
-	 * Logs out the online user.
+	 * Logs out the online user, queued while another login or logout of the same user is running.
 	 * @param Request	The request object that contains the logout settings.
 	 */
 	UFUNCTION(BlueprintCallable, Category = "Online|EnhancedSessions|Identity")
@@ -67,11 +109,130 @@ public:
 	virtual void HostOnlineSession(UEnhancedOnlineRequest_Session* Request);
 
 	/**
-	 * Starts the current online session
+	 * Starts an online session, queued while the same session is already being started
+	 * @param Request	The request object that contains the name of the session to start.
 	 */
 	UFUNCTION(BlueprintCallable, Category = "Online|EnhancedSessions|Sessions")
 	virtual void StartOnlineSession(UEnhancedOnlineRequest_StartSession* Request);
 
+	/**
+	 * Reuses a hosted session for the next match, only the settings that differ are sent to the online service.
+	 * Recycles made within the update batch window are sent in one update, the session id stays the same.
+	 * @param Request	The request object that contains the settings of the next match.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Online|EnhancedSessions|Sessions")
+	virtual void RecycleOnlineSession(UEnhancedOnlineRequest_RecycleSession* Request);
+
+	/**
+	 * Changes an advertised integer setting of a hosted session, changes are coalesced into as few updates as possible.
+	 * @param SessionName	The name of the hosted session.
+	 * @param Key			The name of the setting.
+	 * @param Value			The new value.
+	 * @param Priority		How soon the change has to reach the online service.
+	 * @return True if the session is hosted
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Online|EnhancedSessions|Sessions")
+	bool SetHostedSessionIntSetting(FName SessionName, FName Key, int32 Value, EEnhancedSettingPublishPriority Priority = EEnhancedSettingPublishPriority::Normal);
+
+	/**
+	 * Changes an advertised float setting of a hosted session, changes are coalesced into as few updates as possible.
+	 * @param SessionName	The name of the hosted session.
+	 * @param Key			The name of the setting.
+	 * @param Value			The new value.
+	 * @param Priority		How soon the change has to reach the online service.
+	 * @return True if the session is hosted
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Online|EnhancedSessions|Sessions")
+	bool SetHostedSessionFloatSetting(FName SessionName, FName Key, float Value, EEnhancedSettingPublishPriority Priority = EEnhancedSettingPublishPriority::Normal);
+
+	/**
+	 * Changes an advertised string setting of a hosted session, changes are coalesced into as few updates as possible.
+	 * @param SessionName	The name of the hosted session.
+	 * @param Key			The name of the setting.
+	 * @param Value			The new value.
+	 * @param Priority		How soon the change has to reach the online service.
+	 * @return True if the session is hosted
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Online|EnhancedSessions|Sessions")
+	bool SetHostedSessionStringSetting(FName SessionName, FName Key, const FString& Value, EEnhancedSettingPublishPriority Priority = EEnhancedSettingPublishPriority::Normal);
+
+	/**
+	 * Returns the update counters of a hosted session, including how many updates were suppressed.
+	 * @param SessionName	The name of the hosted session.
+	 */
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Online|EnhancedSessions|Sessions")
+	FEnhancedSessionPublishStats GetHostedSessionPublishStats(FName SessionName) const;
+
+	/** Returns the settings publisher of a hosted session, null if the session isn't hosted */
+	TSharedPtr<FEnhancedSessionSettingsPublisher> GetHostedSessionPublisher(const FName SessionName) const;
+
+	/**
+	 * Ends the match of a hosted session, the session can be started again afterwards.
+	 * @param SessionName	The name of the hosted session.
+	 * @return True if the session is being ended
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Online|EnhancedSessions|Sessions")
+	virtual bool EndHostedSession(FName SessionName);
+
+	/**
+	 * Takes a hosted session out of rotation, it stops being advertised and accepting joins, then it is destroyed once its players left.
+	 * @param SessionName	The name of the hosted session.
+	 * @param Deadline		Seconds after which the session is destroyed even if players are still in it, 0 waits for them to leave.
+	 * @return True if the session is being drained
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Online|EnhancedSessions|Sessions")
+	virtual bool DrainHostedSession(FName SessionName, float Deadline = 0.f);
+
+	/**
+	 * Returns how far a hosted session got in being drained, None if it isn't being drained or isn't hosted.
+	 * @param SessionName	The name of the hosted session.
+	 */
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Online|EnhancedSessions|Sessions")
+	EEnhancedSessionDrainPhase GetHostedSessionDrainPhase(FName SessionName) const;
+
+	/**
+	 * Destroys a session hosted by this process.
+	 * @param SessionName	The name of the hosted session.
+	 * @return True if the session is being destroyed
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Online|EnhancedSessions|Sessions")
+	virtual bool DestroyHostedSession(FName SessionName);
+
+	/**
+	 * Returns the lifecycle state of a session hosted by this process, None if no such session is hosted.
+	 * @param SessionName	The name of the hosted session.
+	 */
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Online|EnhancedSessions|Sessions")
+	EEnhancedHostedSessionState GetHostedSessionState(FName SessionName) const;
+
+	/**
+	 * Returns the names of all sessions hosted by this process.
+	 */
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Online|EnhancedSessions|Sessions")
+	TArray<FName> GetHostedSessionNames() const;
+
+	/**
+	 * Turns the backfill of a hosted session on or off, seats that open up mid-match are advertised until they are filled.
+	 * @param SessionName	The name of the hosted session.
+	 * @param bEnabled		Whether to backfill the session.
+	 * @return True if the session is hosted and isn't being drained
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Online|EnhancedSessions|Sessions")
+	bool SetHostedSessionBackfill(FName SessionName, bool bEnabled);
+
+	/**
+	 * Returns true if a hosted session is currently advertised for backfill.
+	 * @param SessionName	The name of the hosted session.
+	 */
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Online|EnhancedSessions|Sessions")
+	bool IsHostedSessionBackfilling(FName SessionName) const;
+
+	/** Native delegate for when a hosted session changed its lifecycle state */
+	FOnEnhancedHostedSessionStateChanged OnHostedSessionStateChanged;
+
+	/** Native delegate for when a drained session moved on to its next phase */
+	FOnEnhancedHostedSessionDrainProgress OnHostedSessionDrainProgress;
+
 	/**
 	 * Finds online sessions.
 	 * @param Request	The request object that contains the search settings.
@@ -80,75 +241,592 @@ public:
 	virtual void FindOnlineSessions(UEnhancedOnlineRequest_FindSessions* Request);
 
 	/**
-	 * Joins an online session.
+	 * Finds one page of online sessions, only the sessions on the page are turned into search results.
+	 * @param Request	The request object that contains the search settings and the cursor of the page.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Online|EnhancedSessions|Sessions")
+	virtual void FindOnlineSessionsPage(UEnhancedOnlineRequest_FindSessionsPage* Request);
+
+	/**
+	 * Starts keeping the live session set of the subscription up to date, listeners only receive the differences.
+	 * @param Subscription	The subscription that contains the search settings and the refresh intervals.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Online|EnhancedSessions|Sessions")
+	virtual void SubscribeToSessionBrowser(UEnhancedSessionBrowserSubscription* Subscription);
+
+	/**
+	 * Stops refreshing the subscription and clears its live session set.
+	 * @param Subscription	The subscription to stop.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Online|EnhancedSessions|Sessions")
+	virtual void UnsubscribeFromSessionBrowser(UEnhancedSessionBrowserSubscription* Subscription);
+
+	/**
+	 * Refreshes the subscription right away and resets its refresh interval.
+	 * @param Subscription	The subscription to refresh.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Online|EnhancedSessions|Sessions")
+	void RefreshSessionBrowser(UEnhancedSessionBrowserSubscription* Subscription);
+
+	/**
+	 * Clears all cached session search results, the next search will always query the online service.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Online|EnhancedSessions|Sessions")
+	void ClearSessionSearchCache();
+
+	/**
+	 * Returns the hit and miss counters of the search result pool.
+	 */
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Online|EnhancedSessions|Sessions")
+	FEnhancedSearchResultPoolStats GetSearchResultPoolStats() const;
+
+	/**
+	 * Returns the hit and miss counters of the request pool.
+	 */
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Online|EnhancedSessions|Sessions")
+	FEnhancedRequestPoolStats GetRequestPoolStats() const;
+
+	/**
+	 * Takes a completed request of the class from the pool of the world's subsystem, or creates one if the pool has none.
+	 * The request returns to the pool once it is invalidated, references kept past that may see it reused, compare its serial to tell.
+	 * @param WorldContextObject	Object used to find the subsystem, the request is created in it if there is none
+	 * @param RequestClass			The class of the request
+	 * @return The request, ConstructRequest still has to be called
+	 */
+	static UEnhancedOnlineRequestBase* AcquireRequest(UObject* WorldContextObject, UClass* RequestClass);
+
+	template<typename RequestClass>
+	static RequestClass* AcquireRequest(UObject* WorldContextObject)
+	{
+		return CastChecked<RequestClass>(AcquireRequest(WorldContextObject, RequestClass::StaticClass()));
+	}
+
+	/**
+	 * Starts echoing QoS probes so clients can measure their ping to this host, the port is advertised with hosted sessions.
+	 * @param Port	The UDP port to listen on, 0 uses the configured QoS port
+	 * @return True if the responder is listening
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Online|EnhancedSessions|Sessions")
+	bool StartQosResponder(int32 Port = 0);
+
+	/**
+	 * Stops echoing QoS probes.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Online|EnhancedSessions|Sessions")
+	void StopQosResponder();
+
+	/**
+	 * Starts taking slot reservations for the sessions hosted by this process, the port is advertised with hosted sessions.
+	 * @param Port	The UDP port to listen on, 0 uses the configured reservation port
+	 * @return True if the reservation host is listening
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Online|EnhancedSessions|Sessions")
+	bool StartReservationHost(int32 Port = 0);
+
+	/**
+	 * Stops taking slot reservations and drops the reservations that weren't used yet.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Online|EnhancedSessions|Sessions")
+	void StopReservationHost();
+
+	/**
+	 * Frees the slot reserved by a client that arrived, done automatically after the player logged in while the reservation host runs.
+	 * @param Options	The options of the login URL, the reservation token is read from them
+	 * @return True if the client had a reservation
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Online|EnhancedSessions|Sessions")
+	bool ConsumeSlotReservation(const FString& Options);
+
+	/**
+	 * Joins an online session, a slot is reserved with the host first and the fallback sessions are tried if it is full.
+	 * Queued while another join is running.
 	 * @param Request	The search result of the session to join.
 	 */
 	UFUNCTION(BlueprintCallable, Category = "Online|EnhancedSessions|Sessions")
 	virtual void JoinOnlineSession(UEnhancedOnlineRequest_JoinSession* Request);
+
+	/**
+	 * Searches for sessions and joins the best one as soon as it is good enough, without waiting for the whole search.
+	 * The next best session is tried if the join fails. Queued while another join is running.
+	 * @param Request	The request with the search and ranking settings.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Online|EnhancedSessions|Sessions")
+	virtual void QuickJoinOnlineSession(UEnhancedOnlineRequest_QuickJoin* Request);
+#pragma endregion
+
+#pragma region online_async
+	/**
+	 * Native variants of the requests that return a future instead of calling delegates.
+	 * The futures are set on the game thread once the request succeeded or failed, combine them with FEnhancedOnlineAsync.
+	 * The delegates of the request still fire, so a request shouldn't be made twice.
+	 */
+	TFuture<FEnhancedOnlineResult> LoginOnlineUserAsync(UEnhancedOnlineRequest_LoginUser* Request);
+	TFuture<FEnhancedOnlineResult> HostOnlineSessionAsync(UEnhancedOnlineRequest_Session* Request);
+	TFuture<FEnhancedOnlineResult> FindOnlineSessionsAsync(UEnhancedOnlineRequest_FindSessions* Request);
+	TFuture<FEnhancedOnlineResult> JoinOnlineSessionAsync(UEnhancedOnlineRequest_JoinSession* Request);
+	TFuture<FEnhancedOnlineResult> StartOnlineSessionAsync(UEnhancedOnlineRequest_StartSession* Request);
+
+	/**
+	 * Loads the package of a map in the background, so a later travel to it doesn't wait for the full load.
+	 * The package is kept loaded until the next map load.
+	 * @param MapId	The primary asset id of the map
+	 */
+	TFuture<FEnhancedOnlineResult> PreloadMapAsync(const FPrimaryAssetId& MapId);
+	/** Returns the table of map primary assets used to resolve the maps of session requests */
+	TSharedPtr<FEnhancedMapRegistry> GetMapRegistry() const { return MapRegistry; }
 #pragma endregion
 
 protected:
 	/** Online Sessions */
 	virtual void HostOnlineSessionInternal(ULocalPlayer* LocalPlayer, UEnhancedOnlineRequest_CreateSession* Request);
 	virtual void HostOnlineLobbyInternal(ULocalPlayer* LocalPlayer, UEnhancedOnlineRequest_CreateLobby* Request);
-	virtual void FindOnlineSessionsInternal(ULocalPlayer* LocalPlayer, const TSharedRef<FEnhancedOnlineSearchSettings>& InSearchSettings);
+	virtual void FindOnlineSessionsInternal(ULocalPlayer* LocalPlayer, UEnhancedOnlineRequest_FindSessions* Request);
 
-	FDelegateHandle HostLobbyDelegateHandle;
-	FDelegateHandle HostSessionDelegateHandle;
+	FDelegateHandle CreateSessionDelegateHandle;
 	FDelegateHandle FindSessionsDelegateHandle;
 	FDelegateHandle JoinSessionDelegateHandle;
 	FDelegateHandle StartSessionDelegateHandle;
+	FDelegateHandle UpdateSessionDelegateHandle;
+	FDelegateHandle EndSessionDelegateHandle;
 
 
 
 	FDelegateHandle FindFriendSessionsDelegateHandle;
 
 
+	virtual void HandleCreateSessionComplete(FName SessionName, bool bWasSuccessful);
 	virtual void HandleHostOnlineLobbyComplete(FName SessionName, bool bWasSuccessful);
 	virtual void HandleHostOnlineSessionComplete(FName SessionName, bool bWasSuccessful);
 	virtual void HandleStartOnlineSessionComplete(FName SessionName, bool bWasSuccessful);
+	void HandleLateStartSessionComplete(FName SessionName, bool bWasSuccessful);
+	void RunStartSessionRequest(uint64 CorrelationId);
+	virtual void HandleDestroyHostedSessionComplete(FName SessionName, bool bWasSuccessful);
+	virtual void HandleEndHostedSessionComplete(FName SessionName, bool bWasSuccessful);
+
+	/** Hosted sessions */
+	void AddHostedSession(UEnhancedOnlineRequest_Session* Request, const TSharedRef<FEnhancedOnlineSessionSettings>& InSessionSettings, bool bIsLobby);
+	void CreateHostedSession(const FName SessionName);
+	bool ScheduleCreateSessionRetry(const FName SessionName);
+	void RetryCreateHostedSession(const FName SessionName);
+	void SetHostedSessionState(const FName SessionName, EEnhancedHostedSessionState NewState);
+	void ClearCreateSessionDelegateIfIdle();
+	void ClearStartSessionDelegateIfIdle();
+
+	/** Hosted session watchdog, moves sessions out of states whose online service call never completed */
+	void StartHostedSessionWatchdog();
+	bool TickHostedSessionWatchdog(float DeltaTime);
+	float GetHostedSessionStateTimeout(const EEnhancedHostedSessionState State) const;
+	virtual void HandleHostedSessionStateTimeout(const FName SessionName, const EEnhancedHostedSessionState State);
+	void HandleAbandonedCreateDestroyed(FName SessionName, bool bWasSuccessful);
+	void ClearStaleHostedSessionDelegates();
+	FTSTicker::FDelegateHandle HostedSessionWatchdogHandle;
+
+	/** Hosted session drain, destroys drained sessions once their players left */
+	void StartDrainWatch();
+	bool TickDrainWatch(float DeltaTime);
+	bool UpdateHostedSessionDrain(const FName SessionName, const double Now);
+	void SetHostedSessionDrainPhase(const FName SessionName, EEnhancedSessionDrainPhase NewPhase);
+	FTSTicker::FDelegateHandle DrainWatchHandle;
+
+	/** Hosted session backfill, watches the open seats of matches in progress */
+	void StartBackfillWatch();
+	bool TickBackfillWatch(float DeltaTime);
+	bool UpdateHostedSessionBackfill(const FName SessionName, const double Now);
+	FTSTicker::FDelegateHandle BackfillWatchHandle;
+
+	/** Hosted session updates */
+	void ScheduleHostedSessionUpdate(const FName SessionName);
+	void FlushHostedSessionUpdate(const FName SessionName);
+	virtual void HandleUpdateSessionComplete(FName SessionName, bool bWasSuccessful);
 	virtual void HandleFindOnlineSessionsComplete(bool bWasSuccessful);
+
+	/** Session search multiplexing */
+	virtual void StartSessionSearch(const TSharedRef<FEnhancedOnlineSearchSettings>& Search);
+	virtual void CompleteSessionSearch(const TSharedRef<FEnhancedOnlineSearchSettings>& Search, bool bWasSuccessful);
+	void StartQueuedSessionSearches();
+
+	/** Starts the search, or queues it if too many searches are running */
+	void EnqueueSessionSearch(const TSharedRef<FEnhancedOnlineSearchSettings>& Search);
+
+	/** Starts a search whose raw results are only needed by the listener, or adds the listener to a pending search with the same query */
+	void RequestRawSessionSearch(const FEnhancedSessionSearchQuery& Query, const FOnEnhancedRawSessionSearchCompleted::FDelegate& Listener);
+
+	/** Returns the running or queued search for the given query, if any */
+	TSharedPtr<FEnhancedOnlineSearchSettings> FindPendingSessionSearch(const FEnhancedSessionSearchQuery& Query) const;
+
+	/** Creates result objects for the raw search results that arrived since the last call and returns them */
+	TArray<UEnhancedSessionSearchResult*> MaterializeSessionSearchResults(FEnhancedOnlineSearchSettings& Search);
+
+	/** Search result pool, results stay alive as long as one owner (search, cache, request or subscription) retains them */
+	UEnhancedSessionSearchResult* AcquireSearchResult(const FOnlineSessionSearchResult& SearchResult);
+	void RetainSearchResult(UEnhancedSessionSearchResult* Result);
+	void ReleaseSearchResult(UEnhancedSessionSearchResult* Result);
+
+	/** Hands a batch of streamed results to the request, which retains them until it searches again */
+	void StreamSearchResultsBatch(UEnhancedOnlineRequest_FindSessions* Request, const TArray<UEnhancedSessionSearchResult*>& Batch);
+
+	friend class FEnhancedOnlineSearchResultPoolTest;
+
+	/** Request pool, completed requests wait here until a request of their class is constructed again */
+	UEnhancedOnlineRequestBase* AcquirePooledRequest(UClass* RequestClass);
+	void ReleaseRequest(UEnhancedOnlineRequestBase* Request);
+	friend UEnhancedOnlineRequestBase;
+
+	/** Result streaming */
+	void UpdateSessionSearchStreaming();
+	bool TickSessionSearchStreaming(float DeltaTime);
+	FTSTicker::FDelegateHandle SearchStreamingTickerHandle;
+
+	/** Stores and delivers the results of a successful search, once the ping of every result was measured */
+	virtual void FinishSessionSearch(const TSharedRef<FEnhancedOnlineSearchSettings>& Search);
+
+	/** Ping measuring */
+	bool StartSessionSearchQos(const TSharedRef<FEnhancedOnlineSearchSettings>& Search);
+	void AdvertiseQosPort(FEnhancedOnlineSessionSettings& InSessionSettings);
+
+	/** Slot reservations */
+	void AdvertiseReservationPort(FEnhancedOnlineSessionSettings& InSessionSettings);
+	int32 GetReservableSlots(uint32 SessionKey) const;
+	void HandleGameModePostLogin(AGameModeBase* GameMode, APlayerController* NewPlayer);
+	FDelegateHandle GameModePostLoginHandle;
+	virtual void TryNextJoinCandidate();
+	void HandleSlotReservationCompleted(EEnhancedReservationResult Result);
+	virtual void JoinCandidateSession(UEnhancedSessionSearchResult* Candidate);
+	void FailJoinRequest(const FString& Reason);
+	void RunJoinRequest(uint64 CorrelationId);
+	virtual void StartJoinSessionRequest(UEnhancedOnlineRequest_JoinSession* Request);
+	void PreloadJoinCandidateMap(UEnhancedOnlineRequest_JoinSession* Request, UEnhancedSessionSearchResult* Candidate);
+	void ReleaseJoinCandidateMap(UEnhancedOnlineRequest_JoinSession* Request);
+
+	/** Quick join */
+	void RunQuickJoinRequest(uint64 CorrelationId);
+	void HandleQuickJoinSearchBatch(const TArray<UEnhancedSessionSearchResult*>& Results);
+	void HandleQuickJoinSearchCompleted(const TArray<UEnhancedSessionSearchResult*> Results);
+	void HandleQuickJoinSearchFailed(const FString& Reason);
+	void HandleQuickJoinSearchWaitExpired(uint32 RequestSerial);
+	void AddQuickJoinCandidates(UEnhancedOnlineRequest_QuickJoin* Request, const TArray<UEnhancedSessionSearchResult*>& Results);
+	virtual void TryStartQuickJoin();
+	void HandleQuickJoinJoined(const FName SessionName);
+	void HandleQuickJoinJoinFailed(const FString& Reason);
+	void FinishQuickJoinRequest(UEnhancedOnlineRequest_QuickJoin* Request);
+	void FailQuickJoinRequest(const FString& Reason);
+
+	/** Starts a search for the query, or merges the request into a pending search with the same query */
+	virtual void RequestSessionSearch(UEnhancedOnlineRequest_FindSessions* Request, const FEnhancedSessionSearchQuery& Query);
+
+	/** Collects the results of one federated query, the merged results are delivered once every query completed */
+	virtual void CompleteFederatedSessionSearch(UEnhancedOnlineRequest_FindSessions* Request, const TArray<UEnhancedSessionSearchResult*>* Results);
+
+	/** Fails a find sessions request, or the query of a federated one */
+	void FailSessionSearchRequest(UEnhancedOnlineRequest_FindSessions* Request, const FString& Reason);
+
+	/** Hands the search results to the request and completes it */
+	virtual void DeliverSessionSearchResults(UEnhancedOnlineRequest_FindSessions* Request, const TArray<UEnhancedSessionSearchResult*>& InResults);
+
+	/** Paginated search */
+	virtual void FindOnlineSessionsPageInternal(ULocalPlayer* LocalPlayer, UEnhancedOnlineRequest_FindSessionsPage* Request);
+	void FetchSearchSnapshot(int32 SnapshotId, int32 NumRows);
+	void HandleSearchSnapshotFetched(const TArray<FOnlineSessionSearchResult>& SearchResults, bool bWasSuccessful, int32 SnapshotId);
+	void ServeSearchSnapshotPage(UEnhancedOnlineRequest_FindSessionsPage* Request, FEnhancedSessionSearchSnapshot& Snapshot);
+	void FailSearchSnapshotPage(UEnhancedOnlineRequest_FindSessionsPage* Request, const FString& Reason);
+	void PruneSearchSnapshots();
+
+	/**
+	 * Loads a map package in the background and keeps it loaded until a map is loaded, so travelling to it doesn't wait for the full load.
+	 * @param PackageName	The long package name of the map
+	 * @param OnPreloaded	Called once the package is loaded, right away if it already is
+	 * @return True if the package is loading or already loaded
+	 */
+	bool PreloadMapPackage(const FName PackageName, const FOnEnhancedMapPreloaded& OnPreloaded);
+
+	/** Drops a preloaded map package that won't be travelled to, a load that is still running isn't kept once it completes */
+	void ReleasePreloadedMapPackage(const FName PackageName);
+
+	void HandleMapPackagePreloaded(const FName& PackageName, UPackage* LoadedPackage, EAsyncLoadingResult::Type Result);
+	void HandlePostLoadMapWithWorld(UWorld* LoadedWorld);
+	void HandleCreateSessionMapPreloaded(const FName PackageName, bool bWasSuccessful, TWeakObjectPtr<UEnhancedOnlineRequest_CreateSession> WeakRequest, uint32 RequestSerial);
+	void HandleJoinSessionMapPreloaded(const FName PackageName, bool bWasSuccessful, TWeakObjectPtr<UEnhancedOnlineRequest_JoinSession> WeakRequest, uint32 RequestSerial);
+
+	/** Session browser subscriptions */
+	void StartSessionBrowserRefresh(TWeakObjectPtr<UEnhancedSessionBrowserSubscription> WeakSubscription);
+	void HandleSessionBrowserRefreshed(const TArray<FOnlineSessionSearchResult>& SearchResults, bool bWasSuccessful, TWeakObjectPtr<UEnhancedSessionBrowserSubscription> WeakSubscription);
+	void ScheduleSessionBrowserRefresh(UEnhancedSessionBrowserSubscription* Subscription);
+
+	/** Session search cache */
+	bool ServeCachedSessionSearch(UEnhancedOnlineRequest_FindSessions* Request, const FEnhancedSessionSearchQuery& Query);
+	void RevalidateSessionSearch(const FEnhancedSessionSearchQuery& Query);
+	void StoreSessionSearchResults(const FEnhancedSessionSearchQuery& Query, const TArray<UEnhancedSessionSearchResult*>& Results);
 	virtual void HandleJoinSessionCompleted(FName SessionName, EOnJoinSessionCompleteResult::Type Result);
 
 	/** Online Identity */
 	virtual void LoginOnlineUserInternal(ULocalPlayer* LocalPlayer, UEnhancedOnlineRequest_LoginUser* Request);
 	virtual void LogoutOnlineUserInternal(ULocalPlayer* LocalPlayer, UEnhancedOnlineRequest_LogoutUser* Request);
+	void RunLoginRequest(uint64 CorrelationId);
+	void RunLogoutRequest(uint64 CorrelationId);
 
-	FDelegateHandle LoginDelegateHandle;
-	FDelegateHandle LogoutDelegateHandle;
+	/** Login and logout completion delegates, keyed by local user */
+	TMap<int32, FDelegateHandle> LoginDelegateHandles;
+	TMap<int32, FDelegateHandle> LogoutDelegateHandles;
 
 	virtual void HandleLoginComplete(int32 LocalUserNum, bool bWasSuccessful, const FUniqueNetId& UserId, const FString& Error);
 	virtual void HandleLogoutComplete(int32 LocalUserNum, bool bWasSuccessful);
 
+	/**
+	 * Queues a request until its lane and category are free, it is started right away if they already are
+	 * @param Request	The request, kept alive until it is completed
+	 * @param Category	The backend the request waits for
+	 * @param Lane		Requests of the same lane run one at a time
+	 * @param OnStart	Called with the correlation id of the request once it may run
+	 * @return The correlation id of the request, 0 if it was failed because too many requests are queued
+	 */
+	uint64 ScheduleRequest(UEnhancedOnlineRequestBase* Request, const EEnhancedRequestCategory Category, const FName Lane, const FOnEnhancedScheduledRequestStart& OnStart);
+
+	/** Frees the lane of a scheduled request and starts the next one waiting for it */
+	void CompleteScheduledRequest(const uint64 CorrelationId);
 
-private:
-	/** The URL to travel to after the session is created */
-	FURL PendingTravelURL;
+	/** Returns the scheduled request with the given correlation id, null if there is none or it has another type */
+	template<typename RequestType>
+	RequestType* GetScheduledRequest(const uint64 CorrelationId) const
+	{
+		return Cast<RequestType>(ScheduledRequests.FindRef(CorrelationId));
+	}
+
+	/** Maps a backend completion back to the request running in its lane */
+	template<typename RequestType>
+	RequestType* FindRunningRequest(const EEnhancedRequestCategory Category, const FName Lane) const
+	{
+		return RequestScheduler.IsValid() ? GetScheduledRequest<RequestType>(RequestScheduler->FindRunning(Category, Lane)) : nullptr;
+	}
 
+private:
 	/** The URL to travel to after the client joins the session */
 	FString PendingClientTravelURL;
 
-	/** The request object for the pending session */
+	/** The join talking to the online service, the join lane of the scheduler only lets one run at a time */
+	UPROPERTY()
+	TObjectPtr<UEnhancedOnlineRequest_JoinSession> PendingJoinRequest;
+
+	/** The quick join that is running, it holds the join lane until it joined or gave up */
+	UPROPERTY()
+	TObjectPtr<UEnhancedOnlineRequest_QuickJoin> PendingQuickJoinRequest;
+
+	/** Queues the requests whose backend only takes a few at a time */
+	TSharedPtr<FEnhancedRequestScheduler> RequestScheduler;
+
+	/** Queued and running requests, keyed by correlation id */
+	UPROPERTY()
+	TMap<uint64, TObjectPtr<UEnhancedOnlineRequestBase>> ScheduledRequests;
+
+	/** Sessions hosted by this process, keyed by session name */
+	UPROPERTY()
+	TMap<FName, FEnhancedHostedSession> HostedSessions;
+
+	/** Searches currently running on the backend, keyed by their query */
+	TMap<FEnhancedSessionSearchQuery, TSharedPtr<FEnhancedOnlineSearchSettings>> ActiveSearches;
+
+	/** Searches waiting for a free backend slot, in the order they were requested */
+	TArray<TSharedPtr<FEnhancedOnlineSearchSettings>> QueuedSearches;
+
+	/** Results of recently completed searches */
+	TSharedPtr<FEnhancedSessionSearchCache> SearchCache;
+
+	/** Result objects that are no longer retained and can be reused by the next search */
+	UPROPERTY()
+	TArray<TObjectPtr<UEnhancedSessionSearchResult>> FreeSearchResults;
+
+	/** Counters of the search result pool */
+	FEnhancedSearchResultPoolStats SearchResultPoolStats;
+
+	/** Completed requests that can be reused by the next request of their class */
 	UPROPERTY()
-	TObjectPtr<UEnhancedOnlineRequest_Session> PendingSessionRequest;
+	TArray<TObjectPtr<UEnhancedOnlineRequestBase>> FreeRequests;
+
+	/** Counters of the request pool */
+	FEnhancedRequestPoolStats RequestPoolStats;
+
+	/** Raw rows of paginated searches, keyed by the snapshot id of their cursors */
+	TMap<int32, TSharedPtr<FEnhancedSessionSearchSnapshot>> SearchSnapshots;
 
-	/** The request object for the pending login */
+	/** Id of the next paginated search */
+	int32 NextSearchSnapshotId = 0;
+
+	/** Page requests waiting for their snapshot to fetch enough rows */
 	UPROPERTY()
-	TObjectPtr<UEnhancedOnlineRequest_LoginUser> PendingLoginRequest;
+	TArray<TObjectPtr<UEnhancedOnlineRequest_FindSessionsPage>> PendingPageRequests;
 
-	/** The request object for the pending logout */
+	/** Subscriptions whose live session sets are kept up to date */
 	UPROPERTY()
-	TObjectPtr<UEnhancedOnlineRequest_LogoutUser> PendingLogoutRequest;
+	TArray<TObjectPtr<UEnhancedSessionBrowserSubscription>> BrowserSubscriptions;
+
+	/** Table of map primary assets, built once the asset manager finished scanning */
+	TSharedPtr<FEnhancedMapRegistry> MapRegistry;
 
-	/** The request object for the pending join session */
+	/** Map packages loaded ahead of a travel, kept alive until a map is loaded */
 	UPROPERTY()
-	TObjectPtr<UEnhancedOnlineRequest_StartSession> PendingStartSessionRequest;
+	TMap<FName, TObjectPtr<UPackage>> PreloadedMapPackages;
+
+	/** Callbacks waiting for a map package that is still loading */
+	TMap<FName, TArray<FOnEnhancedMapPreloaded>> PendingMapPreloads;
+
+	/** Packages released while they were still loading, they aren't kept once their load completes */
+	TSet<FName> CancelledMapPreloads;
+
+	FDelegateHandle PostLoadMapDelegateHandle;
+
+	/** Probers measuring the ping of search results */
+	TArray<TSharedPtr<FEnhancedSessionQosProber>> ActiveQosProbers;
+
+	/** Responder echoing the QoS probes of clients */
+	TSharedPtr<FEnhancedSessionQosResponder> QosResponder;
+
+	/** Host answering the slot reservations of clients */
+	TSharedPtr<FEnhancedSessionReservationHost> ReservationHost;
+
+	/** Client reserving a slot for the pending join */
+	TSharedPtr<FEnhancedSessionReservationClient> ReservationClient;
+
+protected:
+	/** Maximum number of searches running on the backend at the same time, most online subsystems only support one */
+	UPROPERTY(Config)
+	int32 MaxConcurrentSearches = 1;
+
+	/** Maximum number of local users logging in or out at the same time */
+	UPROPERTY(Config)
+	int32 MaxConcurrentIdentityRequests = 4;
+
+	/** Maximum number of sessions being started at the same time */
+	UPROPERTY(Config)
+	int32 MaxConcurrentStartSessionRequests = 4;
+
+	/** Maximum number of requests waiting in each category, requests beyond it fail right away */
+	UPROPERTY(Config)
+	int32 MaxQueuedRequests = 32;
+
+	/** Seconds cached search results are served without refreshing them, 0 disables the cache */
+	UPROPERTY(Config)
+	float SearchCacheTimeToLive = 5.f;
+
+	/** Seconds past the time to live during which stale results are still served while they are refreshed in the background */
+	UPROPERTY(Config)
+	float SearchCacheStaleWindow = 60.f;
+
+	/** Seconds between two polls of running searches for new results, used by streaming requests */
+	UPROPERTY(Config)
+	float SearchStreamingInterval = 0.1f;
+
+	/** Maximum number of unused result objects kept in the pool */
+	UPROPERTY(Config)
+	int32 MaxPooledSearchResults = 512;
+
+	/** Maximum number of completed requests kept in the pool, across all request classes */
+	UPROPERTY(Config)
+	int32 MaxPooledRequests = 64;
+
+	/** Seconds a paginated search is kept after its last page was requested, older cursors expire */
+	UPROPERTY(Config)
+	float SearchSnapshotTimeToLive = 120.f;
+
+	/** Maximum number of paginated searches kept at the same time, the least recently used is dropped first */
+	UPROPERTY(Config)
+	int32 MaxSearchSnapshots = 8;
+
+	/** Maximum number of fetches of a paginated search, the search counts as exhausted afterwards */
+	UPROPERTY(Config)
+	int32 MaxSearchSnapshotFetches = 16;
+
+	/** Seconds a hosted session stays matchable, advertised as the matching timeout */
+	UPROPERTY(Config)
+	float MatchingTimeout = 120.f;
+
+	/** Seconds the online service has to create a session before the attempt counts as failed, 0 waits forever */
+	UPROPERTY(Config)
+	float CreatingStateTimeout = 30.f;
+
+	/** Seconds the online service has to start a session before the start request fails, 0 waits forever */
+	UPROPERTY(Config)
+	float StartingStateTimeout = 15.f;
+
+	/** Seconds the online service has to end a session before it is considered ended, 0 waits forever */
+	UPROPERTY(Config)
+	float EndingStateTimeout = 15.f;
+
+	/** Seconds the online service has to destroy a session before it is forgotten anyway, 0 waits forever */
+	UPROPERTY(Config)
+	float DestroyingStateTimeout = 15.f;
+
+	/** Seconds the online service has to update a session before the update counts as failed, 0 waits forever */
+	UPROPERTY(Config)
+	float SessionUpdateTimeout = 15.f;
+
+	/** Seconds between two checks of the hosted session deadlines */
+	UPROPERTY(Config)
+	float HostedSessionWatchdogInterval = 1.f;
+
+	/** Seconds changes to a hosted session are collected before they are sent in one update */
+	UPROPERTY(Config)
+	float SessionUpdateBatchWindow = 0.25f;
+
+	/** Minimum seconds between two updates of a hosted session caused by normal priority changes */
+	UPROPERTY(Config)
+	float SessionUpdateMinInterval = 5.f;
+
+	/** Minimum seconds between two updates of a hosted session caused by low priority changes only */
+	UPROPERTY(Config)
+	float SessionUpdateLowPriorityInterval = 30.f;
+
+	/** How long the changes of a hosted session wait after its update failed, the wait grows with every failure in a row */
+	UPROPERTY(Config)
+	FEnhancedSessionRetryPolicy SessionUpdateRetryPolicy;
+
+	/** Seconds between two checks of the progress of drained sessions */
+	UPROPERTY(Config)
+	float DrainCheckInterval = 1.f;
+
+	/** Seconds between two checks of the open seats of backfilled sessions */
+	UPROPERTY(Config)
+	float BackfillCheckInterval = 1.f;
+
+	/** Minimum seconds between two times the backfill opens or closes a session, keeps joinability from flapping */
+	UPROPERTY(Config)
+	float BackfillJoinabilityInterval = 10.f;
+
+	/** Default UDP port of the QoS responder */
+	UPROPERTY(Config)
+	int32 QosPort = 7787;
+
+	/** Whether hosting a session starts the QoS responder */
+	UPROPERTY(Config)
+	bool bStartQosResponderWhenHosting = false;
+
+	/** Maximum number of QoS probes in flight at the same time */
+	UPROPERTY(Config)
+	int32 MaxConcurrentQosProbes = 32;
+
+	/** Seconds to wait for a QoS reply before the probe is sent again */
+	UPROPERTY(Config)
+	float QosProbeTimeout = 0.5f;
+
+	/** Number of times a QoS probe is sent before the host is considered unreachable */
+	UPROPERTY(Config)
+	int32 QosProbeAttempts = 2;
+
+	/** Default UDP port of the reservation host */
+	UPROPERTY(Config)
+	int32 ReservationPort = 7788;
 
+	/** Whether hosting a session starts the reservation host */
+	UPROPERTY(Config)
+	bool bStartReservationHostWhenHosting = false;
 
+	/** Seconds a reserved slot is held for a client that doesn't arrive */
+	UPROPERTY(Config)
+	float ReservationTimeToLive = 30.f;
 
-	/** Session settings for the pending session */
-	TSharedPtr<FEnhancedOnlineSessionSettings> SessionSettings;
+	/** Seconds to wait for the host to answer a reservation before it is sent again */
+	UPROPERTY(Config)
+	float ReservationTimeout = 0.5f;
 
-	/** Settings for the current search */
-	TSharedPtr<FEnhancedOnlineSearchSettings> SearchSettings;
+	/** Number of times a reservation is sent before the host is considered unreachable */
+	UPROPERTY(Config)
+	int32 ReservationAttempts = 3;
 };
@@ -0,0 +1,162 @@
+// Copyright © 2024 MajorT. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "EnhancedOnlineTypes.h"
+#include "OnlineSessionSettings.h"
+#include "EnhancedOnlineSettingsPublisher.generated.h"
+
+/**
+ * Specifies how soon a changed session setting has to reach the online service
+ */
+UENUM(BlueprintType)
+enum class EEnhancedSettingPublishPriority : uint8
+{
+	/** Sent with the next update, or once the low priority interval passed */
+	Low,
+	/** Sent once the minimum interval since the last update passed */
+	Normal,
+	/** Sent once the batch window passed, ignores the minimum interval */
+	High,
+};
+
+/**
+ * Blueprint exposed counters of a settings publisher
+ */
+USTRUCT(BlueprintType)
+struct FEnhancedSessionPublishStats
+{
+	GENERATED_BODY()
+
+public:
+	/** Number of updates sent to the online service */
+	UPROPERTY(BlueprintReadOnly, Category = "Online|Session")
+	int32 NumUpdatesSent = 0;
+
+	/** Number of changes that didn't need an update of their own, because they were merged into another one or changed nothing */
+	UPROPERTY(BlueprintReadOnly, Category = "Online|Session")
+	int32 NumUpdatesSuppressed = 0;
+
+	/** Number of settings sent to the online service */
+	UPROPERTY(BlueprintReadOnly, Category = "Online|Session")
+	int32 NumSettingsSent = 0;
+
+	/** Number of updates the online service rejected */
+	UPROPERTY(BlueprintReadOnly, Category = "Online|Session")
+	int32 NumUpdatesFailed = 0;
+};
+
+/**
+ * Intervals used by a settings publisher to coalesce changes
+ */
+struct FEnhancedSettingsPublishRules
+{
+	/** Seconds changes are collected before they are sent */
+	double BatchWindow = 0.25;
+
+	/** Minimum seconds between two updates of normal priority changes */
+	double MinInterval = 5.0;
+
+	/** Minimum seconds between two updates of low priority changes */
+	double LowPriorityInterval = 30.0;
+
+	/** How long failed changes wait before they are sent again, only the backoff is used, publishing never gives up */
+	FEnhancedSessionRetryPolicy RetryPolicy;
+};
+
+/**
+ * Tracks changes to the advertised settings of a hosted session and turns them into as few updates as possible
+ * Only the settings that differ from the online service are sent
+ */
+class ENHANCEDONLINESUBSYSTEM_API FEnhancedSessionSettingsPublisher
+{
+public:
+	FEnhancedSessionSettingsPublisher(const TSharedRef<FEnhancedOnlineSessionSettings>& InSessionSettings, const FEnhancedSettingsPublishRules& InRules);
+
+	/**
+	 * Changes an advertised setting, the change is published according to its priority
+	 * @param Key				The name of the setting
+	 * @param Value				The new value
+	 * @param AdvertisementType	How the setting is advertised
+	 * @param Priority			How soon the change has to reach the online service
+	 */
+	template<typename ValueType>
+	void Set(const FName Key, const ValueType& Value, const EOnlineDataAdvertisementType::Type AdvertisementType, const EEnhancedSettingPublishPriority Priority = EEnhancedSettingPublishPriority::Normal)
+	{
+		SetSetting(Key, FOnlineSessionSetting(Value, AdvertisementType), Priority);
+	}
+
+	/** Changes an advertised setting, the change is published according to its priority */
+	void SetSetting(const FName Key, const FOnlineSessionSetting& Setting, const EEnhancedSettingPublishPriority Priority);
+
+	/** Changes whether players can join while the session is in progress */
+	void SetAllowJoinInProgress(const bool bAllowJoinInProgress, const EEnhancedSettingPublishPriority Priority);
+
+	/** Changes whether the session can be found by searches */
+	void SetShouldAdvertise(const bool bShouldAdvertise, const EEnhancedSettingPublishPriority Priority);
+
+	/** Returns true if changes are waiting to be published */
+	bool IsDirty() const { return !DirtyKeys.IsEmpty(); }
+
+	/** Returns true while an update is waiting for the online service */
+	bool IsPublishing() const { return bIsPublishing; }
+
+	/** Returns the platform time at which the pending changes are due, 0 if nothing is pending */
+	double GetPublishTime() const;
+
+	/**
+	 * Builds the update of the pending changes, the current settings with only the changed values replaced
+	 * @param CurrentSettings	The settings the online service currently has
+	 * @param OutUpdate			The settings to send
+	 * @return The number of changed values, 0 if nothing has to be sent
+	 */
+	int32 BeginPublish(const FOnlineSessionSettings& CurrentSettings, FOnlineSessionSettings& OutUpdate);
+
+	/** Finishes the update started by BeginPublish, failed changes are published again with the next update */
+	void EndPublish(const bool bWasSuccessful);
+
+	/** Returns the settings the session should be advertised with */
+	const FEnhancedOnlineSessionSettings& GetSessionSettings() const { return *SessionSettings; }
+
+	/** Returns the counters of the publisher */
+	const FEnhancedSessionPublishStats& GetStats() const { return Stats; }
+
+	/** Called when the first change since the last update was made, or an earlier publish time is needed */
+	FSimpleDelegate OnPublishTimeChanged;
+
+private:
+	void MarkDirty(const FName Key, const EEnhancedSettingPublishPriority Priority);
+
+	/** Dirty keys of the join in progress and advertise flags, they aren't part of the settings map */
+	static const FName JoinInProgressKey;
+	static const FName ShouldAdvertiseKey;
+
+private:
+	/** The settings the session should be advertised with, shared with the hosted session */
+	TSharedRef<FEnhancedOnlineSessionSettings> SessionSettings;
+
+	FEnhancedSettingsPublishRules Rules;
+
+	/** Changed settings and the highest priority they were changed with */
+	TMap<FName, EEnhancedSettingPublishPriority> DirtyKeys;
+
+	/** Settings sent with the running update, kept in case it fails */
+	TMap<FName, EEnhancedSettingPublishPriority> PublishingKeys;
+
+	/** Platform time of the first change since the last update */
+	double FirstDirtyTime = 0.0;
+
+	/** Platform time of the last update */
+	double LastPublishTime = 0.0;
+
+	/** Number of updates that failed in a row, the wait before the next one grows with it */
+	int32 NumConsecutiveFailures = 0;
+
+	/** Platform time before which no update is sent after a failure */
+	double RetryTime = 0.0;
+
+	bool bIsPublishing = false;
+
+	FEnhancedSessionPublishStats Stats;
+};
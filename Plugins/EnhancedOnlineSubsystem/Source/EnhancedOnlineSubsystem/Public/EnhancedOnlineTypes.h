@@ -4,12 +4,21 @@
 
 #include "CoreMinimal.h"
 #include "OnlineSessionSettings.h"
+#include "Engine/EngineBaseTypes.h"
+#include "Engine/EngineTypes.h"
 #include "EnhancedOnlineTypes.generated.h"
 
+class UEnhancedOnlineRequest_Session;
+class UEnhancedOnlineRequest_RecycleSession;
+class FEnhancedSessionSettingsPublisher;
+
 #define MaxNumConnectionsSession 1000
 #define MaxNumConnectionsLobby 64
 
 #define SETTING_FRIENDLYNAME FName(TEXT("FRIENDLYNAME"))
+#define SETTING_QOSPORT FName(TEXT("QOSPORT"))
+#define SETTING_RESERVATIONPORT FName(TEXT("RESERVATIONPORT"))
+#define SETTING_BACKFILL FName(TEXT("BACKFILL"))
 
 /**
  * Specifies the online mode of a game session
@@ -75,6 +84,308 @@ public:
 	virtual ~FEnhancedOnlineSessionSettings() {}
 };
 
+/**
+ * Specifies the lifecycle state of a session hosted by the subsystem
+ */
+UENUM(BlueprintType)
+enum class EEnhancedHostedSessionState : uint8
+{
+	None,
+	Creating,
+	Pending,
+	Starting,
+	InProgress,
+	Ending,
+	Destroying,
+	Destroyed,
+};
+
+/**
+ * Specifies how far a hosted session got in being taken out of rotation
+ */
+UENUM(BlueprintType)
+enum class EEnhancedSessionDrainPhase : uint8
+{
+	/** The session isn't being drained */
+	None,
+	/** The session stops being advertised and accepting joins */
+	Unadvertising,
+	/** The session is hidden, the players still in it are waited for */
+	WaitingForMatch,
+	/** The session is being destroyed */
+	Destroying,
+	/** The session was destroyed, the server can be shut down */
+	Drained,
+};
+
+/**
+ * Specifies how a host answered a slot reservation, the values are sent over the wire
+ */
+UENUM(BlueprintType)
+enum class EEnhancedReservationResult : uint8
+{
+	Accepted,
+	SessionFull,
+	UnknownSession,
+	NoResponse,
+};
+
+/**
+ * Specifies which backend a request waits for, each category has its own concurrency limit
+ */
+UENUM(BlueprintType)
+enum class EEnhancedRequestCategory : uint8
+{
+	/** Logins and logouts, one at a time per local user */
+	Identity,
+	/** Starting hosted sessions, one at a time per session */
+	StartSession,
+	/** Joins and quick joins, one at a time since they all join the game session */
+	Join,
+	MAX UMETA(Hidden)
+};
+
+/**
+ * Specifies the order queued requests are started in, requests of the same priority start in the order they were made
+ */
+UENUM(BlueprintType)
+enum class EEnhancedRequestPriority : uint8
+{
+	Low,
+	Normal,
+	High,
+};
+
+/**
+ * Specifies how often and how fast a failed session creation is retried
+ */
+USTRUCT(BlueprintType)
+struct FEnhancedSessionRetryPolicy
+{
+	GENERATED_BODY()
+
+public:
+	/** Maximum number of attempts including the first one, 1 never retries */
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Retry", meta = (ClampMin = "1"))
+	int32 MaxAttempts = 1;
+
+	/** Seconds to wait before the first retry */
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Retry", meta = (ClampMin = "0"))
+	float InitialBackoff = 1.f;
+
+	/** Factor the wait grows by after every failed retry */
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Retry", meta = (ClampMin = "1"))
+	float BackoffMultiplier = 2.f;
+
+	/** Maximum seconds to wait between two attempts */
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Retry", meta = (ClampMin = "0"))
+	float MaxBackoff = 30.f;
+
+	/** Fraction of the wait that is randomized, so hosts that failed together don't retry together */
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Retry", meta = (ClampMin = "0", ClampMax = "1"))
+	float Jitter = 0.5f;
+
+	/** Seconds after the first attempt past which no retry is started, 0 means no deadline */
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Retry", meta = (ClampMin = "0"))
+	float Deadline = 0.f;
+
+	/** Returns the seconds to wait before the next attempt, after the given number of failed attempts */
+	float GetRetryDelay(const int32 NumFailedAttempts) const
+	{
+		const float Backoff = FMath::Min(InitialBackoff * FMath::Pow(FMath::Max(BackoffMultiplier, 1.f), FMath::Max(NumFailedAttempts - 1, 0)), FMath::Max(MaxBackoff, 0.f));
+		return Backoff * (1.f - FMath::Clamp(Jitter, 0.f, 1.f) * FMath::FRand());
+	}
+};
+
+/**
+ * A session hosted by the subsystem, one process can host several sessions under different names
+ */
+USTRUCT()
+struct FEnhancedHostedSession
+{
+	GENERATED_BODY()
+
+public:
+	/** The name the session is registered under */
+	UPROPERTY()
+	FName SessionName;
+
+	/** The lifecycle state of the session */
+	UPROPERTY()
+	EEnhancedHostedSessionState State = EEnhancedHostedSessionState::None;
+
+	/** The request that created the session, cleared once it completed */
+	UPROPERTY()
+	TObjectPtr<UEnhancedOnlineRequest_Session> Request;
+
+	/** The URL to travel to once the session is created, only used by the game session */
+	UPROPERTY()
+	FURL TravelURL;
+
+	/** Whether the session is a player-hosted lobby */
+	UPROPERTY()
+	bool bIsLobby = false;
+
+	/** The settings the session is advertised with */
+	TSharedPtr<FEnhancedOnlineSessionSettings> SessionSettings;
+
+	/** Coalesces changes to the settings into as few updates as possible */
+	TSharedPtr<FEnhancedSessionSettingsPublisher> Publisher;
+
+	/** Recycle requests waiting for the next update of the session */
+	UPROPERTY()
+	TArray<TObjectPtr<UEnhancedOnlineRequest_RecycleSession>> PendingRecycleRequests;
+
+	/** Recycle requests whose changes are being sent to the online service */
+	UPROPERTY()
+	TArray<TObjectPtr<UEnhancedOnlineRequest_RecycleSession>> UpdatingRecycleRequests;
+
+	/** Timer of the next attempt to create the session */
+	FTimerHandle RetryTimerHandle;
+
+	/** Timer of the next update, changes made before it fires are sent in one call */
+	FTimerHandle UpdateTimerHandle;
+
+	/** Whether an update is waiting for the online service */
+	bool bIsUpdating = false;
+
+	/** Whether a timed out creation is being destroyed, its late completion is ignored and the retry waits for the destroy */
+	bool bIsAbandoningCreate = false;
+
+	/** Whether a start timed out while the online service was still starting the session, its late completion is still listened to */
+	bool bIsAwaitingLateStart = false;
+
+	/** Whether seats that open up while the match is in progress are advertised for backfill */
+	bool bBackfillEnabled = false;
+
+	/** Whether the session is currently advertised for backfill */
+	bool bIsBackfilling = false;
+
+	/** Whether the session allowed joining in progress before the backfill opened it */
+	bool bAllowJoinInProgressBeforeBackfill = false;
+
+	/** Number of seats last advertised for backfill */
+	int32 BackfillSlots = 0;
+
+	/** Platform time at which the backfill last opened or closed the session */
+	double LastBackfillChangeTime = 0.0;
+
+	/** How far the session got in being drained */
+	EEnhancedSessionDrainPhase DrainPhase = EEnhancedSessionDrainPhase::None;
+
+	/** Platform time at which the session is destroyed even if its match is still running, 0 waits for the match */
+	double DrainDeadlineTime = 0.0;
+
+	/** Platform time at which the session entered its current state, or the current creation attempt started */
+	double StateEnterTime = 0.0;
+
+	/** Platform time at which the running update was sent */
+	double UpdateStartTime = 0.0;
+};
+
+/**
+ * Identifies a session search query
+ * Searches sharing the same query are merged into a single backend call
+ */
+struct FEnhancedSessionSearchQuery
+{
+	FEnhancedSessionSearchQuery() {}
+	FEnhancedSessionSearchQuery(const EEnhancedSessionOnlineMode InOnlineMode, const bool bInFindLobbies, const FString& InSearchKeyword, const int32 InMaxSearchResults)
+		: OnlineMode(InOnlineMode)
+		, bFindLobbies(bInFindLobbies)
+		, SearchKeyword(InSearchKeyword)
+		, MaxSearchResults(FMath::Max(InMaxSearchResults, 0))
+	{
+	}
+
+	/** The online mode to search in */
+	EEnhancedSessionOnlineMode OnlineMode = EEnhancedSessionOnlineMode::Online;
+
+	/** Whether to search for player-hosted lobbies */
+	bool bFindLobbies = false;
+
+	/** The keyword used to filter the sessions */
+	FString SearchKeyword;
+
+	/** Maximum number of search results, 0 means unlimited */
+	int32 MaxSearchResults = 0;
+
+	bool operator==(const FEnhancedSessionSearchQuery& Other) const
+	{
+		return OnlineMode == Other.OnlineMode
+			&& bFindLobbies == Other.bFindLobbies
+			&& MaxSearchResults == Other.MaxSearchResults
+			&& SearchKeyword == Other.SearchKeyword;
+	}
+
+	bool operator!=(const FEnhancedSessionSearchQuery& Other) const
+	{
+		return !(*this == Other);
+	}
+
+	friend uint32 GetTypeHash(const FEnhancedSessionSearchQuery& Query)
+	{
+		uint32 Hash = GetTypeHash(static_cast<uint8>(Query.OnlineMode));
+		Hash = HashCombine(Hash, GetTypeHash(Query.bFindLobbies));
+		Hash = HashCombine(Hash, GetTypeHash(Query.SearchKeyword));
+		Hash = HashCombine(Hash, GetTypeHash(Query.MaxSearchResults));
+		return Hash;
+	}
+
+	/** Returns a readable representation of the query, used for logging */
+	FString ToString() const
+	{
+		return FString::Printf(TEXT("(Mode: %d, Lobbies: %s, Keyword: %s, MaxResults: %d)"),
+			static_cast<int32>(OnlineMode), bFindLobbies ? TEXT("true") : TEXT("false"), *SearchKeyword, MaxSearchResults);
+	}
+};
+
+/**
+ * Settings of a session search result that are decoded once when the result is created
+ */
+struct FEnhancedSessionSearchResultAttributes
+{
+	/** The friendly name of the session, falls back to the owning user name */
+	FString FriendlyName;
+
+	/** The advertised game mode */
+	FString GameMode;
+
+	/** The advertised map name */
+	FString MapName;
+
+	/** The keyword the session can be found with */
+	FString SearchKeyword;
+
+	/** The maximum number of players that can join the session */
+	int32 MaxPlayers = 0;
+
+	/** The number of players currently in the session */
+	int32 CurrentPlayers = 0;
+
+	/** The number of public slots that are still free */
+	int32 OpenPublicConnections = 0;
+
+	/** The ping to the session in milliseconds */
+	int32 PingInMs = 0;
+
+	/** Identifies the session across searches, falls back to the owning user id if the session has no id */
+	FString SessionId;
+
+	/** The port of the host's QoS responder, 0 if the host doesn't advertise one */
+	int32 QosPort = 0;
+
+	/** The port of the host's reservation host, 0 if the host doesn't take reservations */
+	int32 ReservationPort = 0;
+
+	/** Number of seats the host wants refilled mid-match, 0 if the session isn't backfilling */
+	int32 BackfillSlots = 0;
+
+	/** Hashes of the game mode and map name, used to reject sessions without comparing strings, hash hits are confirmed by the strings */
+	uint32 GameModeHash = 0;
+	uint32 MapNameHash = 0;
+};
+
 /**
  * Blueprint exposed struct for the enhanced friend presence info
  */
@@ -112,3 +423,180 @@ public:
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Friend Presence Info")
 	FString StatusString;
 };
+
+/**
+ * Blueprint exposed struct for the statistics of the search result pool
+ */
+USTRUCT(BlueprintType)
+struct FEnhancedSearchResultPoolStats
+{
+	GENERATED_BODY()
+
+public:
+	/** Number of result objects that were reused from the pool */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Search Result Pool")
+	int32 Hits = 0;
+
+	/** Number of result objects that had to be allocated because the pool was empty */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Search Result Pool")
+	int32 Misses = 0;
+
+	/** Number of result objects that were returned to the pool */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Search Result Pool")
+	int32 Recycled = 0;
+
+	/** Number of result objects currently waiting in the pool */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Search Result Pool")
+	int32 Pooled = 0;
+};
+
+/**
+ * Blueprint exposed struct for the statistics of the request pool
+ */
+USTRUCT(BlueprintType)
+struct FEnhancedRequestPoolStats
+{
+	GENERATED_BODY()
+
+public:
+	/** Number of requests that were reused from the pool */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Request Pool")
+	int32 Hits = 0;
+
+	/** Number of requests that had to be allocated because the pool had none of their class */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Request Pool")
+	int32 Misses = 0;
+
+	/** Number of completed requests that were returned to the pool */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Request Pool")
+	int32 Recycled = 0;
+
+	/** Number of completed requests left to the garbage collector because the pool was full */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Request Pool")
+	int32 Discarded = 0;
+
+	/** Number of requests currently waiting in the pool */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Request Pool")
+	int32 Pooled = 0;
+};
+
+/**
+ * Blueprint exposed struct for the timings of a host request
+ */
+USTRUCT(BlueprintType)
+struct FEnhancedSessionHostTimings
+{
+	GENERATED_BODY()
+
+public:
+	/** Seconds the online service took to create the session */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Host Timings")
+	float CreateSessionSeconds = 0.f;
+
+	/** Seconds the map package took to load in the background, 0 while it is still loading */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Host Timings")
+	float MapPreloadSeconds = 0.f;
+
+	/** Seconds of map loading that overlapped with creating the session instead of delaying the travel */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Host Timings")
+	float OverlapSavedSeconds = 0.f;
+
+	/** Whether the map finished loading before the travel started */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Host Timings")
+	bool bMapPreloadedBeforeTravel = false;
+};
+
+/**
+ * Blueprint exposed struct for the timings of a join request
+ */
+USTRUCT(BlueprintType)
+struct FEnhancedSessionJoinTimings
+{
+	GENERATED_BODY()
+
+public:
+	/** Seconds spent reserving slots with the hosts, over all tried sessions */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Join Timings")
+	float ReservationSeconds = 0.f;
+
+	/** Seconds the online service took to join the sessions, over all tried sessions */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Join Timings")
+	float JoinSessionSeconds = 0.f;
+
+	/** Seconds the map package of the joined session took to load in the background, 0 while it is still loading */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Join Timings")
+	float MapPreloadSeconds = 0.f;
+
+	/** Seconds of map loading that overlapped with joining instead of delaying the travel */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Join Timings")
+	float OverlapSavedSeconds = 0.f;
+
+	/** Seconds from the request until the travel started */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Join Timings")
+	float TimeToTravelSeconds = 0.f;
+
+	/** Whether the map finished loading before the travel started */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Join Timings")
+	bool bMapPreloadedBeforeTravel = false;
+};
+
+/**
+ * Blueprint exposed struct for the timings of a quick join request
+ */
+USTRUCT(BlueprintType)
+struct FEnhancedQuickJoinTimings
+{
+	GENERATED_BODY()
+
+public:
+	/** Seconds from the request until the first joinable session was found */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Quick Join Timings")
+	float FirstCandidateSeconds = 0.f;
+
+	/** Seconds from the request until a session was joined */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Quick Join Timings")
+	float TimeToJoinSeconds = 0.f;
+
+	/** Number of sessions that were tried, including the joined one */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Quick Join Timings")
+	int32 JoinAttempts = 0;
+
+	/** Whether the session was joined before the search completed */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Quick Join Timings")
+	bool bJoinedBeforeSearchCompleted = false;
+};
+
+/**
+ * Opaque position in a paginated session search, passed back to fetch the next page
+ */
+USTRUCT(BlueprintType)
+struct FEnhancedSessionSearchCursor
+{
+	GENERATED_BODY()
+
+public:
+	FEnhancedSessionSearchCursor() {}
+
+	FEnhancedSessionSearchCursor(const int32 InSnapshotId, const int32 InOffset)
+		: SnapshotId(InSnapshotId)
+		, Offset(InOffset)
+	{}
+
+	/** Returns true if the cursor points into an existing search, a default cursor starts a new search */
+	bool IsValid() const { return SnapshotId != INDEX_NONE; }
+
+	/** The search snapshot the cursor points into */
+	UPROPERTY()
+	int32 SnapshotId = INDEX_NONE;
+
+	/** Index of the first session of the page */
+	UPROPERTY()
+	int32 Offset = 0;
+};
+
+/**
+ * Delegate for when a session search completed, with the raw results of the online service
+ * @param SearchResults		The raw search results
+ * @param bWasSuccessful	Whether the search succeeded
+ */
+DECLARE_MULTICAST_DELEGATE_TwoParams(FOnEnhancedRawSessionSearchCompleted, const TArray<FOnlineSessionSearchResult>& /* Search Results */, bool /* bWasSuccessful */);
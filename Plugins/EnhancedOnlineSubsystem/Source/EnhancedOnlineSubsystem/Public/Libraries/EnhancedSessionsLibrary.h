@@ -3,12 +3,18 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "EnhancedOnlineBrowser.h"
+#include "EnhancedOnlineSearchFilter.h"
+#include "EnhancedOnlineTypes.h"
 #include "Kismet/BlueprintFunctionLibrary.h"
 #include "EnhancedSessionsLibrary.generated.h"
 
 class UEnhancedOnlineRequest_StartSession;
+class UEnhancedOnlineRequest_RecycleSession;
 class UEnhancedOnlineRequest_JoinSession;
+class UEnhancedOnlineRequest_QuickJoin;
 class UEnhancedOnlineRequest_FindSessions;
+class UEnhancedOnlineRequest_FindSessionsPage;
 class UEnhancedSessionSearchResult;
 enum class EEnhancedLoginAuthType : uint8;
 class UEnhancedOnlineRequest_LoginUser;
@@ -36,12 +42,51 @@ DECLARE_DYNAMIC_DELEGATE_TwoParams(FBPOnHostLobbyRequestSucceeded, const FName&,
  */
 DECLARE_DYNAMIC_DELEGATE_OneParam(FBPOnStartSessionRequestSucceeded, const FName&, SessionName);
 
+/**
+ * Delegate for when a recycle session request succeeds
+ * @param SessionName	The name of the session
+ */
+DECLARE_DYNAMIC_DELEGATE_OneParam(FBPOnRecycleSessionRequestSucceeded, const FName&, SessionName);
+
+/**
+ * Delegate for when a join session request succeeds
+ * @param SessionName	The name of the joined session
+ */
+DECLARE_DYNAMIC_DELEGATE_OneParam(FBPOnJoinSessionRequestSucceeded, const FName&, SessionName);
+
+/**
+ * Delegate for when a quick join request succeeds
+ * @param SessionName	The name of the joined session
+ * @param JoinedSession	The search result of the joined session
+ */
+DECLARE_DYNAMIC_DELEGATE_TwoParams(FBPOnQuickJoinRequestSucceeded, const FName&, SessionName, UEnhancedSessionSearchResult*, JoinedSession);
+
 /**
  * Delegate for when a find sessions request succeeds
  * @param SearchResults	List of found sessions
  */
 DECLARE_DYNAMIC_DELEGATE_OneParam(FBPOnFindSessionsSuceeeded, const TArray<UEnhancedSessionSearchResult*>&, SearchResults);
 
+/**
+ * Delegate for when a streaming find sessions request received new results
+ * @param SearchResults	List of sessions found since the last batch
+ */
+DECLARE_DYNAMIC_DELEGATE_OneParam(FBPOnFindSessionsBatchReceived, const TArray<UEnhancedSessionSearchResult*>&, SearchResults);
+
+/**
+ * Delegate for when a find sessions page request succeeds
+ * @param SearchResults	List of sessions on the page
+ * @param NextCursor	Cursor of the following page
+ * @param bHasMorePages	Whether the following page may contain sessions
+ */
+DECLARE_DYNAMIC_DELEGATE_ThreeParams(FBPOnFindSessionsPageSucceeded, const TArray<UEnhancedSessionSearchResult*>&, SearchResults, const FEnhancedSessionSearchCursor&, NextCursor, bool, bHasMorePages);
+
+/**
+ * Delegate for when a session browser refresh found differences
+ * @param Delta	The sessions that were added, removed or changed
+ */
+DECLARE_DYNAMIC_DELEGATE_OneParam(FBPOnSessionBrowserUpdated, const FEnhancedSessionBrowserDelta&, Delta);
+
 /**
  * Library of functions for interacting with the Enhanced Online Subsystem
  */
@@ -86,6 +131,30 @@ public:
 	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Online|EnhancedSessions|Sessions")
 	static FString GetSessionFriendlyName(UEnhancedSessionSearchResult* SearchResult);
 
+	/**
+	 * Gets the advertised game mode of a search result
+	 * @param SearchResult	The search result to get the game mode of
+	 * @return The game mode
+	 */
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Online|EnhancedSessions|Sessions")
+	static FString GetSessionGameMode(UEnhancedSessionSearchResult* SearchResult);
+
+	/**
+	 * Gets the advertised map name of a search result
+	 * @param SearchResult	The search result to get the map name of
+	 * @return The map name
+	 */
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Online|EnhancedSessions|Sessions")
+	static FString GetSessionMapName(UEnhancedSessionSearchResult* SearchResult);
+
+	/**
+	 * Gets the search keyword of a search result
+	 * @param SearchResult	The search result to get the search keyword of
+	 * @return The search keyword
+	 */
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Online|EnhancedSessions|Sessions")
+	static FString GetSessionSearchKeyword(UEnhancedSessionSearchResult* SearchResult);
+
 public:
 	/**
 	 * Constructs a request to create an online session
@@ -190,23 +259,144 @@ public:
 		FBPOnFindSessionsSuceeeded OnSucceededDelegate,
 		FBPOnRequestFailedWithLog OnFailedDelegate);
 
+	/**
+	 * Constructs a request to find online sessions that delivers the results in batches as they arrive
+	 * @param WorldContextObject	The world context object, IF YOU SEE THIS IN BLUEPRINTS, YOU ARE DOING SOMETHING WRONG >:(
+	 * @param OnlineMode			The online mode of the session
+	 * @param MaxSearchResults		The maximum number of search results to return
+	 * @param bFindLobbies			Whether to find lobbies
+	 * @param SearchKeyword			The search keyword to use
+	 * @param LocalUserIndex		The index of the local user who made the request
+	 * @param bInvalidateOnCompletion	Whether to invalidate the request when it's completed
+	 * @param OnBatchReceivedDelegate	Delegate to call every time new sessions were found
+	 * @param OnSucceededDelegate	Delegate to call when the request succeeds, with all the sessions found
+	 * @param OnFailedDelegate		Delegate to call when the request fails
+	 * @return The request object
+	 */
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Online|EnhancedSessions|Sessions", meta =
+		(WorldContext = "WorldContextObject", Keywords = "Make, Create, New, Stream", DisplayName = "Construct Online Streaming Find Sessions Request",
+			AdvancedDisplay = "LocalUserIndex, bInvalidateOnCompletion", LocalUserIndex = "0", bFindLobbies = "true", bInvalidateOnCompletion = "false"))
+	static UPARAM(DisplayName = "Request") UEnhancedOnlineRequest_FindSessions* ConstructOnlineStreamingFindSessionsRequest(
+		UObject* WorldContextObject,
+		const EEnhancedSessionOnlineMode OnlineMode,
+		const int32 MaxSearchResults,
+		const bool bFindLobbies,
+		const FString SearchKeyword,
+		const int32 LocalUserIndex,
+		const bool bInvalidateOnCompletion,
+		FBPOnFindSessionsBatchReceived OnBatchReceivedDelegate,
+		FBPOnFindSessionsSuceeeded OnSucceededDelegate,
+		FBPOnRequestFailedWithLog OnFailedDelegate);
+
+	/**
+	 * Constructs a request to find one page of online sessions
+	 * @param WorldContextObject	The world context object, IF YOU SEE THIS IN BLUEPRINTS, YOU ARE DOING SOMETHING WRONG >:(
+	 * @param OnlineMode			The online mode to use
+	 * @param PageSize				Maximum number of sessions on the page
+	 * @param Cursor				The page to fetch, leave it empty to start a new search
+	 * @param bFindLobbies			Whether to find lobbies
+	 * @param SearchKeyword			The search keyword to use
+	 * @param LocalUserIndex		The index of the local user who made the request
+	 * @param bInvalidateOnCompletion	Whether to invalidate the request when it's completed
+	 * @param OnSucceededDelegate	Delegate to call when the request succeeds, with the sessions on the page
+	 * @param OnFailedDelegate		Delegate to call when the request fails
+	 * @return The request object
+	 */
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Online|EnhancedSessions|Sessions", meta =
+		(WorldContext = "WorldContextObject", Keywords = "Make, Create, New, Page", DisplayName = "Construct Online Find Sessions Page Request",
+			AdvancedDisplay = "LocalUserIndex, bInvalidateOnCompletion", LocalUserIndex = "0", PageSize = "20", bFindLobbies = "true", bInvalidateOnCompletion = "false", AutoCreateRefTerm = "Cursor"))
+	static UPARAM(DisplayName = "Request") UEnhancedOnlineRequest_FindSessionsPage* ConstructOnlineFindSessionsPageRequest(
+		UObject* WorldContextObject,
+		const EEnhancedSessionOnlineMode OnlineMode,
+		const int32 PageSize,
+		const FEnhancedSessionSearchCursor& Cursor,
+		const bool bFindLobbies,
+		const FString SearchKeyword,
+		const int32 LocalUserIndex,
+		const bool bInvalidateOnCompletion,
+		FBPOnFindSessionsPageSucceeded OnSucceededDelegate,
+		FBPOnRequestFailedWithLog OnFailedDelegate);
+
+	/**
+	 * Constructs a session browser subscription, pass it to Subscribe To Session Browser to start refreshing it
+	 * @param WorldContextObject	The world context object, IF YOU SEE THIS IN BLUEPRINTS, YOU ARE DOING SOMETHING WRONG >:(
+	 * @param OnlineMode			The online mode to use
+	 * @param MaxSearchResults		The maximum number of sessions in the live set
+	 * @param bFindLobbies			Whether to find lobbies
+	 * @param SearchKeyword			The search keyword to use
+	 * @param MinRefreshInterval	Seconds between two refreshes while sessions keep changing
+	 * @param MaxRefreshInterval	Seconds between two refreshes once nothing changed for a while
+	 * @param OnUpdatedDelegate		Delegate to call with the differences found by every refresh
+	 * @return The subscription object
+	 */
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Online|EnhancedSessions|Sessions", meta =
+		(WorldContext = "WorldContextObject", Keywords = "Make, Create, New, Browser, Refresh", DisplayName = "Construct Session Browser Subscription",
+			AdvancedDisplay = "MinRefreshInterval, MaxRefreshInterval", bFindLobbies = "true", MinRefreshInterval = "5", MaxRefreshInterval = "60"))
+	static UPARAM(DisplayName = "Subscription") UEnhancedSessionBrowserSubscription* ConstructSessionBrowserSubscription(
+		UObject* WorldContextObject,
+		const EEnhancedSessionOnlineMode OnlineMode,
+		const int32 MaxSearchResults,
+		const bool bFindLobbies,
+		const FString SearchKeyword,
+		const float MinRefreshInterval,
+		const float MaxRefreshInterval,
+		FBPOnSessionBrowserUpdated OnUpdatedDelegate);
+
 	/**
 	 * Constructs a request to join an online session
 	 * @param WorldContextObject	The world context object, IF YOU SEE THIS IN BLUEPRINTS, YOU ARE DOING SOMETHING WRONG >:(
 	 * @param SessionToJoin			The session to join
+	 * @param FallbackSessions		Sessions tried in order if the session to join has no free slot
 	 * @param LocalUserIndex		The index of the local user who made the request
 	 * @param bInvalidateOnCompletion	Whether to invalidate the request when it's completed
+	 * @param OnSucceededDelegate	Delegate to call when the request succeeds
 	 * @param OnFailedDelegate		Delegate to call when the request fails
 	 * @return The request object
 	 */
 	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Online|EnhancedSessions|Sessions", meta =
 		(WorldContext = "WorldContextObject", Keywords = "Make, Create, New", DisplayName = "Construct Online Join Session Request",
-			AdvancedDisplay = "LocalUserIndex, bInvalidateOnCompletion", LocalUserIndex = "0", bInvalidateOnCompletion = "true"))
+			AdvancedDisplay = "FallbackSessions, LocalUserIndex, bInvalidateOnCompletion", AutoCreateRefTerm = "FallbackSessions", LocalUserIndex = "0", bInvalidateOnCompletion = "true"))
 	static UPARAM(DisplayName = "Request") UEnhancedOnlineRequest_JoinSession* ConstructOnlineJoinSessionRequest(
 		UObject* WorldContextObject,
 		UEnhancedSessionSearchResult* SessionToJoin,
+		const TArray<UEnhancedSessionSearchResult*>& FallbackSessions,
+		const int32 LocalUserIndex,
+		const bool bInvalidateOnCompletion,
+		FBPOnJoinSessionRequestSucceeded OnSucceededDelegate,
+		FBPOnRequestFailedWithLog OnFailedDelegate);
+
+	/**
+	 * Constructs a request to search for sessions and join the best one as soon as it is good enough
+	 * @param WorldContextObject	The world context object, IF YOU SEE THIS IN BLUEPRINTS, YOU ARE DOING SOMETHING WRONG >:(
+	 * @param OnlineMode			The online mode of the session
+	 * @param MaxSearchResults		The maximum number of sessions to search for
+	 * @param bFindLobbies			Whether to find lobbies
+	 * @param SearchKeyword			The search keyword to use
+	 * @param Scoring				How the found sessions are ranked
+	 * @param GoodEnoughScore		Score a session needs to be joined before the search completed
+	 * @param MaxSearchWait			Seconds after which the best session is joined even if it isn't good enough
+	 * @param LocalUserIndex		The index of the local user who made the request
+	 * @param bInvalidateOnCompletion	Whether to invalidate the request when it's completed
+	 * @param OnSucceededDelegate	Delegate to call when the request succeeds
+	 * @param OnFailedDelegate		Delegate to call when the request fails
+	 * @return The request object
+	 */
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Online|EnhancedSessions|Sessions", meta =
+		(WorldContext = "WorldContextObject", Keywords = "Make, Create, New, Matchmaking", DisplayName = "Construct Online Quick Join Request",
+			AdvancedDisplay = "GoodEnoughScore, MaxSearchWait, LocalUserIndex, bInvalidateOnCompletion", LocalUserIndex = "0", bFindLobbies = "true",
+			GoodEnoughScore = "0.75", MaxSearchWait = "2.0", bInvalidateOnCompletion = "true"))
+	static UPARAM(DisplayName = "Request") UEnhancedOnlineRequest_QuickJoin* ConstructOnlineQuickJoinRequest(
+		UObject* WorldContextObject,
+		const EEnhancedSessionOnlineMode OnlineMode,
+		const int32 MaxSearchResults,
+		const bool bFindLobbies,
+		const FString SearchKeyword,
+		const FEnhancedQuickJoinScoring& Scoring,
+		const float GoodEnoughScore,
+		const float MaxSearchWait,
 		const int32 LocalUserIndex,
 		const bool bInvalidateOnCompletion,
+		FBPOnQuickJoinRequestSucceeded OnSucceededDelegate,
 		FBPOnRequestFailedWithLog OnFailedDelegate);
 
 	/**
@@ -225,4 +415,31 @@ public:
 		const bool bInvalidateOnCompletion,
 		FBPOnStartSessionRequestSucceeded OnSucceededDelegate,
 		FBPOnRequestFailedWithLog OnFailedDelegate);
+
+	/**
+	 * Constructs a request to reuse a hosted session for the next match
+	 * @param WorldContextObject	The world context object, IF YOU SEE THIS IN BLUEPRINTS, YOU ARE DOING SOMETHING WRONG >:(
+	 * @param SessionName			The name of the hosted session
+	 * @param MapId					The map of the next match, leave empty to keep the current map
+	 * @param GameModeAdvertisementName	The game mode of the next match, leave empty to keep the current game mode
+	 * @param FriendlyName			The friendly name of the next match, leave empty to keep the current name
+	 * @param bTravelToMap			Whether the host travels to the new map once the session is updated
+	 * @param bInvalidateOnCompletion	Whether to invalidate the request when it's completed
+	 * @param OnSucceededDelegate	Delegate to call when the request succeeds
+	 * @param OnFailedDelegate		Delegate to call when the request fails
+	 * @return The request object
+	 */
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Online|EnhancedSessions|Sessions", meta =
+		(WorldContext = "WorldContextObject", Keywords = "Make, Create, New, Update, Reuse", DisplayName = "Construct Online Recycle Session Request",
+			AdvancedDisplay = "bInvalidateOnCompletion", bInvalidateOnCompletion = "true", SessionName = "GameSession"))
+	static UPARAM(DisplayName = "Request") UEnhancedOnlineRequest_RecycleSession* ConstructOnlineRecycleSessionRequest(
+		UObject* WorldContextObject,
+		const FName SessionName,
+		UPARAM(meta = (AllowedTypes = "Map")) FPrimaryAssetId MapId,
+		const FString GameModeAdvertisementName,
+		const FString FriendlyName,
+		const bool bTravelToMap,
+		const bool bInvalidateOnCompletion,
+		FBPOnRecycleSessionRequestSucceeded OnSucceededDelegate,
+		FBPOnRequestFailedWithLog OnFailedDelegate);
 };